@@ -14,6 +14,10 @@ CFLAGS = -Wall -O3 -I. -I./include/ -I${PREFIX}/include -I/usr/include
 #LDFLAGS = ${LIBS} `pkg-config --libs jack`
 LDFLAGS = ${LIBS} -ljack -lpthread -lrt
 
+# uncomment to build the realtime safety checker, see include/jackrtcheck.hpp
+#CFLAGS += -DJACKCPP_RTCHECK -rdynamic
+#LDFLAGS += -ldl
+
 AR = ar cr
 CC = g++
 RANLIB = ranlib
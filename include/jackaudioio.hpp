@@ -26,11 +26,31 @@ extern "C" {
 }
 #include <string>
 #include <vector>
+#include <set>
 #include <stdexcept>
+#include <pthread.h>
+#include "jackcompat.hpp"
 #include "jackringbuffer.hpp"
+#include "jackportregistry.hpp"
+#include "jackconnections.hpp"
+#include "jackrtswap.hpp"
+#include "jackseqlock.hpp"
+#include "jacktransport.hpp"
+#include "jackgraphevent.hpp"
+#include "jacknotifier.hpp"
+#include "jackrtarena.hpp"
+#include "jackobjectpool.hpp"
+#include "jackrtcheck.hpp"
+#include "jackthreadconfig.hpp"
+#include "jackfilesink.hpp"
+#include "jackmeter.hpp"
+#include "jackclock.hpp"
+#include "jackbus.hpp"
 
 namespace JackCpp {
 
+	class AudioRouter;
+
 /** 
 @class AudioIO
 
@@ -52,6 +72,8 @@ In that method you can get audio in from jack and write it out to jack.
 			///A typedef so so that we don't always have to write std::vector<jack_default_audio_sample_t *>
 			typedef std::vector<jack_default_audio_sample_t *> audioBufVector;
 		private:
+			//runs the processAudio of its nodes
+			friend class AudioRouter;
 			//commands
 			enum cmd_t {add_in_port, add_out_port};
 			RingBuffer<cmd_t> mCmdBuffer;
@@ -72,14 +94,148 @@ In that method you can get audio in from jack and write it out to jack.
 			audioBufVector mJackOutBuf;
 			//this stores the state of this jack process [active,notActive,closed]
 			jack_state_t mJackState;
+			//set just before jack_activate, jack may call the callbacks from inside it
+			volatile bool mCallbacksLive;
 			//this prepares the input/output buffers to be passed 
 			//to the callback function that a user writes
 			//XXX should this be virtual?
 			inline int jackToClassAudioCallback(jack_nframes_t nframes);
-			std::vector<std::string> mPortNames;
+			std::set<std::string> mPortNames;
+			//a cache of the server's ports, so we don't have to ask it
+			PortRegistry mPortRegistry;
+
+			//delay lines that line up inputs that arrive with different latencies,
+			//this depends on the buffer size so it is swapped into the callback
+			struct latency_comp_t {
+				jack_nframes_t frames;
+				unsigned int lineLength;
+				std::vector<jack_nframes_t> delays;
+				std::vector<unsigned int> writePos;
+				std::vector<jack_default_audio_sample_t> lines;
+				std::vector<jack_default_audio_sample_t> scratch;
+			};
+			latency_comp_t * createLatencyComp(const std::vector<jack_nframes_t>& delays,
+					jack_nframes_t frames);
+			//delay the inputs, replacing their buffers in mJackInBuf
+			void compensateLatency(latency_comp_t * comp, jack_nframes_t nframes);
+			//work out the delays from our input ports' capture latencies,
+			//returns the latency that the inputs are aligned to
+			jack_nframes_t updateLatencyComp();
+			jack_latency_range_t mProcessingLatency;
+			bool mLatencyCompensation;
+			jack_nframes_t mMaxCompensationDelay;
+			//only used outside of the callback
+			std::vector<jack_nframes_t> mCompDelays;
+			RTSwap<latency_comp_t> mLatencyComp;
+
+			//the transport at the start of the current cycle, only used by the callback
+			TransportInfo mTransport;
+			//the same, for other threads
+			SeqLock<TransportInfo> mTransportShared;
+			//the tempo used when we are timebase master
+			struct tempo_t {
+				double beatsPerMinute;
+				float beatsPerBar;
+				float beatType;
+				double ticksPerBeat;
+			};
+			//tempo changes on their way to the callback, and the callback's copy
+			RingBuffer<tempo_t> mTempoBuffer;
+			tempo_t mTempo;
+
+			//scratch memory for the callback, it depends on the buffer size
+			RTSwap<RTArena> mArena;
+			unsigned int mArenaBlocks;
+			size_t mArenaExtraBytes;
+			RTArena * createArena(jack_nframes_t frames);
+			//only written by the callback, except mArenaCapacity
+			volatile size_t mArenaCapacity;
+			volatile size_t mArenaHighWater;
+			volatile unsigned int mArenaFailures;
+			unsigned int mArenaFailuresAtStart;
+
+			//how to set up the process thread, and what happened when we did
+			ThreadConfig mThreadConfig;
+			SeqLock<ThreadStatus> mThreadStatus;
+
+			//graph changes on their way from jack's notification thread to the user
+			RingBuffer<GraphEvent> mGraphEvents;
+			Notifier mGraphNotifier;
+			volatile unsigned int mDroppedGraphEvents;
+
+			//set by jack's freewheel callback, which may not be in the process thread
+			volatile bool mFreewheeling;
+			//the current or last freewheel run, only written by the process thread
+			struct freewheel_state_t {
+				bool running;
+				//the run started with a render sink, it ends when the sink is detached
+				bool rendering;
+				//the run ended while still freewheeling, don't start another
+				bool finished;
+				uint64_t frames;
+				jack_time_t startUsecs;
+				jack_time_t lastUsecs;
+			};
+			freewheel_state_t mFreewheelState;
+			SeqLock<freewheel_state_t> mFreewheelShared;
+			//where renderOutputs sends our outputs, NULL when we aren't rendering
+			RenderSink * volatile mRenderSink;
+			//counts the cycles that are done with the sink, so stopRender knows
+			//when the callback has let go of it
+			volatile unsigned int mRenderCycles;
+			//whether startRender turned freewheeling on
+			bool mRenderFreewheel;
+
+			//the port meters, NULL when metering is off
+			RTSwap<MeterBank> mMeters;
+			MeterConfig mMeterConfig;
+			bool mMetering;
+			//readers share it, replacing the meters takes it exclusively
+			//so a bank isn't deleted while it is being read
+			pthread_rwlock_t mMeterLock;
+			//false, having kept the old meters, if too many are waiting for the callback
+			bool updateMeters(jack_nframes_t rate);
+
+			//maps frame times to system times, fed by startCycle
+			FrameClock mClock;
+			//the current cycle's times, only used by the callback
+			CycleTimes mCycleTimes;
+
+			//groups of ports gathered into buses, the buses depend on the buffer
+			//size so they are swapped into the callback
+			struct bus_def_t {
+				unsigned int first;
+				unsigned int count;
+				bool contiguous;
+			};
+			std::vector<bus_def_t> mInBusDefs;
+			std::vector<bus_def_t> mOutBusDefs;
+			struct bus_set_t {
+				std::vector<bus_def_t> inDefs;
+				std::vector<bus_def_t> outDefs;
+				std::vector<AudioBus *> in;
+				std::vector<AudioBus *> out;
+				~bus_set_t();
+			};
+			bus_set_t * createBuses(jack_nframes_t frames);
+			RTSwap<bus_set_t> mBuses;
+			//the buses of the current cycle, only used by the callback
+			bus_set_t * mCycleBuses;
+			//gather the input buses and bind the output buses, replacing their
+			//ports' buffers in inBufs and outBufs
+			void gatherBuses(bus_set_t * buses, jack_nframes_t nframes,
+					jack_default_audio_sample_t ** inBufs, unsigned int inCount,
+					jack_default_audio_sample_t ** outBufs, unsigned int outCount);
+			unsigned int addBus(std::vector<bus_def_t>& defs, unsigned int ports,
+					unsigned int first, unsigned int count, bool contiguous)
+				JACKCPP_THROW(std::range_error, std::runtime_error);
 		protected:
 			/**
 			  @brief The method that the user must overload in order to actually process jack data.
+
+			  The vectors are copied for every call, which allocates memory in
+			  the realtime thread, override processAudio instead to avoid that.
+			  The default writes silence.
 			  \param nframes the number frames to process
 			  \param inBufs a vector of audio buffers
 			  \param outBufs a vector of audio buffers
@@ -87,7 +243,103 @@ In that method you can get audio in from jack and write it out to jack.
 			  */
 			virtual int audioCallback(jack_nframes_t nframes, 
 					audioBufVector inBufs,
-					audioBufVector outBufs) = 0;
+					audioBufVector outBufs);
+			/**
+			  @brief Process jack data without copying the buffer vectors
+
+			  This is what the jack callback calls, the default calls
+			  audioCallback.  Override this or audioCallback, not both.
+			  \param nframes the number frames to process
+			  \param inBufs a vector of audio buffers
+			  \param outBufs a vector of audio buffers
+			  \return 0 on success, non zero on error, which will cause jack to remove the client from the process graph
+			  */
+			virtual int processAudio(jack_nframes_t nframes,
+					const audioBufVector& inBufs,
+					const audioBufVector& outBufs);
+			/**
+			  @brief Do the per cycle work that doesn't involve the port buffers [realtime]
+
+			  Takes the transport snapshot and resets the realtime arena.  This
+			  is for subclasses that install their own process callback, they
+			  must call finishCycle with the result after processing.
+			  \return the realtime arena for this cycle, may be NULL
+			  */
+			RTArena * startCycle();
+			///Finish a cycle started with startCycle [realtime]
+			void finishCycle(RTArena * arena);
+			/**
+			  @brief Count the cycle's frames while freewheeling and pass the outputs to the render sink [realtime]
+
+			  Call this after processing, the default callback does.  While
+			  freewheeling it may block until the sink has room.
+			  \param nframes the number of frames in this cycle
+			  \param outBufs the output buffers
+			  \param channels the number of output buffers
+			  */
+			void renderOutputs(jack_nframes_t nframes,
+					jack_default_audio_sample_t * const * outBufs, unsigned int channels);
+			/**
+			  @brief Gather the input buses and bind the output buses for this cycle [realtime]
+
+			  For subclasses that install their own process callback, call it
+			  after getting the port buffers and before processing, the bus
+			  channels replace their ports' buffers in inBufs and outBufs.
+			  Call scatterBuses after processing.
+			  \param nframes the number of frames in this cycle
+			  \param inBufs the input port buffers
+			  \param inCount the number of input buffers
+			  \param outBufs the output port buffers
+			  \param outCount the number of output buffers
+			  \sa addInBus, addOutBus
+			  */
+			void applyBuses(jack_nframes_t nframes,
+					jack_default_audio_sample_t ** inBufs, unsigned int inCount,
+					jack_default_audio_sample_t ** outBufs, unsigned int outCount);
+			///Write this cycle's output buses to their ports, after applyBuses [realtime]
+			void scatterBuses();
+			///Get the frame time of the first frame of the current cycle [realtime]
+			jack_nframes_t cycleStartFrame(){return mCycleTimes.frames;}
+			/**
+			  @brief Whether the callbacks may be running
+
+			  True from just before the client is activated, jack can call the
+			  buffer size callback from inside jack_activate, until it is
+			  deactivated.  State rebuilt while this is true has to be
+			  published to the callback rather than swapped in with reset.
+			  */
+			bool callbacksLive(){return mCallbacksLive;}
+			/**
+			  @brief Meter the cycle's buffers, if metering is on [realtime]
+
+			  Call this after processing, the default callback does.
+			  \sa setMetering
+			  */
+			void meterBuffers(jack_nframes_t nframes,
+					jack_default_audio_sample_t * const * inBufs, unsigned int inCount,
+					jack_default_audio_sample_t * const * outBufs, unsigned int outCount);
+			/**
+			  @brief Get one of the input buses in this cycle [realtime]
+
+			  Only valid inside processAudio or audioCallback.  The ports of
+			  the bus are also in the inBufs given to the callback, pointing at
+			  the bus's channels.
+			  \param index the bus, as returned by addInBus
+			  \return the bus, or NULL if there is no such bus
+			  \sa addInBus
+			  */
+			AudioBus * inBus(unsigned int index);
+			/**
+			  @brief Get one of the output buses in this cycle [realtime]
+
+			  Whatever is rendered into its channels goes to its ports after
+			  the callback, so write either to it or to outBufs, they are the
+			  same buffers.
+			  \param index the bus, as returned by addOutBus
+			  \return the bus, or NULL if there is no such bus
+			  \sa addOutBus
+			  */
+			AudioBus * outBus(unsigned int index);
 		public:
 			/**
 			  @brief Gives users a pointer to the client created and used by this class.
@@ -111,7 +363,7 @@ In that method you can get audio in from jack and write it out to jack.
 #else
 					bool startServer = true)
 #endif
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 
       //create the object but don't actually create the client yet
 			AudioIO();
@@ -124,7 +376,7 @@ In that method you can get audio in from jack and write it out to jack.
 #else
 					bool startServer = true)
 #endif
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 
 			///The Destructor
 			virtual ~AudioIO();
@@ -145,6 +397,15 @@ In that method you can get audio in from jack and write it out to jack.
 			///See if a port with the name "name" exists for our client
 			bool portExists(std::string name);
 
+			/**
+			   @brief Get the cache of the jack server's ports
+
+				The registry is kept up to date by the port registration and
+				rename callbacks, so it can be queried as often as you like
+				without talking to the jack server.
+			*/
+			PortRegistry& portRegistry(){return mPortRegistry;}
+
 			/**
 			   @brief Reserve output ports
 
@@ -158,7 +419,7 @@ In that method you can get audio in from jack and write it out to jack.
 			  \param num an integer indicating the number of output ports to reserve
 			*/
 			virtual void reserveOutPorts(unsigned int num)
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 			/**
 			   @brief Reserve input ports
 
@@ -172,17 +433,17 @@ In that method you can get audio in from jack and write it out to jack.
 			  \param num an integer indicating the number of input ports to reserve
 			*/
 			virtual void reserveInPorts(unsigned int num)
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 
 			///Start the jack client.
 			void start()
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 			///Stop the jack client.
 			void stop()
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 			///Close the jack client.
 			void close()
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 
 			///Get the number of jack input ports
 			unsigned int inPorts();
@@ -195,14 +456,52 @@ In that method you can get audio in from jack and write it out to jack.
 			  \return the number of total input ports
 			*/
 			virtual unsigned int addInPort(std::string name)
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 			/**
 			   @brief Add a jack output port to our client
 			  \param name string the name of the port to add
 			  \return the number of total output ports
 			*/
 			virtual unsigned int addOutPort(std::string name)
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
+
+			/**
+			   @brief Group some of our input ports into a bus
+
+				When contiguous is true the ports are copied into one dense,
+				aligned, planar block every cycle before the callback, and the
+				callback's inBufs point into that block, so processing that runs
+				across the channels, like mixMatrix, works on one array instead
+				of buffers scattered around the server's memory.  The copy costs
+				a pass over the data, so it pays for itself when there are many
+				channels and the processing goes over them more than once, see
+				testjackbus.  Otherwise the bus just points at the ports.
+
+				Buses can't overlap and can only be added while the client isn't
+				active.  Buses are only used by the default callback, a
+				FixedAudioIO can call AudioBus::gather itself.
+
+			  \param first the first port of the bus
+			  \param count the number of ports in the bus
+			  \param contiguous whether to gather the ports into one block
+			  \return the index of the bus
+			  \sa inBus, AudioBus
+			*/
+			unsigned int addInBus(unsigned int first, unsigned int count, bool contiguous = true)
+				JACKCPP_THROW(std::range_error, std::runtime_error);
+			/**
+			   @brief Group some of our output ports into a bus
+
+				Like addInBus, a contiguous bus is rendered into its block and
+				copied out to the ports after the callback.
+
+			  \sa addInBus, outBus
+			*/
+			unsigned int addOutBus(unsigned int first, unsigned int count, bool contiguous = true)
+				JACKCPP_THROW(std::range_error, std::runtime_error);
+			///Remove every bus, only while the client isn't active
+			void clearBuses()
+				JACKCPP_THROW(std::runtime_error);
 
 			/**
 			   @brief Connect our output to a jack client's source port.
@@ -210,41 +509,68 @@ In that method you can get audio in from jack and write it out to jack.
 			  \param sourcePortName the client:port name to connect to
 			*/
 			void connectTo(unsigned int index, std::string sourcePortName) 
-				throw(std::range_error, std::runtime_error);
+				JACKCPP_THROW(std::range_error, std::runtime_error);
 			/**
 			   @brief Connect our input to a jack client's destination port.
 			  \param index the index of our input port to connect to
 			  \param destPortName the client:port name to connect from
 			*/
 			void connectFrom(unsigned int index, std::string destPortName)
-				throw(std::range_error, std::runtime_error);
+				JACKCPP_THROW(std::range_error, std::runtime_error);
 			/**
 			   @brief Connect our output port to a physical output port
 			  \param index the index of our output port to connect from
 			  \param physical_index the physical output port index to connect to
 			*/
 			void connectToPhysical(unsigned int index, unsigned physical_index)
-				throw(std::range_error, std::runtime_error);
+				JACKCPP_THROW(std::range_error, std::runtime_error);
 			/**
 			   @brief Connect our input port to a physical input port
 			  \param index the index of our input port to connect to
 			  \param physical_index the physical input port index to connect from
 			*/
 			void connectFromPhysical(unsigned int index, unsigned physical_index)
-				throw(std::range_error, std::runtime_error);
+				JACKCPP_THROW(std::range_error, std::runtime_error);
+			/**
+			   @brief Make a whole set of connections on a background thread
+
+				The set is compared with the connections that already exist and
+				only the connects and disconnects that are needed are made.
+				Failures don't stop the job, they are reported in its results.
+				The returned job must be deleted by the caller before this client
+				is deleted.
+
+			  \param set the connections to make
+			  \param exclusive if true, connections to our ports that are not in set are removed
+			  \param callback called from the background thread when the job is done, may be NULL
+			  \param arg passed to callback
+			  \return a job that can be waited on for the results
+			  \sa getConnections
+			*/
+			ConnectionJob * applyConnections(const ConnectionSet& set, bool exclusive = false,
+					ConnectionJob::callback_t callback = NULL, void * arg = NULL)
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			   @brief Get all of the connections to our ports
+
+				Pass the result to applyConnections, with exclusive set, to restore
+				the connections later, ConnectionSet::write and
+				ConnectionSet::read save it to and load it from a file.
+			*/
+			ConnectionSet getConnections();
 			///Disconnect input port from all connections
 			void disconnectInPort(unsigned int index)
-				throw(std::range_error, std::runtime_error);
+				JACKCPP_THROW(std::range_error, std::runtime_error);
 			///Disconnect output port from all connections
 			void disconnectOutPort(unsigned int index)
-				throw(std::range_error, std::runtime_error);
+				JACKCPP_THROW(std::range_error, std::runtime_error);
 
 			///Get the number of connections to our input port
 			unsigned int numConnectionsInPort(unsigned int index)
-				throw(std::range_error);
+				JACKCPP_THROW(std::range_error);
 			///Get the number of connections to our output port
 			unsigned int numConnectionsOutPort(unsigned int index)
-				throw(std::range_error);
+				JACKCPP_THROW(std::range_error);
 
 			/**
 			   @brief Get the number of physical audio input ports
@@ -257,18 +583,281 @@ In that method you can get audio in from jack and write it out to jack.
 			*/
 			unsigned int numPhysicalDestinationPorts();
 
+			///Get one of our client's input ports
+			jack_port_t * getInputPort(unsigned int index)
+				JACKCPP_THROW(std::range_error);
+			///Get one of our client's output ports
+			jack_port_t * getOutputPort(unsigned int index)
+				JACKCPP_THROW(std::range_error);
 			///Get the name of our client's input port
 			std::string getInputPortName(unsigned int index)
-				throw(std::range_error);
+				JACKCPP_THROW(std::range_error);
 			///Get the name of our client's output port
 			std::string getOutputPortName(unsigned int index)
-				throw(std::range_error);
+				JACKCPP_THROW(std::range_error);
 
 			/**
 			 	@brief This method is called when Jack shuts down.
 				Override if you want to do something when jack shuts down.
 			*/
 			virtual void jackShutdownCallback();
+
+			/**
+			   @brief Called when the jack graph changes
+
+				This is called from jack's notification thread for client and
+				port registration, port renames, connections, graph reorders and
+				xruns.  The default queues the event for getGraphEvent and
+				waitGraphEvent, if you override this and still want the events
+				queued call AudioIO::jackGraphEventCallback.  Don't block in here,
+				jack waits for it to return.
+			*/
+			virtual void jackGraphEventCallback(const GraphEvent& event);
+			/**
+			   @brief Get the next queued graph event without blocking
+
+				Only one thread should read events.
+			  \param event filled in with the event
+			  \return true if there was an event
+			*/
+			bool getGraphEvent(GraphEvent& event);
+			/**
+			   @brief Wait for the next queued graph event
+
+				Only one thread should read events.
+			  \param event filled in with the event
+			  \param timeoutMs the maximum time to wait in milliseconds, negative waits forever
+			  \return true if there was an event, false if we timed out
+			*/
+			bool waitGraphEvent(GraphEvent& event, int timeoutMs = -1);
+			/**
+			   @brief Get a file descriptor that is readable when graph events are queued
+
+				Add this to your select, poll or event loop, when it is readable
+				call getGraphEvent until it returns false.
+			*/
+			int graphEventFd();
+			///Get the number of graph events that were lost because the queue was full
+			unsigned int droppedGraphEvents();
+			/**
+			 	@brief This method is called when the jack buffer size is about to change.
+
+				Override if you keep anything that depends on the buffer size, and
+				call AudioIO::jackBufferSizeCallback from your override.  It is
+				not called from the realtime thread, so it may allocate, but the
+				jack callback may still be running, anything it uses should be
+				handed over with an RTSwap.
+
+				\param nframes the new buffer size
+				\return 0 on success, non zero on error
+				\sa RTSwap
+			*/
+			virtual int jackBufferSizeCallback(jack_nframes_t nframes);
+			/**
+			 	@brief This method is called when the jack sample rate changes.
+
+				Override if you keep anything that depends on the sample rate,
+				and call AudioIO::jackSampleRateCallback from your override so
+				the meters are rebuilt.  Like jackBufferSizeCallback it is not
+				called from the realtime thread.
+
+				\param rate the new sample rate
+				\return 0 on success, non zero on error
+			*/
+			virtual int jackSampleRateCallback(jack_nframes_t rate);
+			/**
+			 	@brief This method is called when jack recomputes port latencies.
+
+				The default implementation propagates latency through our client:
+				in JackCaptureLatency mode our outputs get the latency of our
+				inputs plus the processing latency, in JackPlaybackLatency mode
+				our inputs get the latency of our outputs plus the processing
+				latency.  It also updates the delays used by latency compensation.
+				Override if your ports have more complicated latency paths, using
+				setInPortLatencyRange and setOutPortLatencyRange.
+
+				\param mode whether capture or playback latency is being computed
+				\sa setProcessingLatency
+			*/
+			virtual void jackLatencyCallback(jack_latency_callback_mode_t mode);
+
+			/**
+			 	@brief Set the latency that our processing adds between inputs and outputs
+
+				This is reported to jack by the default jackLatencyCallback, for
+				instance the lookahead of a limiter or the buffering of
+				BlockingAudioIO.
+
+				\param min the shortest latency, in frames
+				\param max the longest latency, in frames
+				\param recompute whether to ask jack to recompute the graph's latency, this
+				must be false when called from a jack callback
+			*/
+			void setProcessingLatency(jack_nframes_t min, jack_nframes_t max, bool recompute = true)
+				JACKCPP_THROW(std::runtime_error);
+			///Get the latency that our processing adds between inputs and outputs
+			jack_latency_range_t getProcessingLatency(){return mProcessingLatency;}
+			///Ask jack to recompute the latency of the whole graph
+			void recomputeLatencies()
+				JACKCPP_THROW(std::runtime_error);
+
+			/**
+			 	@brief Get the latency range of one of our input ports
+
+				In JackCaptureLatency mode this is how long ago the audio
+				arriving at the port was captured, ie. the upstream latency.  In
+				JackPlaybackLatency mode it is how long until audio from the port
+				is played back.
+
+				\param index the index of our input port
+				\param mode capture or playback latency
+			*/
+			jack_latency_range_t getInPortLatencyRange(unsigned int index, jack_latency_callback_mode_t mode)
+				JACKCPP_THROW(std::range_error);
+			///Get the latency range of one of our output ports
+			jack_latency_range_t getOutPortLatencyRange(unsigned int index, jack_latency_callback_mode_t mode)
+				JACKCPP_THROW(std::range_error);
+			///Set the latency range of one of our input ports, only call this from jackLatencyCallback
+			void setInPortLatencyRange(unsigned int index, jack_latency_callback_mode_t mode,
+					jack_latency_range_t range)
+				JACKCPP_THROW(std::range_error);
+			///Set the latency range of one of our output ports, only call this from jackLatencyCallback
+			void setOutPortLatencyRange(unsigned int index, jack_latency_callback_mode_t mode,
+					jack_latency_range_t range)
+				JACKCPP_THROW(std::range_error);
+
+			/**
+			 	@brief Line up inputs that arrive with different latencies
+
+				When enabled, each input is delayed by the difference between its
+				capture latency and the largest capture latency of our inputs,
+				before the buffers are handed to audioCallback.  The delays are
+				updated whenever jack recomputes latencies.  This must be called
+				before the client is started.
+
+				\param enable a boolean indicating whether to compensate
+				\param maxDelay the longest delay, in frames, that we will add to an input
+			*/
+			void setLatencyCompensation(bool enable, jack_nframes_t maxDelay = 4096)
+				JACKCPP_THROW(std::runtime_error);
+
+			/**
+			 	@brief Set up the process thread when jack starts it
+
+				The config is applied by jackThreadInitCallback, in the process
+				thread, when the client is started.  This must be called before
+				the client is started.
+
+				\sa getThreadStatus
+			*/
+			void setThreadConfig(const ThreadConfig& config)
+				JACKCPP_THROW(std::runtime_error);
+			///Get the process thread config
+			const ThreadConfig& getThreadConfig(){return mThreadConfig;}
+			/**
+			 	@brief Find out what was done to the process thread
+
+				ThreadStatus::applied is false until jack has started the thread.
+			*/
+			ThreadStatus getThreadStatus(){return mThreadStatus.read();}
+			/**
+			 	@brief This method is called by jack in each thread it starts for our client
+
+				The default applies the config given to setThreadConfig, if you
+				override this call AudioIO::jackThreadInitCallback.
+			*/
+			virtual void jackThreadInitCallback();
+
+			///Statistics about the realtime arena
+			struct arena_stats_t {
+				///the number of bytes the arena holds
+				size_t capacity;
+				///the most bytes allocated in one cycle
+				size_t highWater;
+				///the number of allocations that failed because the arena was full
+				unsigned int failures;
+			};
+			/**
+			 	@brief Give the callback a realtime arena for scratch memory
+
+				The arena holds blocks scratch blocks of getBufferSize() samples,
+				plus extraBytes, and it is rebuilt when the buffer size changes.
+				It is reset at the start of every cycle.  Pass 0 for both to
+				remove it.  This must be called before the client is started.
+
+				\param blocks the number of scratch blocks the callback needs per cycle
+				\param extraBytes the number of bytes the callback needs for other allocations
+				\sa rtArena, RTArena::scratchBlock
+			*/
+			void setRTArenaSize(unsigned int blocks, size_t extraBytes = 0)
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			 	@brief Get the realtime arena [realtime]
+
+				Only use this from within audioCallback, anything allocated from
+				it is invalid after the callback returns.
+				\return the arena, or NULL if setRTArenaSize hasn't been called
+			*/
+			RTArena * rtArena(){return mArena.get();}
+			///Get the realtime arena's statistics, from any thread
+			arena_stats_t getRTArenaStats();
+
+			/**
+			 	@brief Get the transport state for the current cycle [realtime]
+
+				The transport is queried once at the start of every cycle, so
+				there is no need to call jack_transport_query from audioCallback.
+				Only use this from within audioCallback, other threads should use
+				getTransport.
+
+				\return the transport snapshot taken at the start of this cycle
+				\sa BeatGrid
+			*/
+			const TransportInfo& transport() const {return mTransport;}
+			/**
+			 	@brief Get the transport state from the most recent cycle
+
+				This can be called from any thread and does not talk to the jack
+				server, it is a copy of what the callback saw.
+			*/
+			TransportInfo getTransport() const {return mTransportShared.read();}
+
+			/**
+			 	@brief Become the jack timebase master
+
+				While we are the timebase master, jackTimebaseCallback provides
+				the BBT information for every client's transport.
+
+				\param conditional if true, fail if there is already a timebase master
+				\sa setTimebaseTempo, jackTimebaseCallback
+			*/
+			void setTimebaseMaster(bool conditional = false)
+				JACKCPP_THROW(std::runtime_error);
+			///Stop being the jack timebase master
+			void releaseTimebase()
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			 	@brief Set the tempo that the default jackTimebaseCallback reports
+
+				This can be called while the client is running, the change takes
+				effect in the next cycle.
+			*/
+			void setTimebaseTempo(double beatsPerMinute, float beatsPerBar = 4.0f,
+					float beatType = 4.0f, double ticksPerBeat = 1920.0);
+			/**
+			 	@brief This method is called in the process thread when we are timebase master
+
+				The default implementation fills in pos with the bar, beat and tick
+				for pos->frame at the tempo given to setTimebaseTempo.  Override it
+				to provide a tempo map of your own.
+
+				\param state the current transport state
+				\param nframes the number of frames in this cycle
+				\param pos the position to fill in, pos->frame and pos->frame_rate are valid
+				\param newPos true if the position changed since the last call
+			*/
+			virtual void jackTimebaseCallback(jack_transport_state_t state, jack_nframes_t nframes,
+					jack_position_t *pos, bool newPos);
 			/**
 			 	@brief The current CPU load estimated by JACK
 				
@@ -283,6 +872,94 @@ In that method you can get audio in from jack and write it out to jack.
 			jack_nframes_t getBufferSize();
 			///Check to see if the client is running in real time mode
 			bool isRealTime(){return jack_is_realtime(mJackClient);}
+
+			/**
+			 	@brief Turn jack's freewheel mode on or off
+
+				While freewheeling jack runs the process graph as fast as it can,
+				without waiting for the audio interface, so a session can be
+				rendered faster than realtime.  This affects every client of the
+				server, they are all told with jackFreewheelCallback.
+				\sa startRender
+			*/
+			void setFreewheel(bool onoff) JACKCPP_THROW(std::runtime_error);
+			///Check to see if jack is freewheeling
+			bool isFreewheeling(){return mFreewheeling;}
+			/**
+			 	@brief This method is called when jack starts or stops freewheeling
+
+				The process callback is not realtime while freewheeling.  If you
+				override this call AudioIO::jackFreewheelCallback.
+				\param starting true if jack is starting to freewheel
+			*/
+			virtual void jackFreewheelCallback(bool starting);
+			///Statistics about the current or last freewheel run
+			struct freewheel_stats_t {
+				///true while freewheeling
+				bool running;
+				///the number of frames processed while freewheeling
+				uint64_t frames;
+				///the wall clock time that took
+				double seconds;
+				///how many times faster than realtime that was
+				double speedup;
+			};
+			///Get statistics about the current or last freewheel run, a run that started with a render sink ends when the sink is detached
+			freewheel_stats_t getFreewheelStats();
+			/**
+			 	@brief Send our outputs to a sink, usually while freewheeling
+
+				Every cycle of output is handed to sink.renderFrames.  While
+				freewheeling the sink is allowed to block, so a sink that writes to
+				disk holds the render back to the speed of the disk instead of
+				losing frames.  The sink must stay valid until stopRender returns.
+				\param sink where to send the outputs
+				\param freewheel true to start freewheeling too
+			*/
+			void startRender(RenderSink * sink, bool freewheel = true)
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			 	@brief Stop sending our outputs to the sink and stop freewheeling
+
+				Once this returns the callback won't use the sink again.  While
+				the client is active this waits for a cycle to finish with the
+				sink, so a callback of your own must call renderOutputs every cycle.
+			*/
+			void stopRender() JACKCPP_THROW(std::runtime_error);
+
+			/**
+			 	@brief Turn metering of every port on or off
+
+				The callback measures the peak, RMS and true peak of every input
+				and output port after processing and publishes them with the
+				config's ballistics.  Read them with getInputMeter,
+				getOutputMeter or getMeters from any number of threads, at any
+				rate, without holding up the callback.  Turning it on again, or
+				changing the sample rate, restarts the meters.
+				\param enable true to meter the ports
+				\param config the ballistics of the meters
+				\throw std::runtime_error if the callback hasn't caught up with
+				the previous changes, try again after a cycle
+			*/
+			void setMetering(bool enable, const MeterConfig& config = MeterConfig())
+				JACKCPP_THROW(std::runtime_error);
+			///Check to see if the ports are being metered
+			bool getMetering(){return mMetering;}
+			///Get an input port's levels, they are zero if metering is off
+			MeterReading getInputMeter(unsigned int index)
+				JACKCPP_THROW(std::range_error);
+			///Get an output port's levels, they are zero if metering is off
+			MeterReading getOutputMeter(unsigned int index)
+				JACKCPP_THROW(std::range_error);
+			/**
+			 	@brief Get the levels of every port at once
+
+				\param inputs filled in with a reading for every input port
+				\param outputs filled in with a reading for every output port
+			*/
+			void getMeters(std::vector<MeterReading>& inputs, std::vector<MeterReading>& outputs);
+			///Reset the peak holds of every meter
+			void resetMeterHolds();
 			/**
 			 	@brief Get the name of our client
 
@@ -310,6 +987,35 @@ In that method you can get audio in from jack and write it out to jack.
 				\return the time in frames that has passed since the JACK server began the current process cycle
 			*/
 			jack_nframes_t getFramesSinceCycleStart(){return jack_frames_since_cycle_start(mJackClient);}
+
+			/**
+			 	@brief Get the system time of a frame time
+
+				Every cycle the callback feeds jack_get_cycle_times to a
+				delay-locked loop that tracks the real rate of the audio clock,
+				so this is cheap and can be called from any thread.  Before the
+				first cycle, and while freewheeling, jack does the conversion.
+				Frames and times in the past and future both work.
+
+				\param frames a frame time, as returned by getFrameTime
+				\return the system time in microseconds, comparable with jack_get_time
+				\sa timeToFrames, FrameClock
+			*/
+			jack_time_t framesToTime(jack_nframes_t frames);
+			/**
+			 	@brief Get the frame time of a system time
+
+				\param usecs a system time in microseconds, as returned by jack_get_time
+				\return the frame time at usecs
+				\sa framesToTime
+			*/
+			jack_nframes_t timeToFrames(jack_time_t usecs);
+			///Get the sample rate of the audio clock as measured against the system clock
+			double getMeasuredSampleRate();
+			///Get the times of the last cycle, as jack_get_cycle_times reported them
+			CycleTimes getCycleTimes(){return mClock.cycleTimes();}
+			///Set the bandwidth of the clock's delay-locked loop in Hz, the default is 0.5
+			void setClockBandwidth(double bandwidth){mClock.setBandwidth(bandwidth);}
 	};
 
 }
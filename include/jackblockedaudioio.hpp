@@ -0,0 +1,263 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_BLOCKED_AUDIO_IO_HPP
+#define JACK_BLOCKED_AUDIO_IO_HPP
+
+#include "jackaudioio.hpp"
+#include <algorithm>
+#include <string.h>
+
+namespace JackCpp {
+
+template<unsigned int BlockSize, typename Derived>
+
+/**
+@class BlockedAudioIO
+
+@brief An AudioIO that processes in blocks of a size fixed at compile time, whatever the jack buffer size.
+
+Instead of overriding audioCallback, Derived provides
+
+	int processBlock(jack_default_audio_sample_t * const * in, jack_default_audio_sample_t * const * out);
+
+which is always called with blockSize frames per port, and is called
+directly, not through a virtual function, so loops over blockSize can be
+unrolled and vectorized for that size.  Blocks can be smaller or larger
+than the jack buffer size.
+
+When the buffer size is a multiple of BlockSize the port buffers are
+processed in place, a block at a time, with no added latency.  Otherwise
+the input is gathered into a block and the output is played from a ring,
+which adds BlockSize - nframes frames of latency when BlockSize is a
+multiple of the buffer size and BlockSize frames otherwise.  The latency is
+reported to jack with setProcessingLatency, and is recalculated when the
+buffer size changes.  All of the buffers are allocated outside of the
+callback.
+
+	class Spectrum : public JackCpp::BlockedAudioIO<1024, Spectrum> {
+		public:
+			Spectrum() : JackCpp::BlockedAudioIO<1024, Spectrum>("spectrum", 1, 1) {}
+			~Spectrum(){
+				//processBlock uses our members, so stop before they go away
+				if(getState() == JackCpp::AudioIO::active)
+					stop();
+			}
+			int processBlock(jack_default_audio_sample_t * const * in, jack_default_audio_sample_t * const * out){
+				//a 1024 point FFT of in[0]...
+				return 0;
+			}
+	};
+
+Ports can only be added while the client isn't active.  processBlock is
+called on Derived, whose members are destroyed before our destructor runs,
+so Derived must stop the client in its own destructor as above.
+
+@author Alex Norman
+
+*/
+	class BlockedAudioIO : public AudioIO {
+		public:
+			///The number of frames processBlock is called with
+			enum {blockSize = BlockSize};
+
+			/**
+			  @brief The Constructor
+			  \param name string indicating the name of the jack client to create
+			  \param inPorts the number of input ports to create
+			  \param outPorts the number of output ports to create
+			  \param startServer a boolean indicating whether to start a jack server if one isn't already running
+			  */
+			BlockedAudioIO(std::string name, unsigned int inPorts = 2, unsigned int outPorts = 2,
+#ifdef __APPLE__
+					bool startServer = false)
+#else
+					bool startServer = true)
+#endif
+				JACKCPP_THROW(std::runtime_error) :
+				AudioIO(name, inPorts, outPorts, startServer)
+			{
+				updateBlockState(getBufferSize());
+			}
+			/**
+			  @brief The Destructor, stops the client before the blocks go away
+
+			  This runs after Derived is destroyed, too late for a processBlock
+			  that uses Derived's members, Derived must stop the client in its
+			  own destructor.
+			  */
+			virtual ~BlockedAudioIO(){
+				if(getState() == AudioIO::active)
+					stop();
+			}
+
+			///Add an input port, only while the client isn't active
+			virtual unsigned int addInPort(std::string name)
+				JACKCPP_THROW(std::runtime_error){
+				if(getState() == AudioIO::active)
+					throw std::runtime_error("JackCpp::BlockedAudioIO::addInPort not allowed while the client is active");
+				unsigned int ret = AudioIO::addInPort(name);
+				updateBlockState(getBufferSize());
+				return ret;
+			}
+			///Add an output port, only while the client isn't active
+			virtual unsigned int addOutPort(std::string name)
+				JACKCPP_THROW(std::runtime_error){
+				if(getState() == AudioIO::active)
+					throw std::runtime_error("JackCpp::BlockedAudioIO::addOutPort not allowed while the client is active");
+				unsigned int ret = AudioIO::addOutPort(name);
+				updateBlockState(getBufferSize());
+				return ret;
+			}
+
+			///Rebuilds the blocks for the new buffer size
+			virtual int jackBufferSizeCallback(jack_nframes_t nframes){
+				int ret = AudioIO::jackBufferSizeCallback(nframes);
+				if(!updateBlockState(nframes))
+					ret = 1;
+				return ret;
+			}
+
+			///Get the latency the blocking adds at a buffer size
+			static jack_nframes_t blockLatency(jack_nframes_t nframes){
+				if(nframes % BlockSize == 0)
+					return 0;
+				if(BlockSize % nframes == 0)
+					return BlockSize - nframes;
+				return BlockSize;
+			}
+		protected:
+			virtual int processAudio(jack_nframes_t nframes,
+					const audioBufVector& inBufs,
+					const audioBufVector& outBufs){
+				block_state_t * st = mBlockState.acquire();
+				if(st == NULL || nframes != st->frames){
+					for(unsigned int i = 0; i < outBufs.size(); i++)
+						memset(outBufs[i], 0, nframes * sizeof(jack_default_audio_sample_t));
+					return 0;
+				}
+				const unsigned int ins = std::min((unsigned int)inBufs.size(), st->ins);
+				const unsigned int outs = std::min((unsigned int)outBufs.size(), st->outs);
+				Derived * self = static_cast<Derived *>(this);
+
+				//whole blocks straight from the ports
+				if(st->latency == 0){
+					for(jack_nframes_t pos = 0; pos < nframes; pos += BlockSize){
+						for(unsigned int i = 0; i < ins; i++)
+							st->inPtrs[i] = inBufs[i] + pos;
+						for(unsigned int i = 0; i < outs; i++)
+							st->outPtrs[i] = outBufs[i] + pos;
+						int ret = self->processBlock(&st->inPtrs[0], &st->outPtrs[0]);
+						if(ret != 0)
+							return ret;
+					}
+					return 0;
+				}
+
+				//fill the input block, processing it into the output ring whenever it is full
+				for(jack_nframes_t pos = 0; pos < nframes;){
+					unsigned int cnt = std::min(BlockSize - st->inFill, nframes - pos);
+					for(unsigned int i = 0; i < ins; i++)
+						memcpy(st->inPtrs[i] + st->inFill, inBufs[i] + pos, cnt * sizeof(jack_default_audio_sample_t));
+					st->inFill += cnt;
+					pos += cnt;
+					if(st->inFill < BlockSize)
+						continue;
+					st->inFill = 0;
+					int ret = self->processBlock(&st->inPtrs[0], &st->outPtrs[0]);
+					if(ret != 0)
+						return ret;
+					unsigned int w = (st->outRead + st->outFill) % st->ringFrames;
+					unsigned int first = std::min((unsigned int)BlockSize, st->ringFrames - w);
+					for(unsigned int i = 0; i < outs; i++){
+						jack_default_audio_sample_t * ring = &st->ring[i * st->ringFrames];
+						memcpy(ring + w, st->outPtrs[i], first * sizeof(jack_default_audio_sample_t));
+						memcpy(ring, st->outPtrs[i] + first, (BlockSize - first) * sizeof(jack_default_audio_sample_t));
+					}
+					st->outFill += BlockSize;
+				}
+
+				//the latency guarantees a cycle of output is in the ring
+				unsigned int first = std::min((unsigned int)nframes, st->ringFrames - st->outRead);
+				for(unsigned int i = 0; i < outs; i++){
+					const jack_default_audio_sample_t * ring = &st->ring[i * st->ringFrames];
+					memcpy(outBufs[i], ring + st->outRead, first * sizeof(jack_default_audio_sample_t));
+					memcpy(outBufs[i] + first, ring, (nframes - first) * sizeof(jack_default_audio_sample_t));
+				}
+				st->outRead = (st->outRead + nframes) % st->ringFrames;
+				st->outFill -= nframes;
+				return 0;
+			}
+		private:
+			//the blocks and output ring for one buffer size
+			struct block_state_t {
+				jack_nframes_t frames;
+				jack_nframes_t latency;
+				unsigned int ins;
+				unsigned int outs;
+				unsigned int inFill;
+				unsigned int ringFrames;
+				unsigned int outRead;
+				unsigned int outFill;
+				std::vector<jack_default_audio_sample_t> blocks;
+				std::vector<jack_default_audio_sample_t> ring;
+				//the blocks passed to processBlock
+				std::vector<jack_default_audio_sample_t *> inPtrs;
+				std::vector<jack_default_audio_sample_t *> outPtrs;
+			};
+			RTSwap<block_state_t> mBlockState;
+
+			//build the state outside of the callback and report the new latency,
+			//false if too many states were waiting for the callback
+			bool updateBlockState(jack_nframes_t nframes){
+				block_state_t * st = new block_state_t;
+				st->frames = nframes;
+				st->latency = (nframes == 0) ? 0 : blockLatency(nframes);
+				st->ins = inPorts();
+				st->outs = outPorts();
+				st->inFill = 0;
+				st->outRead = 0;
+				//the ring starts out holding the latency as silence
+				st->outFill = st->latency;
+				st->ringFrames = st->latency + nframes + BlockSize;
+				st->inPtrs.resize(std::max(1u, st->ins));
+				st->outPtrs.resize(std::max(1u, st->outs));
+				if(st->latency > 0){
+					st->blocks.assign((st->ins + st->outs) * BlockSize, 0.0f);
+					st->ring.assign(st->outs * st->ringFrames, 0.0f);
+					for(unsigned int i = 0; i < st->ins; i++)
+						st->inPtrs[i] = &st->blocks[i * BlockSize];
+					for(unsigned int i = 0; i < st->outs; i++)
+						st->outPtrs[i] = &st->blocks[(st->ins + i) * BlockSize];
+				}
+				const jack_nframes_t latency = st->latency;
+				if(callbacksLive()){
+					if(!mBlockState.publish(st)){
+						delete st;
+						return false;
+					}
+				} else
+					mBlockState.reset(st);
+				//either not active or inside a jack callback, jack recomputes the latencies itself
+				setProcessingLatency(latency, latency, false);
+				return true;
+			}
+	};
+}
+
+#endif
@@ -21,6 +21,12 @@
 
 #include "jackaudioio.hpp"
 #include "jackringbuffer.hpp"
+#include "jackresampler.hpp"
+#include "jackrtswap.hpp"
+#include "jacknotifier.hpp"
+#include "jacksampleformat.hpp"
+#include "jackseqlock.hpp"
+#include "jackconcealer.hpp"
 
 namespace JackCpp {
 
@@ -55,7 +61,7 @@ audio from a Jack client.
 #else
 					bool startServer = true)
 #endif
-					throw(std::runtime_error);
+					JACKCPP_THROW(std::runtime_error);
 			virtual ~BlockingAudioIO();
 
 			/**
@@ -111,14 +117,210 @@ audio from a Jack client.
 			*/
 			bool tryRead(unsigned int channel, jack_default_audio_sample_t &val);
 
+			/**
+			   @brief Write a block of interleaved frames to all of the outputs
+
+				src holds frames frames of outPorts() samples each, frame f of
+				channel c is src[f * channels + c].  The samples are copied
+				straight into the output buffers.
+
+			  \param src the interleaved samples
+			  \param frames the number of frames in src
+			  \param channels the number of samples per frame, must equal outPorts()
+			  \param block if true, wait until all of the frames are written
+			  \return the number of frames written
+			  \sa write
+			*/
+			unsigned int writeBlock(const jack_default_audio_sample_t * src,
+					unsigned int frames, unsigned int channels, bool block = true)
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			   @brief Read a block of interleaved frames from all of the inputs
+
+				dest is filled like the src of writeBlock, with inPorts()
+				samples per frame.
+
+			  \param dest where to put the interleaved samples
+			  \param frames the number of frames to read
+			  \param channels the number of samples per frame, must equal inPorts()
+			  \param block if true, wait until all of the frames are read
+			  \param captureTime if not NULL, set to the system time in microseconds
+			  that the first frame read was captured at, or 0 if nothing was read.
+			  This allows for the capture latency of input 0 and is only off if
+			  input was dropped since that frame was captured.
+			  \return the number of frames read
+			  \sa read, AudioIO::framesToTime
+			*/
+			unsigned int readBlock(jack_default_audio_sample_t * dest,
+					unsigned int frames, unsigned int channels, bool block = true,
+					jack_time_t * captureTime = NULL)
+				JACKCPP_THROW(std::runtime_error);
+
+			/**
+			   @brief Keep the channels in lockstep
+
+				By default every channel has its own buffer, so channels written
+				or read unevenly drift apart.  In lockstep mode all of the
+				outputs share one buffer of interleaved frames, as do all of the
+				inputs, so a frame is always written or read across every
+				channel at once.  readBlock and writeBlock become straight
+				copies and the callback only checks one buffer per direction.
+
+				write and tryWrite collect a frame and commit it when the last
+				output channel is written, read and tryRead fetch a new frame
+				when channel 0 is read, so the per sample methods must go
+				through the channels in order.  This cannot be called while the
+				client is active.
+
+			  \param enable a boolean indicating whether to keep the channels in lockstep
+			*/
+			void setLockstep(bool enable)
+				JACKCPP_THROW(std::runtime_error);
+			///See if the channels are kept in lockstep
+			bool getLockstep();
+
+			/**
+			   @brief Write a block of interleaved frames in another sample format
+
+				Like the float writeBlock, the samples are converted to floats as
+				they are copied into the output buffers, so they are only
+				touched once.  Integers are scaled so that their full scale is
+				-1 to 1.
+			  \sa writeBlock(const jack_default_audio_sample_t *, unsigned int, unsigned int, bool)
+			*/
+			unsigned int writeBlock(const int16_t * src,
+					unsigned int frames, unsigned int channels, bool block = true)
+				JACKCPP_THROW(std::runtime_error);
+			unsigned int writeBlock(const Int24 * src,
+					unsigned int frames, unsigned int channels, bool block = true)
+				JACKCPP_THROW(std::runtime_error);
+			unsigned int writeBlock(const Int24In32 * src,
+					unsigned int frames, unsigned int channels, bool block = true)
+				JACKCPP_THROW(std::runtime_error);
+			unsigned int writeBlock(const int32_t * src,
+					unsigned int frames, unsigned int channels, bool block = true)
+				JACKCPP_THROW(std::runtime_error);
+			unsigned int writeBlock(const double * src,
+					unsigned int frames, unsigned int channels, bool block = true)
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			   @brief Read a block of interleaved frames in another sample format
+
+				Like the float readBlock, the floats are converted as they are
+				copied out of the input buffers.  Values outside of -1 to 1 are
+				clipped, and int16 and 24 bit samples are dithered if
+				setDither is on.
+			  \sa readBlock(jack_default_audio_sample_t *, unsigned int, unsigned int, bool)
+			*/
+			unsigned int readBlock(int16_t * dest,
+					unsigned int frames, unsigned int channels, bool block = true,
+					jack_time_t * captureTime = NULL)
+				JACKCPP_THROW(std::runtime_error);
+			unsigned int readBlock(Int24 * dest,
+					unsigned int frames, unsigned int channels, bool block = true,
+					jack_time_t * captureTime = NULL)
+				JACKCPP_THROW(std::runtime_error);
+			unsigned int readBlock(Int24In32 * dest,
+					unsigned int frames, unsigned int channels, bool block = true,
+					jack_time_t * captureTime = NULL)
+				JACKCPP_THROW(std::runtime_error);
+			unsigned int readBlock(int32_t * dest,
+					unsigned int frames, unsigned int channels, bool block = true,
+					jack_time_t * captureTime = NULL)
+				JACKCPP_THROW(std::runtime_error);
+			unsigned int readBlock(double * dest,
+					unsigned int frames, unsigned int channels, bool block = true,
+					jack_time_t * captureTime = NULL)
+				JACKCPP_THROW(std::runtime_error);
+			///Add TPDF dither when readBlock narrows to int16 or 24 bit samples, the default is off
+			void setDither(bool enable);
+			///See if readBlock dithers
+			bool getDither();
+
+			///Counts of the times the user buffers couldn't keep up with jack
+			struct xrun_stats_t {
+				///the number of cycles in which the outputs ran out of data
+				unsigned int outputUnderruns;
+				///the number of frames of output that had no data, and were concealed or silent
+				uint64_t outputFramesMissing;
+				///the number of cycles in which input was dropped because the inputs were full
+				unsigned int inputOverruns;
+				///the number of frames of input that were dropped
+				uint64_t inputFramesDropped;
+			};
+			/**
+			   @brief Get the underrun and overrun counts since the client started or resetXrunStats
+
+				The channels are kept aligned, so every channel of a direction
+				has the same frames missing.  Output counts as missing until the
+				first write.
+			*/
+			xrun_stats_t getXrunStats();
+			///Start counting again, only call this from one thread
+			void resetXrunStats();
+			/**
+			   @brief Choose how to fill gaps in the output and around dropped input
+
+				By default the outputs are silent when they run dry and dropped
+				input is simply missing, which clicks.  GapConcealer::fade fades
+				out before a gap and back in after it, GapConcealer::repeat fills
+				the gap with a fading repeat of the audio before it.  Input is
+				faded either side of dropped frames in both modes.  This cannot be
+				called while the client is active.
+
+			  \param mode how to fill gaps
+			  \param rampFrames the length of the fades
+			  \param repeatFrames the length of the stretch that is repeated
+			  \sa GapConcealer
+			*/
+			void setConcealment(GapConcealer::mode_t mode,
+					unsigned int rampFrames = 32, unsigned int repeatFrames = 256)
+				JACKCPP_THROW(std::runtime_error);
+			///Get how gaps are filled
+			GapConcealer::mode_t getConcealment();
+
+			///Get the number of frames that can be read from every input without waiting
+			unsigned int inputFramesAvailable();
+			///Get the number of frames that can be written to every output without waiting
+			unsigned int outputFramesWritable();
+
+			/**
+			   @brief Get a file descriptor that is readable when there is input to read
+
+				The callback signals the descriptor, without blocking, whenever at
+				least the input watermark of frames can be read from every input.
+				Add it to a select, poll or epoll loop, when it becomes readable
+				call clearInputReady and then read with tryRead or a non blocking
+				readBlock.  The callback only signals it after this has been
+				called once.
+			  \sa setInputWatermark, outputReadyFd
+			*/
+			int inputReadyFd();
+			/**
+			   @brief Get a file descriptor that is readable when there is space to write output
+
+				Like inputReadyFd, signalled when at least the output watermark of
+				frames can be written to every output.
+			  \sa setOutputWatermark, inputReadyFd
+			*/
+			int outputReadyFd();
+			///Reset inputReadyFd, until the callback signals it again
+			void clearInputReady();
+			///Reset outputReadyFd, until the callback signals it again
+			void clearOutputReady();
+			///Set the number of input frames that must be available before inputReadyFd is signalled, the default is 1
+			void setInputWatermark(unsigned int frames);
+			///Set the number of output frames that must be writable before outputReadyFd is signalled, the default is 1
+			void setOutputWatermark(unsigned int frames);
+
 			//XXX reserve exists but is basically useless as you cannot
 			//add ports while the client is active
 			///This method is useless at the moment.
 			virtual void reserveOutPorts(unsigned int num)
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 			///This method is useless at the moment.
 			virtual void reserveInPorts(unsigned int num)
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 
 			/**
 			   @brief Add an input port to our client
@@ -130,7 +332,7 @@ audio from a Jack client.
 			  \sa AudioIO::addInPort(std::string name)
 			*/
 			virtual unsigned int addInPort(std::string name)
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
 			/**
 			   @brief Add an output port to our client
 
@@ -141,7 +343,62 @@ audio from a Jack client.
 			  \sa AudioIO::addOutPort(std::string name)
 			*/
 			virtual unsigned int addOutPort(std::string name)
-				throw(std::runtime_error);
+				JACKCPP_THROW(std::runtime_error);
+
+			/**
+			   @brief Set the sample rate that read and write work at
+
+				By default read and write work at the jack server's sample rate.
+				If a different rate is given, a Resampler converts between the
+				user buffers and the jack buffers in the callback.  Passing 0
+				goes back to the server's rate.  This cannot be called while the
+				client is active, as the filter tables are built here.
+
+			  \param rate the sample rate that the user reads and writes at
+			  \param quality the quality preset of the resampling filter
+			  \sa setDriftCompensation(bool)
+			*/
+			void setUserSampleRate(unsigned int rate,
+					Resampler::quality_t quality = Resampler::medium)
+				JACKCPP_THROW(std::runtime_error);
+			///Get the sample rate that read and write work at
+			unsigned int getUserSampleRate();
+
+			/**
+			   @brief Compensate for a user clock that drifts from the jack clock
+
+				When enabled, the resampling ratio is trimmed by a small amount
+				based on how full the user buffers are, keeping them half full
+				when the user produces or consumes audio on an independent clock.
+				This resamples even if the user and server rates are equal.  This
+				cannot be called while the client is active.
+
+			  \param enable a boolean indicating whether to compensate for drift
+			*/
+			void setDriftCompensation(bool enable)
+				JACKCPP_THROW(std::runtime_error);
+			///Get the current drift compensation ratio, 1.0 if there is none
+			double getDriftRatio();
+
+			/**
+			   @brief Adapt to a new jack buffer size
+
+				Recomputes the user buffer latency limits and rebuilds the
+				resamplers for the new period size.  The new resamplers are
+				handed to the callback before its next cycle.
+
+				The latency of the user buffers is reported to jack as our
+				processing latency.  The shortest is a full output buffer, the
+				longest adds a full input buffer.
+			*/
+			virtual int jackBufferSizeCallback(jack_nframes_t nframes);
+			/**
+			   @brief Adapt to a new jack sample rate
+
+				Rebuilds the resamplers for the new server rate.  The user buffers
+				keep the size they were created with.
+			*/
+			virtual int jackSampleRateCallback(jack_nframes_t rate);
 
 		protected:
 			/**
@@ -156,20 +413,146 @@ audio from a Jack client.
 			  \param outBufs a vector of audio buffers
 			  \return the actual number of frames processed
 			*/
-			virtual int audioCallback(jack_nframes_t nframes, 
-					std::vector<jack_default_audio_sample_t *> inBufs,
-					std::vector<jack_default_audio_sample_t *> outBufs);
+			virtual int processAudio(jack_nframes_t nframes,
+					const audioBufVector& inBufs,
+					const audioBufVector& outBufs);
 		private:
+			//everything the callback needs to convert sample rates, this
+			//depends on the buffer size and sample rate so it is swapped
+			//into the callback as a whole when either changes
+			struct resample_state_t {
+				resample_state_t() : out(NULL), in(NULL), inScratchFrames(0) {}
+				~resample_state_t() { delete out; delete in; }
+				Resampler * out;
+				Resampler * in;
+				//scratch for resampled input on its way into the user buffers
+				std::vector<jack_default_audio_sample_t> inScratch;
+				unsigned int inScratchFrames;
+				audioBufVector inScratchBufs;
+				//where user output goes into the output resampler, set every cycle
+				audioBufVector outPushBufs;
+			};
+			//the state of the drift compensation loop of one resampler
+			struct drift_state_t {
+				double error;
+				double integral;
+			};
+
+			//set the amount of the ring buffers that we leave free for a buffer size
+			void updateBufferFreeSizes(jack_nframes_t nframes);
+			//report the latency of the user buffers and resamplers to jack
+			void updateReportedLatency(jack_nframes_t serverRate, const resample_state_t * rs);
+			//create resamplers to match the user rate and drift settings,
+			//NULL if no conversion is needed
+			resample_state_t * createResamplers(jack_nframes_t nframes, jack_nframes_t serverRate);
+			//trim a resampler's ratio so that fill tends toward target
+			void compensateDrift(Resampler * resampler, drift_state_t &state,
+					unsigned int fill, unsigned int target);
+			int resampledCallback(jack_nframes_t nframes, resample_state_t * rs,
+					const audioBufVector &inBufs, const audioBufVector &outBufs);
+			int directCallback(jack_nframes_t nframes,
+					const audioBufVector &inBufs, const audioBufVector &outBufs);
+			//signal the readiness descriptors if their watermarks are met
+			void signalReadiness();
+			//the number of frames the callback can take from the user outputs
+			unsigned int userOutFrames();
+			//the number of frames the callback can give to the user inputs
+			unsigned int userInSpace();
+			//move frames between the user buffers and one buffer per channel
+			void pullUserOut(jack_default_audio_sample_t * const * dest, unsigned int frames);
+			void pushUserIn(jack_default_audio_sample_t * const * src, unsigned int frames);
+			//make the lockstep buffers match the setting and the number of ports
+			void updateLockstepBuffers();
+			//the block reads and writes, converting as they copy
+			template<typename Sample>
+				unsigned int writeConverted(const Sample * src,
+						unsigned int frames, unsigned int channels, bool block)
+				JACKCPP_THROW(std::runtime_error);
+			template<typename Sample>
+				unsigned int readConverted(Sample * dest,
+						unsigned int frames, unsigned int channels, bool block,
+						jack_time_t * captureTime)
+				JACKCPP_THROW(std::runtime_error);
+
 			std::vector<RingBuffer<jack_default_audio_sample_t> *> mUserOutBuff;
 			std::vector<RingBuffer<jack_default_audio_sample_t> *> mUserInBuff;
+			//interleaved frames of every channel, used instead of the above in lockstep mode
+			bool mLockstep;
+			RingBuffer<jack_default_audio_sample_t> * mUserOutFrames;
+			RingBuffer<jack_default_audio_sample_t> * mUserInFrames;
+			//the frame being built by write and the last one fetched by read
+			std::vector<jack_default_audio_sample_t> mOutFrame;
+			std::vector<jack_default_audio_sample_t> mInFrame;
+			//dither for readBlock, only used by the reading thread
+			bool mDither;
+			Dither mDitherNoise;
+
+			//where the newest input frame came from, so reads can be timestamped
+			struct capture_stamp_t {
+				//the number of frames given to the user inputs so far
+				uint64_t frames;
+				//the frame time just after the newest of them
+				jack_nframes_t endFrame;
+			};
+			SeqLock<capture_stamp_t> mCaptureStamp;
+			//only used by the callback
+			uint64_t mUserInPushed;
+			//the number of frames read from the user inputs, only used by the reading thread
+			uint64_t mUserInRead;
+			//record that frames were given to the user inputs, ending at endFrame [realtime]
+			void stampCapture(unsigned int frames, jack_nframes_t endFrame);
+			//the capture time of the oldest frame in the user inputs
+			jack_time_t oldestCaptureTime();
+
+			//xrun counts, only written by the callback, and what they were at resetXrunStats
+			xrun_stats_t mXruns;
+			SeqLock<xrun_stats_t> mXrunsShared;
+			xrun_stats_t mXrunsAtReset;
+			void countXruns(unsigned int outMissing, unsigned int inDropped);
+			//gap concealment, the concealers are NULL when gaps are left silent
+			GapConcealer::mode_t mConcealMode;
+			unsigned int mConcealRampFrames;
+			unsigned int mConcealRepeatFrames;
+			GapConcealer * mOutConceal;
+			GapConcealer * mInConceal;
+			//input was dropped at the end of the last cycle, only used by the callback
+			bool mInGap;
+			void updateConcealers();
+			//push input with fades around frames that are being or were dropped
+			void pushUserInConcealed(jack_default_audio_sample_t * const * src,
+					unsigned int frames, bool dropping);
+			std::vector<jack_default_audio_sample_t *> mInConcealBufs;
 
 			//this is the size of the ring buffers that we alloc
 			const unsigned int mOutputBufferMaxSize;
 			const unsigned int mInputBufferMaxSize;
+			//the sizes the user asked for, the actual sizes depend on the jack buffer size
+			const unsigned int mOutputBufferRequestSize;
+			const unsigned int mInputBufferRequestSize;
 			//this is the amount of free space we leave in the ring buffers
 			//this can decrease so that we'll have more latency but fewer glitches
 			unsigned int mOutputBufferFreeSize;
 			unsigned int mInputBufferFreeSize;
+
+			//sample rate conversion, NULL when the user works at the server rate
+			unsigned int mUserSampleRate;
+			Resampler::quality_t mResampleQuality;
+			bool mDriftCompensation;
+			RTSwap<resample_state_t> mResampleState;
+			//the callback's drift ratio, for getDriftRatio, the resamplers
+			//themselves may be deleted by a publish while another thread reads
+			SeqLock<double> mDriftRatio;
+			drift_state_t mOutDrift;
+			drift_state_t mInDrift;
+
+			//readiness descriptors for event loops
+			Notifier mInputReady;
+			Notifier mOutputReady;
+			volatile unsigned int mInputWatermark;
+			volatile unsigned int mOutputWatermark;
+			//the callback only signals descriptors that someone has asked for
+			volatile bool mInputReadyPolled;
+			volatile bool mOutputReadyPolled;
 	};
 }
 #endif
@@ -0,0 +1,138 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_BUS_HPP
+#define JACK_BUS_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+#include <stddef.h>
+#include <vector>
+#include <stdexcept>
+#include "jackcompat.hpp"
+
+namespace JackCpp {
+
+/**
+@class AudioBus
+
+@brief A group of channels processed together, optionally in one dense block.
+
+Jack hands out every port buffer separately, wherever the server put it, so
+a callback that works across many channels at once, like a matrix mix,
+touches a page or more per channel.  A contiguous bus copies its input ports
+into one planar block aligned to alignment bytes, with each channel padded
+to a multiple of the alignment, and copies its block back out to its output
+ports after processing.  Every channel then starts on a cache line and the
+channels sit next to each other in memory.
+
+A bus that isn't contiguous just points at the port buffers, so code can be
+written against buses and the copy turned on only where it pays.
+
+AudioIO builds the buses set up with addInBus and addOutBus, see there.
+Everything apart from the constructor can be used in the realtime thread.
+
+@author Alex Norman
+
+*/
+	class AudioBus {
+		public:
+			///The alignment of every channel of a contiguous bus
+			enum {alignment = 64};
+			/**
+			  @brief The Constructor
+			  \param channels the number of channels
+			  \param maxFrames the most frames a cycle can have, usually the jack buffer size
+			  \param contiguous true to gather the channels into one block
+			  */
+			AudioBus(unsigned int channels, jack_nframes_t maxFrames, bool contiguous = true)
+				JACKCPP_THROW(std::runtime_error);
+			///The Destructor
+			~AudioBus();
+
+			/**
+			  @brief Take a cycle of input from port buffers [realtime]
+
+			  A contiguous bus copies them into its block, otherwise the bus
+			  points at them.  If nframes is more than maxFrames the bus points
+			  at them for this cycle whatever its mode.
+			  \param ports one buffer per channel
+			  \param nframes the number of frames in the cycle
+			  */
+			void gather(jack_default_audio_sample_t * const * ports, jack_nframes_t nframes);
+			/**
+			  @brief Set the port buffers that a cycle of output goes to [realtime]
+
+			  Render into channel(i), then call scatter.  Like gather, a bus
+			  that isn't contiguous renders straight into the ports.
+			  \param ports one buffer per channel
+			  \param nframes the number of frames in the cycle
+			  */
+			void bind(jack_default_audio_sample_t * const * ports, jack_nframes_t nframes);
+			///Copy a contiguous bus out to the ports given to bind [realtime]
+			void scatter();
+
+			///Get a channel's samples for this cycle
+			jack_default_audio_sample_t * channel(unsigned int index) const { return mChannels[index]; }
+			///Get every channel's samples for this cycle
+			jack_default_audio_sample_t * const * channels() const { return &mChannels[0]; }
+			///Get the number of channels
+			unsigned int channelCount() const { return mChannels.size(); }
+			///Get the number of frames in this cycle
+			jack_nframes_t frames() const { return mFrames; }
+			///Get the most frames a cycle can have
+			jack_nframes_t maxFrames() const { return mMaxFrames; }
+			///See if the channels are in the bus's block this cycle, rather than the ports
+			bool contiguous() const { return mInBlock; }
+			///Get the distance in samples from one channel to the next in a contiguous bus
+			size_t stride() const { return mStride; }
+			///Get the block of a contiguous bus, NULL otherwise
+			jack_default_audio_sample_t * block() const { return mBlock; }
+		private:
+			//not copyable
+			AudioBus(const AudioBus&);
+			AudioBus& operator=(const AudioBus&);
+
+			std::vector<jack_default_audio_sample_t *> mChannels;
+			std::vector<jack_default_audio_sample_t *> mPorts;
+			jack_default_audio_sample_t * mBlock;
+			size_t mStride;
+			size_t mBytes;
+			bool mLocked;
+			//the channels are in the block this cycle
+			bool mInBlock;
+			jack_nframes_t mMaxFrames;
+			jack_nframes_t mFrames;
+	};
+
+	/**
+	  @brief Mix every input channel into every output channel [realtime]
+
+	  out[o] = sum over i of gains[o * in.channelCount() + i] * in[i], for the
+	  frames of the current cycle.  Inputs with a gain of zero are skipped.
+	  Uses SSE where it is available, with aligned loads when both buses
+	  are contiguous.
+	  \param in the bus to mix from
+	  \param out the bus to mix into, it must not share buffers with in
+	  \param gains out.channelCount() rows of in.channelCount() gains
+	  */
+	void mixMatrix(const AudioBus& in, AudioBus& out, const float * gains);
+}
+
+#endif
@@ -0,0 +1,118 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_CLOCK_HPP
+#define JACK_CLOCK_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+#include "jackseqlock.hpp"
+
+namespace JackCpp {
+
+/**
+@struct CycleTimes
+
+@brief The timing of a process cycle, as jack_get_cycle_times reports it.
+
+@author Alex Norman
+
+*/
+	struct CycleTimes {
+		///the frame time of the first frame of the cycle
+		jack_nframes_t frames;
+		///the system time, in microseconds, that the cycle's first frame was due
+		jack_time_t usecs;
+		///the system time that the next cycle is due
+		jack_time_t nextUsecs;
+		///jack's estimate of the length of a cycle, in microseconds
+		float periodUsecs;
+	};
+
+/**
+@class FrameClock
+
+@brief Maps frame times to system times and back with a delay-locked loop.
+
+The realtime thread feeds it the times of every cycle.  A second order DLL
+filters out the jitter of the cycle start times and follows the real rate
+of the audio interface's clock, which is never quite its nominal sample
+rate.  The estimate is published through a SeqLock, so any thread can
+convert between frames and microseconds for the cost of a few multiplies.
+
+A gap in the frame times, from an xrun, freewheeling or a buffer size
+change, restarts the loop.
+
+@author Alex Norman
+
+*/
+	class FrameClock {
+		public:
+			/**
+			  @brief The Constructor
+			  \param bandwidth the bandwidth of the loop in Hz, lower is smoother but slower to follow
+			  */
+			FrameClock(double bandwidth = 0.5);
+			///Set the bandwidth of the loop in Hz, from any thread
+			void setBandwidth(double bandwidth){ mBandwidth = bandwidth; }
+			///Get the bandwidth of the loop in Hz
+			double getBandwidth() const { return mBandwidth; }
+
+			/**
+			  @brief Feed the loop a cycle's times [realtime]
+
+			  \param times the cycle's times
+			  \param nframes the number of frames in the cycle
+			  \param sampleRate the nominal sample rate
+			  */
+			void update(const CycleTimes& times, jack_nframes_t nframes, jack_nframes_t sampleRate);
+			///Restart the loop at the next update [realtime]
+			void restart(){ mRunning = false; }
+
+			///See if the loop has had a cycle to work from
+			bool valid() const { return mShared.read().valid; }
+			///Get the system time, in microseconds, of a frame time
+			jack_time_t framesToTime(jack_nframes_t frames) const;
+			///Get the frame time of a system time in microseconds
+			jack_nframes_t timeToFrames(jack_time_t usecs) const;
+			///Get the estimated real sample rate of the audio interface
+			double sampleRate() const;
+			///Get the times of the last cycle
+			CycleTimes cycleTimes() const { return mShared.read().times; }
+		private:
+			struct estimate_t {
+				bool valid;
+				//the filtered time of a frame and the time a frame lasts
+				jack_nframes_t frame;
+				double usecs;
+				double usecsPerFrame;
+				CycleTimes times;
+			};
+			SeqLock<estimate_t> mShared;
+			volatile double mBandwidth;
+			//the loop, only used by update
+			bool mRunning;
+			jack_nframes_t mNextFrame;
+			double mT0;
+			double mT1;
+			double mE2;
+	};
+}
+
+#endif
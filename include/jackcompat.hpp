@@ -0,0 +1,31 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_COMPAT_HPP
+#define JACK_COMPAT_HPP
+
+//Dynamic exception specifications were removed in C++17, this keeps them
+//for older standards, where they document what we throw, and drops them
+//for newer ones so that the headers can be used from C++17 and C++20 code.
+#if __cplusplus >= 201703L
+#define JACKCPP_THROW(...)
+#else
+#define JACKCPP_THROW(...) throw(__VA_ARGS__)
+#endif
+
+#endif
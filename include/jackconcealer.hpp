@@ -0,0 +1,124 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_CONCEALER_HPP
+#define JACK_CONCEALER_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+#include <vector>
+
+namespace JackCpp {
+
+/**
+@class GapConcealer
+
+@brief Hides the gaps left when a stream runs dry or loses frames.
+
+Cutting from audio straight to silence, or from silence straight back to
+audio, clicks.  For output, fillGap fills the part of a cycle that had no
+data and fades the data back in when it returns.  In fade mode the audio
+before the gap is faded out over a short ramp.  In repeat mode the last
+stretch before the gap is played again, crossfaded in and fading out, so
+a short gap sounds like a stutter instead of a dropout.
+
+For input, rampInput fades the frames either side of frames that had to
+be dropped.
+
+Everything works in place or in fixed scratch space, so it can be used
+in the realtime thread.  The work is only done around gaps apart from
+remembering the end of each cycle for repeat mode.
+
+@author Alex Norman
+
+*/
+	class GapConcealer {
+		public:
+			///How to fill gaps
+			enum mode_t {silence, fade, repeat};
+			/**
+			  @brief The Constructor
+			  \param channels the number of channels
+			  \param mode how to fill gaps
+			  \param rampFrames the length of the fades
+			  \param repeatFrames the length of the stretch that repeat mode plays again
+			  */
+			GapConcealer(unsigned int channels, mode_t mode,
+					unsigned int rampFrames = 32, unsigned int repeatFrames = 256);
+			///Get the mode
+			mode_t mode() const { return mMode; }
+
+			/**
+			  @brief Conceal a gap at the end of a cycle of output [realtime]
+
+			  Call this every cycle, the first valid frames of every buffer are
+			  real data and the rest is filled in.
+			  \param bufs one buffer per channel
+			  \param valid the number of frames of real data
+			  \param nframes the number of frames in each buffer
+			  */
+			void fillGap(jack_default_audio_sample_t * const * bufs,
+					unsigned int valid, unsigned int nframes);
+
+			/**
+			  @brief Fade input in after a gap and out before one [realtime]
+
+			  Frames start to start + cnt of a block of total frames are copied
+			  into scratch space with the fades applied.  Call it for the
+			  frames within rampFrames of either end of the block, cnt can be
+			  at most rampFrames.
+			  \param src one buffer per channel holding the block
+			  \param start the first frame to copy
+			  \param cnt the number of frames to copy
+			  \param total the number of frames in the block
+			  \param fadeIn true if frames were lost before the block
+			  \param fadeOut true if frames were lost after the block
+			  \return one buffer per channel holding the faded frames
+			  */
+			jack_default_audio_sample_t * const * rampInput(jack_default_audio_sample_t * const * src,
+					unsigned int start, unsigned int cnt, unsigned int total,
+					bool fadeIn, bool fadeOut);
+			///Get the length of the fades
+			unsigned int rampFrames() const { return mRampFrames; }
+		private:
+			//remember the end of the cycle, for when a gap starts at the top of the next one
+			void remember(jack_default_audio_sample_t * const * bufs, unsigned int nframes);
+			//fill frames from to nframes of the gap, pos frames into it
+			void conceal(jack_default_audio_sample_t * const * bufs, unsigned int from, unsigned int nframes);
+
+			unsigned int mChannels;
+			mode_t mMode;
+			unsigned int mRampFrames;
+			unsigned int mRepeatFrames;
+			//the gain of each frame of a fade in, a fade out is the same backwards
+			std::vector<jack_default_audio_sample_t> mRamp;
+			//the last mRepeatFrames of every channel, and the stretch being repeated
+			std::vector<jack_default_audio_sample_t> mHistory;
+			std::vector<jack_default_audio_sample_t> mSegment;
+			//the last sample before the gap, which a gap fades down from
+			std::vector<jack_default_audio_sample_t> mHold;
+			bool mInGap;
+			unsigned int mGapPos;
+			//for rampInput
+			std::vector<jack_default_audio_sample_t> mScratch;
+			std::vector<jack_default_audio_sample_t *> mScratchBufs;
+	};
+}
+
+#endif
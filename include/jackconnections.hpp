@@ -0,0 +1,177 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_CONNECTIONS_HPP
+#define JACK_CONNECTIONS_HPP
+
+extern "C" {
+#include <jack/jack.h>
+#include <jack/types.h>
+}
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "jackcompat.hpp"
+#include "jackportregistry.hpp"
+
+namespace JackCpp {
+
+/**
+@class ConnectionSet
+
+@brief A set of connections between jack ports.
+
+Each rule names a source port and a destination port, either exactly or with
+glob or regular expression patterns.  When a rule's patterns match several
+ports, a pattern that matches a single port is connected to every match of
+the other one, otherwise the matches are paired up in order, so
+"system:capture_*" -> "me:in_*" connects capture_1 to in_1, capture_2 to
+in_2 and so on.
+
+Sets can be written to and read from a stream, one rule per line, which is
+how AudioIO::getConnections results are saved and restored.
+
+@author Alex Norman
+
+*/
+	class ConnectionSet {
+		public:
+			///How a rule's names are matched against port names
+			enum match_t {exact, glob, regex};
+			///A connection from a source (output) port to a destination (input) port
+			struct connection_t {
+				std::string source;
+				std::string destination;
+			};
+
+			///Add a rule
+			void add(std::string source, std::string destination, match_t match = exact);
+			///Remove all the rules
+			void clear();
+			///Get the number of rules
+			unsigned int size() const { return mRules.size(); }
+
+			/**
+			  @brief Turn the rules into concrete connections
+
+			  Patterns are matched against the ports in registry.
+			  \throw std::runtime_error if a regular expression is invalid
+			  */
+			std::vector<connection_t> expand(PortRegistry& registry) const
+				JACKCPP_THROW(std::runtime_error);
+
+			///Write the rules to a stream, one per line
+			void write(std::ostream& out) const;
+			///Add the rules read from a stream, as written by write
+			void read(std::istream& in)
+				JACKCPP_THROW(std::runtime_error);
+		private:
+			struct rule_t {
+				std::string source;
+				std::string destination;
+				match_t match;
+			};
+			std::vector<rule_t> mRules;
+	};
+
+/**
+@class ConnectionJob
+
+@brief Applies a ConnectionSet on a background thread.
+
+Created by AudioIO::applyConnections.  The job compares the set with the
+connections that already exist and only makes the connects and disconnects
+that are needed.  A job is a simple future: wait blocks until it is done,
+after which results describes what happened to every connection.  An
+optional callback is called from the background thread when the job
+finishes, and may delete the job.
+
+A job must be deleted before the AudioIO that created it, deleting a job
+waits for it to finish.
+
+@author Alex Norman
+
+*/
+	class ConnectionJob {
+		public:
+			///What happened to a connection
+			enum status_t {connected, disconnected, alreadyConnected, failed};
+			///The outcome for one connection
+			struct result_t {
+				std::string source;
+				std::string destination;
+				status_t status;
+				///the return value of jack_connect or jack_disconnect when status is failed
+				int error;
+			};
+			///The type of the function called when a job finishes
+			typedef void (*callback_t)(ConnectionJob * job, void * arg);
+
+			/**
+			  @brief Start a job, use AudioIO::applyConnections rather than calling this directly
+			  \param client the jack client to make connections with
+			  \param registry the registry to expand patterns with
+			  \param set the connections that we want
+			  \param ownPorts the full names of our client's ports, used to disconnect when exclusive
+			  \param exclusive if true, connections to ownPorts that are not in set are removed
+			  \param callback called from the background thread when the job is done, may be NULL
+			  \param arg passed to callback
+			  */
+			ConnectionJob(jack_client_t * client, PortRegistry& registry,
+					const ConnectionSet& set, const std::vector<std::string>& ownPorts,
+					bool exclusive, callback_t callback = NULL, void * arg = NULL)
+				JACKCPP_THROW(std::runtime_error);
+			///The Destructor, waits for the job to finish
+			~ConnectionJob();
+
+			///Block until the job is finished
+			void wait();
+			///See if the job is finished without blocking
+			bool done() const;
+			///Get the outcome of every connection, only valid once the job is done
+			const std::vector<result_t>& results() const { return mResults; }
+			///Get the number of connections that failed, only valid once the job is done
+			unsigned int failures() const;
+			///Get the error message if expanding the set failed, empty otherwise, nothing is connected or disconnected when it did
+			const std::string& error() const { return mError; }
+		private:
+			static void * run(void * arg);
+			void apply();
+			//mark the job done and call the callback
+			void finish();
+
+			jack_client_t * mClient;
+			PortRegistry& mRegistry;
+			ConnectionSet mSet;
+			std::vector<std::string> mOwnPorts;
+			bool mExclusive;
+			callback_t mCallback;
+			void * mCallbackArg;
+
+			pthread_t mThread;
+			bool mJoined;
+			volatile bool mDone;
+			std::vector<result_t> mResults;
+			std::string mError;
+	};
+}
+
+#endif
+
@@ -0,0 +1,295 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_CONVOLVER_HPP
+#define JACK_CONVOLVER_HPP
+
+#include "jackaudioio.hpp"
+#include "jackfft.hpp"
+#include "jacknotifier.hpp"
+#include "jackthreadconfig.hpp"
+#include <pthread.h>
+
+namespace JackCpp {
+
+/**
+@class Convolver
+
+@brief Convolves many channels with long impulse responses in the jack callback.
+
+Each impulse response is split into partitions that grow along it, and
+convolved with partitioned overlap-save.  The head, the first partitions,
+has the block size of the callback and is computed in process, so the
+output has no latency beyond the jack buffer.  The rest is split into
+levels of partitions four times larger than the level before, up to
+maxBlockSize, that background threads compute while the head plays.  A
+level's partitions start twice their size into the impulse, so the threads
+have a whole block of that level to finish each one, and the threads always
+work on the smallest level that has work first.  The spectra of each
+impulse are computed once and shared by every channel that uses it, and
+the spectra are multiplied with SSE where it is available.
+
+Add the impulses and the channels, then call process from the callback.
+If the threads don't finish a block in time the block is left out and
+counted by lateBlocks, unless process is told to wait for it, which is for
+freewheeling.
+
+@author Alex Norman
+
+*/
+	class Convolver {
+		public:
+			/**
+			  @brief The Constructor
+			  \param blockSize the block size of the head, usually the jack buffer size, a power of two
+			  \param maxBlockSize the largest partition, a power of two, 0 for 64 times blockSize,
+			  blockSize to compute everything in the callback
+			  \param threads the number of background threads that compute the larger partitions
+			  \param workerConfig how to set up the background threads
+			  */
+			Convolver(unsigned int blockSize, unsigned int maxBlockSize = 0, unsigned int threads = 1,
+					const ThreadConfig& workerConfig = ThreadConfig())
+				JACKCPP_THROW(std::runtime_error);
+			///The Destructor, stops the background threads
+			~Convolver();
+
+			/**
+			  @brief Add an impulse response, before processing starts
+			  \param ir the samples of the impulse response
+			  \param length the number of samples
+			  \return the index of the impulse
+			  */
+			unsigned int addImpulse(const float * ir, unsigned int length)
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			  @brief Add a channel that convolves with an impulse, before processing starts
+			  \param impulse the index of the impulse, from addImpulse
+			  \return the index of the channel, its input and output in process
+			  */
+			unsigned int addChannel(unsigned int impulse)
+				JACKCPP_THROW(std::range_error, std::runtime_error);
+
+			/**
+			  @brief Convolve a cycle of every channel [realtime]
+
+			  in and out may be the same buffers.
+			  \param in one input buffer per channel
+			  \param out one output buffer per channel
+			  \param nframes the number of frames, a multiple of blockSize
+			  \param waitForTail wait for the background threads instead of leaving out late blocks
+			  \return false, with silent outputs, if nframes isn't a multiple of blockSize
+			  */
+			bool process(const float * const * in, float * const * out, unsigned int nframes,
+					bool waitForTail = false);
+
+			///Get the block size of the head
+			unsigned int blockSize() const { return mBlockSize; }
+			///Get the number of partition sizes, including the head
+			unsigned int levels() const { return mLevels.size() + 1; }
+			///Get the number of channels
+			unsigned int channels() const { return mChannels.size(); }
+			///Get the number of blocks that were left out because the threads were late
+			unsigned int lateBlocks() const { return mLateBlocks; }
+			//the spectra of a part of an impulse, each partition padded to a multiple of 4 bins
+			struct spectra_t {
+				unsigned int parts;
+				std::vector<float> re;
+				std::vector<float> im;
+			};
+		private:
+			//not copyable
+			Convolver(const Convolver&);
+			Convolver& operator=(const Convolver&);
+
+			//the head and then the spectra of every level
+			struct impulse_t {
+				spectra_t head;
+				std::vector<spectra_t> levels;
+			};
+			//a channel's frequency domain delay line for a part of its impulse
+			struct delay_line_t {
+				std::vector<float> re;
+				std::vector<float> im;
+				unsigned int pos;
+			};
+			//a channel's state for a level, the input and output have two slots
+			//so the callback and a thread can use one each
+			struct channel_level_t {
+				std::vector<float> in[2];
+				std::vector<float> out[2];
+				//only used by the threads
+				std::vector<float> prev;
+				delay_line_t line;
+				unsigned int lastBlock;
+				bool started;
+			};
+			struct channel_t {
+				const impulse_t * impulse;
+				std::vector<float> headIn;
+				delay_line_t head;
+				std::vector<channel_level_t> levels;
+			};
+			//a partition size computed by the threads
+			struct level_t {
+				unsigned int size;
+				unsigned int bins;
+				//the part of the impulse this level covers, the last level goes to the end
+				unsigned int start;
+				unsigned int end;
+				//only used by the callback
+				unsigned int fill;
+				unsigned int fillSlot;
+				unsigned int blocks;
+				unsigned int issuedBlock;
+				unsigned int issuedSlot;
+				unsigned int playSlot;
+				bool valid;
+				//the threads take channels from the ticket, which holds the block, the slot and the next channel
+				volatile unsigned int ticket;
+				volatile unsigned int jobsDone;
+				volatile unsigned int jobChannels;
+			};
+			struct worker_t {
+				Convolver * convolver;
+				pthread_t thread;
+				Notifier wake;
+				//a transform for every level, and room for the largest
+				std::vector<RealFFT *> ffts;
+				std::vector<float> time;
+				std::vector<float> accRe;
+				std::vector<float> accIm;
+				~worker_t();
+			};
+			static void * runWorker(void * arg);
+			void stopWorkers();
+			void work(worker_t * w);
+			//take a channel from a level, returns false if there are none left
+			bool takeJob(worker_t * w, unsigned int level);
+			void processLevel(worker_t * w, unsigned int level, channel_t * ch,
+					unsigned int block, unsigned int slot);
+			//the boundary between two blocks of a level, collect the last one and start the next
+			void startBlock(level_t& level, bool waitForTail);
+			//sum a delay line times an impulse's spectra
+			static void accumulate(const delay_line_t& line, const spectra_t& spectra,
+					unsigned int bins, float * accRe, float * accIm);
+
+			unsigned int mBlockSize;
+			unsigned int mHeadBins;
+			unsigned int mHeadParts;
+			unsigned int mHeadEnd;
+			std::vector<level_t> mLevels;
+			std::vector<impulse_t *> mImpulses;
+			std::vector<channel_t *> mChannels;
+			bool mStarted;
+
+			//only used by the callback
+			RealFFT mHeadFFT;
+			std::vector<float> mTime;
+			std::vector<float> mAccRe;
+			std::vector<float> mAccIm;
+			volatile unsigned int mLateBlocks;
+
+			Notifier mDone;
+			std::vector<worker_t *> mWorkers;
+			ThreadConfig mWorkerConfig;
+			volatile bool mRunning;
+	};
+
+/**
+@class ConvolverAudioIO
+
+@brief An AudioIO that convolves each input port into its output port.
+
+The impulses are kept so that the Convolver can be rebuilt outside of the
+callback when the buffer size changes, or when update is called after the
+impulses change, and swapped in with an RTSwap.  A rebuilt Convolver
+starts with empty delay lines.  While freewheeling the callback waits for
+the background threads, so a render has every block.
+
+@author Alex Norman
+
+*/
+	class ConvolverAudioIO : public AudioIO {
+		public:
+			/**
+			  @brief The Constructor
+			  \param name string indicating the name of the jack client to create
+			  \param channels the number of input and output ports
+			  \param threads the number of threads computing the larger partitions
+			  \param maxFactor the largest partition in head blocks, a power of two
+			  \param startServer a boolean indicating whether to start a jack server if one isn't already running
+			  */
+			ConvolverAudioIO(std::string name, unsigned int channels, unsigned int threads = 1,
+					unsigned int maxFactor = 64,
+#ifdef __APPLE__
+					bool startServer = false)
+#else
+					bool startServer = true)
+#endif
+				JACKCPP_THROW(std::runtime_error);
+			///The Destructor, stops the client before the Convolver goes away
+			virtual ~ConvolverAudioIO();
+			/**
+			  @brief Add an impulse response, call update to use it
+			  \param ir the samples
+			  \return the index of the impulse
+			  */
+			unsigned int addImpulse(const std::vector<float>& ir);
+			/**
+			  @brief Choose the impulse a channel convolves with, call update to use it
+
+			  Channels without an impulse are silent.
+			  \param channel the port
+			  \param impulse the index of the impulse, from addImpulse
+			  */
+			void setChannelImpulse(unsigned int channel, unsigned int impulse)
+				JACKCPP_THROW(std::range_error);
+			///Build a Convolver with the current impulses and swap it into the callback
+			void update() JACKCPP_THROW(std::runtime_error);
+			///Get the number of blocks that were late in the current Convolver
+			unsigned int lateBlocks();
+
+			///Not supported, the ports are fixed
+			virtual unsigned int addInPort(std::string name)
+				JACKCPP_THROW(std::runtime_error);
+			///Not supported, the ports are fixed
+			virtual unsigned int addOutPort(std::string name)
+				JACKCPP_THROW(std::runtime_error);
+			///Rebuilds the Convolver for the new buffer size
+			virtual int jackBufferSizeCallback(jack_nframes_t nframes);
+		protected:
+			virtual int processAudio(jack_nframes_t nframes,
+					const audioBufVector& inBufs,
+					const audioBufVector& outBufs);
+		private:
+			Convolver * createConvolver(jack_nframes_t nframes)
+				JACKCPP_THROW(std::runtime_error);
+
+			unsigned int mThreads;
+			unsigned int mMaxFactor;
+			std::vector<std::vector<float> > mImpulses;
+			//the impulse of each channel, or -1
+			std::vector<int> mChannelImpulse;
+			RTSwap<Convolver> mConvolver;
+			//only for reading lateBlocks, the callback's may not be adopted yet
+			Convolver * volatile mNewest;
+			pthread_mutex_t mUpdateLock;
+	};
+}
+
+#endif
@@ -0,0 +1,143 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_COROUTINE_HPP
+#define JACK_COROUTINE_HPP
+
+#if __cplusplus < 202002L
+#error "jackcoroutine.hpp needs C++20, compile with -std=c++20"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include "jackstreamreactor.hpp"
+
+namespace JackCpp {
+
+/**
+@class FramesAwaiter
+
+@brief The result of AsyncStream::readFrames and AsyncStream::writeFrames.
+
+co_await on it queues the operation with the StreamReactor and suspends
+the coroutine, which is resumed from the reactor's executor once all of the
+frames have been moved.  The co_await evaluates to the number of frames
+moved, fewer than asked for only if the operation was cancelled.
+
+@author Alex Norman
+
+*/
+	class FramesAwaiter {
+		public:
+			FramesAwaiter(StreamReactor& reactor, BlockingAudioIO& io,
+					jack_default_audio_sample_t * dest, const jack_default_audio_sample_t * src,
+					unsigned int frames) :
+				mReactor(reactor), mIO(io), mDest(dest), mSrc(src), mFrames(frames), mDone(0) {}
+
+			bool await_ready() const noexcept { return mFrames == 0; }
+			void await_suspend(std::coroutine_handle<> handle){
+				mHandle = handle;
+				if(mSrc != nullptr)
+					mReactor.writeFrames(mIO, mSrc, mFrames, FramesAwaiter::resume, this);
+				else
+					mReactor.readFrames(mIO, mDest, mFrames, FramesAwaiter::resume, this);
+			}
+			unsigned int await_resume() const noexcept { return mDone; }
+		private:
+			static void resume(void * arg, unsigned int frames){
+				FramesAwaiter * self = static_cast<FramesAwaiter *>(arg);
+				self->mDone = frames;
+				self->mHandle.resume();
+			}
+
+			StreamReactor& mReactor;
+			BlockingAudioIO& mIO;
+			jack_default_audio_sample_t * mDest;
+			const jack_default_audio_sample_t * mSrc;
+			unsigned int mFrames;
+			unsigned int mDone;
+			std::coroutine_handle<> mHandle;
+	};
+
+/**
+@class AsyncStream
+
+@brief Awaitable reads and writes on a BlockingAudioIO.
+
+Pairs a stream with the StreamReactor that services it:
+
+@code
+JackCpp::DetachedTask passthrough(JackCpp::AsyncStream& s, std::vector<float>& buf){
+	while(true){
+		co_await s.readFrames(buf.data(), 256);
+		co_await s.writeFrames(buf.data(), 256);
+	}
+}
+@endcode
+
+Buffers are interleaved, as for BlockingAudioIO::readBlock and writeBlock.
+
+@author Alex Norman
+
+*/
+	class AsyncStream {
+		public:
+			AsyncStream(StreamReactor& reactor, BlockingAudioIO& io) :
+				mReactor(reactor), mIO(io) {}
+
+			///Read frames interleaved frames from every input
+			FramesAwaiter readFrames(jack_default_audio_sample_t * dest, unsigned int frames){
+				return FramesAwaiter(mReactor, mIO, dest, nullptr, frames);
+			}
+			///Write frames interleaved frames to every output
+			FramesAwaiter writeFrames(const jack_default_audio_sample_t * src, unsigned int frames){
+				return FramesAwaiter(mReactor, mIO, nullptr, src, frames);
+			}
+			///Complete this stream's pending operations as cancelled
+			void cancel(){ mReactor.cancel(mIO); }
+
+			BlockingAudioIO& io(){ return mIO; }
+			StreamReactor& reactor(){ return mReactor; }
+		private:
+			StreamReactor& mReactor;
+			BlockingAudioIO& mIO;
+	};
+
+/**
+@struct DetachedTask
+
+@brief The simplest coroutine type to drive an AsyncStream with.
+
+The coroutine starts running when it is called and frees itself when it
+returns.  An exception that escapes it terminates the program.
+
+@author Alex Norman
+
+*/
+	struct DetachedTask {
+		struct promise_type {
+			DetachedTask get_return_object() noexcept { return DetachedTask(); }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept { std::terminate(); }
+		};
+	};
+}
+
+#endif
@@ -0,0 +1,87 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_FFT_HPP
+#define JACK_FFT_HPP
+
+#include <vector>
+#include <stdexcept>
+#include "jackcompat.hpp"
+
+namespace JackCpp {
+
+/**
+@class RealFFT
+
+@brief A fast Fourier transform of real signals with a power of two length.
+
+The spectrum is kept as separate real and imaginary arrays of bins() values,
+from DC to Nyquist, which is the layout the Convolver multiplies with SIMD.
+The transform is done as a complex transform of half the length.  Nothing
+is allocated after construction, but the work space is shared, so an object
+should only be used by one thread at a time.
+
+@author Alex Norman
+
+*/
+	class RealFFT {
+		public:
+			/**
+			  @brief The Constructor
+			  \param size the length of the transform, a power of two of at least 4
+			  */
+			RealFFT(unsigned int size) JACKCPP_THROW(std::runtime_error);
+			///Get the length of the transform
+			unsigned int size() const { return mSize; }
+			///Get the number of bins in a spectrum, size() / 2 + 1
+			unsigned int bins() const { return mHalf + 1; }
+			/**
+			  @brief Transform size() samples into bins() bins [realtime]
+			  \param in the samples
+			  \param re the real part of the spectrum
+			  \param im the imaginary part of the spectrum
+			  */
+			void forward(const float * in, float * re, float * im);
+			/**
+			  @brief Transform bins() bins back into size() samples [realtime]
+
+			  The output is scaled by size() / 2, so a forward and an inverse
+			  transform multiply the signal by size() / 2.
+			  \param re the real part of the spectrum
+			  \param im the imaginary part of the spectrum
+			  \param out the samples
+			  */
+			void inverse(const float * re, const float * im, float * out);
+		private:
+			//the complex transform of mHalf points in mWorkRe and mWorkIm, in place
+			void transform(bool inverse);
+
+			unsigned int mSize;
+			unsigned int mHalf;
+			std::vector<unsigned int> mBitReverse;
+			//the twiddles of each stage of the complex transform, and of splitting it into a real one
+			std::vector<float> mStageCos;
+			std::vector<float> mStageSin;
+			std::vector<float> mSplitCos;
+			std::vector<float> mSplitSin;
+			std::vector<float> mWorkRe;
+			std::vector<float> mWorkIm;
+	};
+}
+
+#endif
@@ -0,0 +1,162 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_FILE_SINK_HPP
+#define JACK_FILE_SINK_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "jackcompat.hpp"
+#include "jackringbuffer.hpp"
+#include "jacknotifier.hpp"
+#include "jacksampleformat.hpp"
+
+namespace JackCpp {
+
+/**
+@class RenderSink
+
+@brief Somewhere for AudioIO to send its outputs while it renders.
+
+AudioIO::startRender hands every cycle of output to the sink.  When jack is
+running in realtime the sink must not block, it drops what it can't take.
+When jack is freewheeling there is no deadline, so the sink may wait until
+it has room, which holds the whole jack graph back to the speed the sink
+can keep up with.
+
+@author Alex Norman
+
+*/
+	class RenderSink {
+		public:
+			virtual ~RenderSink() {}
+			/**
+			  @brief Take a cycle of output [realtime unless mayBlock]
+
+			  \param bufs one buffer of nframes samples per channel
+			  \param channels the number of buffers
+			  \param nframes the number of frames in each buffer
+			  \param mayBlock true when freewheeling, the sink may wait for room
+			  \return true if the frames were taken, false if they were dropped
+			  */
+			virtual bool renderFrames(jack_default_audio_sample_t * const * bufs,
+					unsigned int channels, jack_nframes_t nframes, bool mayBlock) = 0;
+	};
+
+/**
+@class WavFileSink
+
+@brief A RenderSink that writes a WAV file from a background thread.
+
+The callback interleaves its outputs into a lock-free ring buffer and a
+writer thread converts them to the file's sample format and writes them.
+While freewheeling renderFrames waits for the writer when the ring is
+full, so the render runs as fast as the disk allows and nothing is lost.
+In realtime it drops the cycle instead and counts it.
+
+The header is written with zero lengths and filled in by close.  Samples
+are written in the host's byte order, WAV files are little endian.
+
+@author Alex Norman
+
+*/
+	class WavFileSink : public RenderSink {
+		public:
+			///The sample format of the file
+			enum format_t {int16, int24, int32, float32};
+			/**
+			  @brief The Constructor
+
+			  Creates the file and starts the writer thread.
+
+			  \param path the file to write, it is replaced if it exists
+			  \param channels the number of channels in the file
+			  \param sampleRate the sample rate to put in the header
+			  \param format the sample format of the file
+			  \param bufferFrames the number of frames the ring buffer holds
+			  */
+			WavFileSink(std::string path, unsigned int channels, jack_nframes_t sampleRate,
+					format_t format = int24, unsigned int bufferFrames = 65536)
+				JACKCPP_THROW(std::runtime_error);
+			///The Destructor, closes the file if close hasn't been called
+			virtual ~WavFileSink();
+			/**
+			  @brief Write out what is buffered, fill in the header and close the file
+
+			  Stop rendering into the sink first.
+			  \return false if a write failed
+			  */
+			bool close();
+
+			/**
+			  @brief Take a cycle of output [realtime unless mayBlock]
+
+			  Channels beyond the file's are ignored, missing ones are written
+			  as silence.  Int16 and int24 files are dithered.
+			  */
+			virtual bool renderFrames(jack_default_audio_sample_t * const * bufs,
+					unsigned int channels, jack_nframes_t nframes, bool mayBlock);
+
+			///Get the number of frames written to the file so far
+			uint64_t framesWritten() const { return mFramesWritten; }
+			///Get the number of frames that were dropped because the ring buffer was full
+			uint64_t framesDropped() const { return mFramesDropped; }
+			///Get the number of times renderFrames waited for the writer
+			unsigned int waits() const { return mWaits; }
+			///Check to see if a write to the file failed
+			bool failed() const { return mFailed; }
+		private:
+			//not copyable
+			WavFileSink(const WavFileSink&);
+			WavFileSink& operator=(const WavFileSink&);
+			static void * writerThread(void * arg);
+			void writeLoop();
+			//write the samples waiting in the ring buffer, returns the number of frames
+			unsigned int drain();
+			bool writeHeader(uint32_t dataBytes);
+
+			FILE * mFile;
+			unsigned int mChannels;
+			jack_nframes_t mSampleRate;
+			format_t mFormat;
+			unsigned int mSampleBytes;
+			RingBuffer<jack_default_audio_sample_t> mRing;
+			Notifier mDataReady;
+			Notifier mSpaceReady;
+			pthread_t mThread;
+			volatile bool mStop;
+			bool mOpen;
+			//only used by the writer thread
+			std::vector<jack_default_audio_sample_t> mScratch;
+			std::vector<unsigned char> mBytes;
+			Dither mDither;
+			volatile uint64_t mFramesWritten;
+			volatile uint64_t mFramesDropped;
+			volatile unsigned int mWaits;
+			volatile bool mFailed;
+	};
+}
+
+#endif
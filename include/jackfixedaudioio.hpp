@@ -0,0 +1,161 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef JACK_FIXED_AUDIO_IO_HPP
+#define JACK_FIXED_AUDIO_IO_HPP
+
+#include "jackaudioio.hpp"
+
+namespace JackCpp {
+
+template<typename Type, unsigned int Size>
+
+/**
+@class FixedArray
+
+@brief A fixed size array, with a specialization for zero elements.
+
+@author Alex Norman
+
+*/
+	struct FixedArray {
+		///The number of elements
+		enum {size = Size};
+		Type data[Size];
+		Type& operator[](unsigned int index){ return data[index]; }
+		const Type& operator[](unsigned int index) const { return data[index]; }
+	};
+
+	//only here so that loops over no elements compile
+	template<typename Type>
+	struct FixedArray<Type, 0> {
+		enum {size = 0};
+		Type none;
+		Type& operator[](unsigned int){ return none; }
+		const Type& operator[](unsigned int) const { return none; }
+	};
+
+template<unsigned int NumIn, unsigned int NumOut, typename Derived>
+
+/**
+@class FixedAudioIO
+
+@brief An AudioIO with a number of ports that is fixed at compile time.
+
+Instead of overriding audioCallback, Derived provides
+
+	int process(jack_nframes_t nframes, const InBuffers& in, const OutBuffers& out);
+
+which is called directly from jack's process callback, not through a virtual
+function, with the port buffers in fixed size arrays.  Since the channel
+counts are constants the compiler can unroll and vectorize across the whole
+callback, and Derived can specialize on numInputs and numOutputs.
+
+	class Gain : public JackCpp::FixedAudioIO<2, 2, Gain> {
+		public:
+			Gain() : JackCpp::FixedAudioIO<2, 2, Gain>("gain") {}
+			int process(jack_nframes_t nframes, const InBuffers& in, const OutBuffers& out){
+				for(unsigned int i = 0; i < numOutputs; i++)
+					for(unsigned int j = 0; j < nframes; j++)
+						out[i][j] = 0.5f * in[i][j];
+				return 0;
+			}
+	};
+
+Ports cannot be added, and latency compensation is not applied, the
+transport snapshot, the realtime arena and buses work as they do for AudioIO,
+a bus's channels replace its ports' buffers in in and out.
+
+@author Alex Norman
+
+*/
+	class FixedAudioIO : public AudioIO {
+		public:
+			///The number of input and output ports
+			enum {numInputs = NumIn, numOutputs = NumOut};
+			///The input buffers passed to Derived::process
+			typedef FixedArray<jack_default_audio_sample_t *, NumIn> InBuffers;
+			///The output buffers passed to Derived::process
+			typedef FixedArray<jack_default_audio_sample_t *, NumOut> OutBuffers;
+
+			/**
+			  @brief The Constructor
+			  \param name string indicating the name of the jack client to create
+			  \param startServer a boolean indicating whether to start a jack server if one isn't already running
+			  */
+			FixedAudioIO(std::string name,
+#ifdef __APPLE__
+					bool startServer = false)
+#else
+					bool startServer = true)
+#endif
+				JACKCPP_THROW(std::runtime_error) :
+				AudioIO(name, NumIn, NumOut, startServer)
+			{
+				for(unsigned int i = 0; i < NumIn; i++)
+					mInPorts[i] = getInputPort(i);
+				for(unsigned int i = 0; i < NumOut; i++)
+					mOutPorts[i] = getOutputPort(i);
+				//replace the callback that AudioIO installed
+				if(0 != jack_set_process_callback(client(), FixedAudioIO::fixedProcessCallback, this))
+					throw std::runtime_error("cannot register process callback");
+			}
+
+			///Not supported, the number of ports is fixed
+			virtual unsigned int addInPort(std::string /* name */)
+				JACKCPP_THROW(std::runtime_error){
+				throw std::runtime_error("cannot add ports to a FixedAudioIO");
+			}
+			///Not supported, the number of ports is fixed
+			virtual unsigned int addOutPort(std::string /* name */)
+				JACKCPP_THROW(std::runtime_error){
+				throw std::runtime_error("cannot add ports to a FixedAudioIO");
+			}
+
+			///The callback that jack actually gets [static]
+			static int fixedProcessCallback(jack_nframes_t nframes, void *arg){
+				return ((FixedAudioIO *)arg)->fixedCallback(nframes);
+			}
+		private:
+			FixedArray<jack_port_t *, NumIn> mInPorts;
+			FixedArray<jack_port_t *, NumOut> mOutPorts;
+
+			inline int fixedCallback(jack_nframes_t nframes){
+				RTChecker::Scope rtScope;
+				RTArena * arena = startCycle();
+
+				InBuffers in;
+				OutBuffers out;
+				for(unsigned int i = 0; i < NumIn; i++)
+					in[i] = (jack_default_audio_sample_t *)jack_port_get_buffer(mInPorts[i], nframes);
+				for(unsigned int i = 0; i < NumOut; i++)
+					out[i] = (jack_default_audio_sample_t *)jack_port_get_buffer(mOutPorts[i], nframes);
+
+				applyBuses(nframes, &in[0], NumIn, &out[0], NumOut);
+
+				int ret = static_cast<Derived *>(this)->process(nframes, in, out);
+				scatterBuses();
+				finishCycle(arena);
+				meterBuffers(nframes, &in[0], NumIn, &out[0], NumOut);
+				renderOutputs(nframes, &out[0], NumOut);
+				return ret;
+			}
+	};
+}
+
+#endif
+
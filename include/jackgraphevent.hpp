@@ -0,0 +1,66 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_GRAPH_EVENT_HPP
+#define JACK_GRAPH_EVENT_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+
+namespace JackCpp {
+
+/**
+@struct GraphEvent
+
+@brief A change to the jack graph, as reported by jack's notification callbacks.
+
+AudioIO queues these up so that they can be read from another thread, see
+AudioIO::waitGraphEvent.  Events are small and fixed size, ports are given by
+id, use jack_port_by_id to get at them.  A port may already be gone by the
+time its event is read.
+
+@author Alex Norman
+
+*/
+	struct GraphEvent {
+		///The kinds of events
+		enum type_t {
+			clientRegistered, clientUnregistered,
+			portRegistered, portUnregistered, portRenamed,
+			portsConnected, portsDisconnected,
+			graphReordered, xrun
+		};
+		///The maximum length of a client name, including the terminating zero
+		enum {clientNameSize = 65};
+
+		///What happened
+		type_t type;
+		///When it happened, from jack_get_time
+		jack_time_t usecs;
+		///The port for port events, one of the two ports for connection events
+		jack_port_id_t port;
+		///The other port for connection events
+		jack_port_id_t otherPort;
+		///The client name for client events, truncated if too long
+		char client[clientNameSize];
+	};
+}
+
+#endif
+
@@ -0,0 +1,186 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_METER_HPP
+#define JACK_METER_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+#include <vector>
+#include "jackseqlock.hpp"
+
+namespace JackCpp {
+
+/**
+@struct MeterReading
+
+@brief The levels of one port, as published by its Meter.
+
+All of the values are linear, 1.0 is full scale.
+
+@author Alex Norman
+
+*/
+	struct MeterReading {
+		///the sample peak, falling at the meter's decay rate
+		float peak;
+		///the RMS level over the meter's integration time
+		float rms;
+		///the peak of the signal oversampled 4 times, falling at the meter's decay rate
+		float truePeak;
+		///the highest sample peak since the holds were reset
+		float peakHold;
+		///the highest true peak since the holds were reset
+		float truePeakHold;
+	};
+
+/**
+@struct MeterConfig
+
+@brief The ballistics of a Meter.
+
+@author Alex Norman
+
+*/
+	struct MeterConfig {
+		///Defaults to a 12 dB per second decay, 300 ms integration and true peak metering
+		MeterConfig() : peakDecay(12.0f), rmsTime(0.3f), truePeak(true) {}
+		///how fast the peaks fall, in dB per second
+		float peakDecay;
+		///the time constant of the RMS level, in seconds
+		float rmsTime;
+		///true to measure the true peak, which costs more than the rest put together
+		bool truePeak;
+	};
+
+	/**
+	  @brief Find the peak and the sum of the squares of a buffer [realtime]
+
+	  This is the metering kernel, it uses SSE where it is available.
+	  \param buf the samples
+	  \param cnt the number of samples
+	  \param peak set to the largest absolute sample value
+	  \param sumSquares set to the sum of the squares of the samples
+	  */
+	void measureLevel(const jack_default_audio_sample_t * buf, unsigned int cnt,
+			float& peak, float& sumSquares);
+
+/**
+@class TruePeakDetector
+
+@brief Finds the peak of a signal between its samples.
+
+The signal is oversampled 4 times with a 48 tap polyphase lowpass filter,
+as ITU-R BS.1770 describes, and the peak of the result is taken.  The
+filter's history is kept so consecutive buffers are treated as one signal.
+
+@author Alex Norman
+
+*/
+	class TruePeakDetector {
+		public:
+			enum {phases = 4, taps = 12};
+			///The Constructor
+			TruePeakDetector();
+			///Get the true peak of the next cnt samples [realtime]
+			float process(const jack_default_audio_sample_t * buf, unsigned int cnt);
+			///Forget the history
+			void reset();
+		private:
+			jack_default_audio_sample_t mHistory[taps - 1];
+	};
+
+/**
+@class Meter
+
+@brief Peak, RMS and true peak metering of one signal.
+
+The realtime thread calls process with each buffer, which applies the
+ballistics and publishes a MeterReading through a SeqLock.  Any number of
+other threads can read it at any time without holding the realtime thread
+up, and without copying any audio.
+
+@author Alex Norman
+
+*/
+	class Meter {
+		public:
+			///The Constructor
+			Meter(const MeterConfig& config = MeterConfig(), jack_nframes_t sampleRate = 48000);
+			///Measure a buffer and publish the result [realtime]
+			void process(const jack_default_audio_sample_t * buf, jack_nframes_t nframes);
+			///Reset the peak holds at the next call to process [realtime]
+			void resetHolds(){ mResetHolds = true; }
+			///Get the latest reading, from any thread
+			MeterReading read() const { return mShared.read(); }
+		private:
+			MeterConfig mConfig;
+			jack_nframes_t mSampleRate;
+			//the per cycle coefficients, recomputed when the buffer size changes
+			jack_nframes_t mFrames;
+			float mPeakFall;
+			float mRmsKeep;
+			double mMeanSquare;
+			volatile bool mResetHolds;
+			MeterReading mReading;
+			TruePeakDetector mTruePeak;
+			SeqLock<MeterReading> mShared;
+	};
+
+/**
+@class MeterBank
+
+@brief A Meter for each of a client's ports.
+
+AudioIO builds one of these when metering is turned on and hands it to
+the callback with an RTSwap.
+
+@author Alex Norman
+
+*/
+	class MeterBank {
+		public:
+			///The Constructor
+			MeterBank(unsigned int inputs, unsigned int outputs,
+					const MeterConfig& config, jack_nframes_t sampleRate);
+			///Get the number of input meters
+			unsigned int inputs() const { return mInputs.size(); }
+			///Get the number of output meters
+			unsigned int outputs() const { return mOutputs.size(); }
+			///Get an input's meter
+			Meter& input(unsigned int index){ return mInputs[index]; }
+			///Get an output's meter
+			Meter& output(unsigned int index){ return mOutputs[index]; }
+			/**
+			  @brief Meter a cycle of buffers [realtime]
+
+			  Buffers beyond the number of meters are ignored.
+			  */
+			void process(jack_nframes_t nframes,
+					jack_default_audio_sample_t * const * inBufs, unsigned int inCount,
+					jack_default_audio_sample_t * const * outBufs, unsigned int outCount);
+			///Reset the peak holds of every meter at the next cycle
+			void resetHolds();
+		private:
+			std::vector<Meter> mInputs;
+			std::vector<Meter> mOutputs;
+	};
+}
+
+#endif
@@ -0,0 +1,73 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_NOTIFIER_HPP
+#define JACK_NOTIFIER_HPP
+
+#include <stdexcept>
+#include "jackcompat.hpp"
+
+namespace JackCpp {
+
+/**
+@class Notifier
+
+@brief A wake up signal that can be waited on or polled as a file descriptor.
+
+notify never blocks and does not allocate, so it can be called from jack's
+threads, including the realtime one.  Notifications are not counted, any
+number of notify calls before a wait wake it up once.  The descriptor
+returned by fd becomes readable when notified, so it can be added to a
+select, poll or event loop, call clear once it has been seen.
+
+On Linux this is an eventfd, elsewhere it is a pipe.
+
+@author Alex Norman
+
+*/
+	class Notifier {
+		public:
+			///The Constructor
+			Notifier() JACKCPP_THROW(std::runtime_error);
+			///The Destructor
+			~Notifier();
+
+			///Wake up anyone waiting
+			void notify();
+			/**
+			  @brief Wait to be notified
+
+			  \param timeoutMs the maximum time to wait in milliseconds, negative waits forever
+			  \return true if we were notified, false if we timed out
+			  */
+			bool wait(int timeoutMs = -1);
+			///Forget about any notifications that have not been waited for
+			void clear();
+			///Get a file descriptor that is readable while there is a notification
+			int fd() const { return mReadFd; }
+		private:
+			//not copyable
+			Notifier(const Notifier&);
+			Notifier& operator=(const Notifier&);
+			int mReadFd;
+			int mWriteFd;
+	};
+}
+
+#endif
+
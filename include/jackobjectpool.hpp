@@ -0,0 +1,182 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef JACK_OBJECT_POOL_HPP
+#define JACK_OBJECT_POOL_HPP
+
+#include <new>
+#include <stdexcept>
+#include "jackcompat.hpp"
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "jackringbuffer.hpp"
+#include "jacknotifier.hpp"
+
+namespace JackCpp {
+
+template<typename Type>
+
+/**
+@class ObjectPool
+
+@brief A fixed number of objects that the jack callback can take and give back.
+
+All of the objects are constructed up front in locked memory.  acquire hands
+out a default constructed object without allocating, release gives it back.
+Released objects are destructed and constructed again on the pool's own
+reclaimer thread, so their destructors may free memory or do other things
+that are not safe in the callback.  Unlike RTArena objects live for as long
+as you like, across cycles.
+
+Only one realtime thread may acquire and release objects.  Every object must
+be released before the pool is deleted.
+
+@author Alex Norman
+
+*/
+	class ObjectPool {
+		private:
+			char * mStorage;
+			size_t mCapacity;
+			bool mLocked;
+			//reclaimer -> realtime
+			RingBuffer<Type *> mFree;
+			//realtime -> reclaimer
+			RingBuffer<Type *> mRetired;
+			Notifier mNotifier;
+			pthread_t mThread;
+			volatile bool mRunning;
+			//only written by the realtime thread
+			volatile size_t mInUse;
+			volatile size_t mHighWater;
+			volatile unsigned int mFailures;
+
+			//not copyable
+			ObjectPool(const ObjectPool&);
+			ObjectPool& operator=(const ObjectPool&);
+
+			void reclaim(){
+				while(mRetired.getReadSpace() > 0){
+					Type * item;
+					mRetired.read(item);
+					item->~Type();
+					new (item) Type();
+					mFree.write(item);
+				}
+			}
+			static void * reclaimer(void * arg){
+				ObjectPool * pool = (ObjectPool *)arg;
+				while(pool->mRunning){
+					pool->mNotifier.wait(100);
+					pool->reclaim();
+				}
+				return NULL;
+			}
+		public:
+			/**
+			  @brief The Constructor
+			  \param capacity the number of objects in the pool
+			  */
+			ObjectPool(size_t capacity) JACKCPP_THROW(std::runtime_error) :
+				mStorage(NULL), mCapacity(capacity), mLocked(false),
+				//the jack ring buffer holds one less byte than it is created with
+				mFree(capacity + 1, true), mRetired(capacity + 1, true),
+				mRunning(true), mInUse(0), mHighWater(0), mFailures(0)
+			{
+				void * data;
+				size_t alignment = (__alignof__(Type) > sizeof(void *)) ? __alignof__(Type) : sizeof(void *);
+				if(posix_memalign(&data, alignment, mCapacity * sizeof(Type)) != 0)
+					throw std::runtime_error("cannot allocate object pool");
+				mStorage = (char *)data;
+				mLocked = mlock(mStorage, mCapacity * sizeof(Type)) == 0;
+				for(size_t i = 0; i < mCapacity; i++)
+					mFree.write(new (mStorage + i * sizeof(Type)) Type());
+				if(pthread_create(&mThread, NULL, ObjectPool::reclaimer, this) != 0){
+					destroyAll();
+					throw std::runtime_error("cannot start object pool reclaimer thread");
+				}
+			}
+			///The Destructor
+			~ObjectPool(){
+				mRunning = false;
+				mNotifier.notify();
+				pthread_join(mThread, NULL);
+				destroyAll();
+			}
+
+			/**
+			  @brief Take an object from the pool [realtime]
+			  \return a default constructed object, or NULL if there are none left
+			  */
+			Type * acquire(){
+				if(mFree.getReadSpace() == 0){
+					mFailures = mFailures + 1;
+					return NULL;
+				}
+				Type * item;
+				mFree.read(item);
+				mInUse = mInUse + 1;
+				if(mInUse > mHighWater)
+					mHighWater = mInUse;
+				return item;
+			}
+			/**
+			  @brief Give an object back to the pool [realtime]
+
+			  The object is destructed later on the reclaimer thread.
+			  */
+			void release(Type * item){
+				mRetired.write(item);
+				mInUse = mInUse - 1;
+				mNotifier.notify();
+			}
+
+			///Get the number of objects in the pool
+			size_t capacity() const { return mCapacity; }
+			///Get the number of objects that are ready to be acquired
+			size_t available(){ return mFree.getReadSpace(); }
+			///Get the number of objects that the realtime side holds
+			size_t inUse() const { return mInUse; }
+			///Get the most objects the realtime side has held at once
+			size_t highWater() const { return mHighWater; }
+			///Get the number of times acquire found the pool empty
+			unsigned int failures() const { return mFailures; }
+			///See if the pool's memory could be locked
+			bool locked() const { return mLocked; }
+		private:
+			void destroyAll(){
+				while(mRetired.getReadSpace() > 0){
+					Type * item;
+					mRetired.read(item);
+					item->~Type();
+				}
+				while(mFree.getReadSpace() > 0){
+					Type * item;
+					mFree.read(item);
+					item->~Type();
+				}
+				if(mLocked)
+					munlock(mStorage, mCapacity * sizeof(Type));
+				free(mStorage);
+				mStorage = NULL;
+			}
+	};
+}
+
+#endif
+
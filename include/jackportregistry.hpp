@@ -0,0 +1,105 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_PORT_REGISTRY_HPP
+#define JACK_PORT_REGISTRY_HPP
+
+extern "C" {
+#include <jack/jack.h>
+#include <jack/types.h>
+}
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include "jackcompat.hpp"
+
+namespace JackCpp {
+
+/**
+@class PortRegistry
+
+@brief A client side cache of the ports known to the jack server.
+
+The registry is filled with jack_get_ports and then kept up to date from
+the port registration and rename callbacks, so looking up a port or a
+physical port does not need to talk to the jack server.  AudioIO owns one and
+feeds it the callbacks.  Jack only sends those to active clients, so AudioIO
+fills it again every time the client is activated.
+
+The registry is locked with a mutex, so it can be used from any thread
+except the realtime one.
+
+@author Alex Norman
+
+*/
+	class PortRegistry {
+		public:
+			PortRegistry();
+			~PortRegistry();
+
+			///Fill the registry with the ports that currently exist, forgetting the old ones
+			void init(jack_client_t * client);
+			///Forget everything, for instance when the client is closed
+			void clear();
+
+			///Tell the registry that a port was registered or unregistered
+			void portRegistered(jack_port_id_t id, bool registered);
+			///Tell the registry that a port was renamed
+			void portRenamed(jack_port_id_t id, const char * oldName, const char * newName);
+
+			///See if a port with the full name "client:port" exists
+			bool exists(const std::string& name);
+			///Get a port by its full name, NULL if it doesn't exist
+			jack_port_t * port(const std::string& name);
+			///Get the flags of a port by its full name, 0 if it doesn't exist
+			int flags(const std::string& name);
+			///Get the names of all the ports with all of the given flags set
+			std::vector<std::string> ports(unsigned long flags);
+
+			///Get the number of physical ports that send audio to clients
+			unsigned int numPhysicalSources();
+			///Get the number of physical ports that clients send audio to
+			unsigned int numPhysicalDestinations();
+			///Get the name of a physical source port, in the order jack lists them
+			std::string physicalSource(unsigned int index)
+				JACKCPP_THROW(std::range_error);
+			///Get the name of a physical destination port, in the order jack lists them
+			std::string physicalDestination(unsigned int index)
+				JACKCPP_THROW(std::range_error);
+		private:
+			struct port_info_t {
+				jack_port_t * port;
+				int flags;
+			};
+			void add(jack_port_t * port);
+			void remove(jack_port_t * port);
+
+			jack_client_t * mClient;
+			pthread_mutex_t mMutex;
+			std::map<std::string, port_info_t> mByName;
+			std::map<jack_port_t *, std::string> mNames;
+			//in the order that jack_get_ports lists them, new ports go at the end
+			std::vector<std::string> mPhysicalSources;
+			std::vector<std::string> mPhysicalDestinations;
+	};
+}
+
+#endif
+
@@ -0,0 +1,144 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_RESAMPLER_HPP
+#define JACK_RESAMPLER_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+#include <vector>
+#include <stdexcept>
+#include "jackcompat.hpp"
+
+namespace JackCpp {
+
+/**
+@class Resampler
+
+@brief A multi-channel polyphase windowed-sinc sample rate converter.
+
+The filter table is computed in the constructor, so a Resampler should be
+created outside of the jack callback.  After that, pushing input, processing
+and adjusting the ratio do not allocate and are safe to call from the
+callback.  All channels share a single phase so they stay sample aligned.
+
+Input is written directly into the resampler with inputBuffer and
+commitInput, output is produced with process.  The ratio can be trimmed
+while running with setRatioAdjust, which is how BlockingAudioIO compensates
+for clock drift between a user and the jack server.
+
+@author Alex Norman
+
+*/
+	class Resampler {
+		public:
+			///The filter quality presets, better quality costs more taps per sample
+			enum quality_t {fast, medium, best};
+			///The largest amount that setRatioAdjust will move the ratio from nominal
+			static const double maxRatioAdjust;
+
+			/**
+			  @brief The Constructor
+			  \param channels the number of channels to convert
+			  \param inRate the sample rate of the input
+			  \param outRate the sample rate of the output
+			  \param maxFrames the maximum number of frames that will be pushed or processed at once
+			  \param quality the filter quality preset
+			  */
+			Resampler(unsigned int channels, double inRate, double outRate,
+					unsigned int maxFrames, quality_t quality = medium)
+				JACKCPP_THROW(std::runtime_error);
+
+			///Get the number of channels
+			unsigned int channels() const { return mChannels; }
+			///Get the largest block size we were created for
+			unsigned int maxFrames() const { return mMaxFrames; }
+			///Get the nominal ratio of input frames consumed per output frame
+			double nominalStep() const { return mNominalStep; }
+
+			/**
+			  @brief Trim the conversion ratio
+
+			  The nominal step is multiplied by adjust, which is clamped to
+			  1 +/- maxRatioAdjust.  This is used for drift compensation.
+			  */
+			void setRatioAdjust(double adjust);
+			///Get the current ratio trim
+			double ratioAdjust() const { return mAdjust; }
+
+			///Get the number of input frames that must be pushed before outFrames can be processed
+			unsigned int inputFramesNeeded(unsigned int outFrames) const;
+			///Get the number of output frames that can be processed with the input we have
+			unsigned int outputFramesAvailable() const;
+			///Get the number of input frames that can be pushed
+			unsigned int inputSpace() const { return mCapacity - mFill; }
+
+			/**
+			  @brief Get a pointer to write new input for a channel into
+
+			  Up to inputSpace() frames can be written, they are not used until
+			  commitInput is called.
+			  */
+			jack_default_audio_sample_t * inputBuffer(unsigned int channel);
+			///Make frames written into inputBuffer available to process
+			void commitInput(unsigned int frames);
+
+			/**
+			  @brief Produce output
+
+			  Writes outFrames to each out[channel], outFrames is clamped to
+			  outputFramesAvailable().
+
+			  \param out a vector of output buffers, one per channel
+			  \param outFrames the number of frames to produce
+			  \return the number of frames actually produced
+			  */
+			unsigned int process(const std::vector<jack_default_audio_sample_t *>& out,
+					unsigned int outFrames);
+
+			///Get the delay that the filter adds, in input frames
+			unsigned int latency() const { return mTaps / 2; }
+			///Clear the history and phase, not thread safe
+			void reset();
+		private:
+			void buildTable(double cutoff, double beta, unsigned int phases);
+
+			const unsigned int mChannels;
+			const unsigned int mMaxFrames;
+			unsigned int mTaps;
+			unsigned int mPhases;
+			//mPhases rows of mTaps coefficients and the difference to the next row
+			std::vector<float> mTable;
+			std::vector<float> mDelta;
+
+			//per channel history, mCapacity frames per channel
+			std::vector<jack_default_audio_sample_t> mHistory;
+			unsigned int mCapacity;
+			unsigned int mFill;
+
+			double mNominalStep;
+			double mStep;
+			double mAdjust;
+			//the position of the next output relative to the start of the history
+			double mPos;
+	};
+}
+
+#endif
+
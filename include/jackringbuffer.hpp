@@ -189,6 +189,50 @@ thread. Their identities cannot be interchanged.
 				jack_ringbuffer_write_advance(mRingBufferPtr, write_size);
 			}
 
+			/**
+			  @brief Get the items that can be read, in place
+
+			  The readable items are in up to two parts, first and then second,
+			  which is empty unless they wrap around the end of the buffer.
+			  Call readAdvance once they have been used.  Items are only whole
+			  in each part when sizeof(Type) is a power of two.
+
+			  \param first the first part
+			  \param firstCnt the number of items in first
+			  \param second the second part
+			  \param secondCnt the number of items in second
+			  */
+			void getReadVector(Type *&first, size_t &firstCnt, Type *&second, size_t &secondCnt){
+				jack_ringbuffer_data_t readVec[2];
+				jack_ringbuffer_get_read_vector(mRingBufferPtr, readVec);
+				first = (Type *)readVec[0].buf;
+				firstCnt = readVec[0].len / sizeof(Type);
+				second = (Type *)readVec[1].buf;
+				secondCnt = readVec[1].len / sizeof(Type);
+			}
+			///Mark cnt items as read, after getReadVector
+			void readAdvance(size_t cnt){
+				jack_ringbuffer_read_advance(mRingBufferPtr, cnt * sizeof(Type));
+			}
+
+			/**
+			  @brief Get the space that can be written, in place
+
+			  Like getReadVector, call writeAdvance once the items are written.
+			  */
+			void getWriteVector(Type *&first, size_t &firstCnt, Type *&second, size_t &secondCnt){
+				jack_ringbuffer_data_t writeVec[2];
+				jack_ringbuffer_get_write_vector(mRingBufferPtr, writeVec);
+				first = (Type *)writeVec[0].buf;
+				firstCnt = writeVec[0].len / sizeof(Type);
+				second = (Type *)writeVec[1].buf;
+				secondCnt = writeVec[1].len / sizeof(Type);
+			}
+			///Mark cnt items as written, after getWriteVector
+			void writeAdvance(size_t cnt){
+				jack_ringbuffer_write_advance(mRingBufferPtr, cnt * sizeof(Type));
+			}
+
 			/**
 			  @brief Reset
 
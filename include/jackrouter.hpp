@@ -0,0 +1,157 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_ROUTER_HPP
+#define JACK_ROUTER_HPP
+
+#include "jackaudioio.hpp"
+#include <pthread.h>
+
+namespace JackCpp {
+
+/**
+@class AudioRouter
+
+@brief Runs several AudioIO objects in one jack callback, wired together in process.
+
+Each node is an AudioIO made with the default constructor, so it has no
+jack client of its own, and the router calls its processAudio directly.
+Routes join a node's output to another node's input, or to and from the
+router's own ports, which are the only real jack ports.  The nodes run in
+the order their routes give, and a node that is fed by one output gets a
+pointer to that output's buffer rather than a copy.  Only inputs fed by
+several outputs are mixed, and a node output that is the only source of one
+of the router's ports is rendered straight into the port's buffer.
+
+Nodes must not write to their inputs, which may be shared.  The routes are
+turned into a plan outside of the callback by update, and when the buffer
+size changes, and swapped in with an RTSwap.  Routes that make a loop are
+an error.
+
+@author Alex Norman
+
+*/
+	class AudioRouter : public AudioIO {
+		public:
+			///The node index that stands for the router's own ports
+			static const unsigned int ports = 0xffffffff;
+			/**
+			  @brief The Constructor
+			  \param name string indicating the name of the jack client to create
+			  \param inPorts the number of input ports
+			  \param outPorts the number of output ports
+			  \param startServer a boolean indicating whether to start a jack server if one isn't already running
+			  */
+			AudioRouter(std::string name, unsigned int inPorts = 0, unsigned int outPorts = 2,
+#ifdef __APPLE__
+					bool startServer = false)
+#else
+					bool startServer = true)
+#endif
+				JACKCPP_THROW(std::runtime_error);
+			///The Destructor, stops the client before the plan goes away
+			virtual ~AudioRouter();
+			/**
+			  @brief Add a node, call update to run it
+
+			  The router does not own the node, which must outlive it or be
+			  removed with clear and update first.
+			  \param node an AudioIO made with the default constructor
+			  \param inputs the number of inputs the node is given
+			  \param outputs the number of outputs the node is given
+			  \return the index of the node
+			  */
+			unsigned int addNode(AudioIO * node, unsigned int inputs, unsigned int outputs)
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			  @brief Route an output to an input, call update to use it
+
+			  Either node may be AudioRouter::ports, for the router's own
+			  input and output ports.
+			  \param fromNode the node whose output is routed, or ports
+			  \param output the output of fromNode, or the input port
+			  \param toNode the node whose input is fed, or ports
+			  \param input the input of toNode, or the output port
+			  */
+			void route(unsigned int fromNode, unsigned int output,
+					unsigned int toNode, unsigned int input)
+				JACKCPP_THROW(std::range_error);
+			///Remove every node and route, call update to use it
+			void clear();
+			///Build a plan from the nodes and routes and swap it into the callback
+			void update() JACKCPP_THROW(std::runtime_error);
+
+			///Rebuilds the plan for the new buffer size
+			virtual int jackBufferSizeCallback(jack_nframes_t nframes);
+		protected:
+			virtual int processAudio(jack_nframes_t nframes,
+					const audioBufVector& inBufs,
+					const audioBufVector& outBufs);
+		private:
+			struct node_def_t {
+				AudioIO * node;
+				unsigned int inputs;
+				unsigned int outputs;
+			};
+			struct route_t {
+				unsigned int fromNode;
+				unsigned int output;
+				unsigned int toNode;
+				unsigned int input;
+			};
+			//fill a slot from other slots, copying one, summing several or
+			//clearing it if there are none
+			struct mix_t {
+				unsigned int dest;
+				unsigned int first;
+				unsigned int count;
+			};
+			//the buffers are slots, the router's inputs, then its outputs,
+			//then the buffers of the plan
+			struct plan_t {
+				jack_nframes_t frames;
+				unsigned int inPorts;
+				unsigned int outPorts;
+				std::vector<jack_default_audio_sample_t> memory;
+				std::vector<jack_default_audio_sample_t *> slots;
+				//the nodes in the order they run, with the slots of their
+				//inputs and outputs, and the mixes to do before each one,
+				//the last mixes are for the outputs
+				std::vector<AudioIO *> nodes;
+				std::vector<audioBufVector> in;
+				std::vector<audioBufVector> out;
+				std::vector<std::vector<unsigned int> > inSlots;
+				std::vector<std::vector<unsigned int> > outSlots;
+				std::vector<unsigned int> firstMix;
+				std::vector<mix_t> mixes;
+				std::vector<unsigned int> sources;
+			};
+			plan_t * createPlan(jack_nframes_t frames)
+				JACKCPP_THROW(std::runtime_error);
+			void runMixes(const plan_t * plan, unsigned int first, unsigned int last,
+					jack_nframes_t nframes);
+
+			std::vector<node_def_t> mNodes;
+			std::vector<route_t> mRoutes;
+			RTSwap<plan_t> mPlan;
+			bool mPlanned;
+			pthread_mutex_t mUpdateLock;
+	};
+}
+
+#endif
@@ -0,0 +1,118 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef JACK_RT_ARENA_HPP
+#define JACK_RT_ARENA_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+#include <stddef.h>
+#include <stdexcept>
+#include "jackcompat.hpp"
+
+namespace JackCpp {
+
+/**
+@class RTArena
+
+@brief A bump allocator for temporary memory inside the jack callback.
+
+The memory is allocated, locked and touched up front, so allocating from an
+arena never calls malloc or takes a page fault.  Allocations are only valid
+until the next reset, AudioIO resets its arena at the start of every cycle,
+so anything allocated in audioCallback is gone by the next one.  Nothing is
+constructed or destructed, only use it for plain data.
+
+An arena is only meant to be used by one thread at a time.
+
+@author Alex Norman
+
+*/
+	class RTArena {
+		public:
+			///The alignment of scratch blocks, suitable for vector instructions
+			enum {blockAlignment = 64};
+
+			/**
+			  @brief The Constructor
+			  \param bytes the number of bytes the arena can hand out between resets
+			  \param frames the number of samples in a scratch block, usually the jack buffer size
+			  */
+			RTArena(size_t bytes, jack_nframes_t frames = 0)
+				JACKCPP_THROW(std::runtime_error);
+			///The Destructor
+			~RTArena();
+
+			/**
+			  @brief Allocate memory [realtime]
+			  \param bytes the number of bytes to allocate
+			  \param alignment a power of two no larger than blockAlignment
+			  \return the memory, or NULL if the arena is full
+			  */
+			void * allocate(size_t bytes, size_t alignment = 16);
+			/**
+			  @brief Allocate an array [realtime]
+
+			  The elements are not constructed.
+			  \param count the number of elements
+			  \return the array, or NULL if the arena is full
+			  */
+			template<typename T>
+				T * allocateArray(size_t count){
+					return (T *)allocate(count * sizeof(T), __alignof__(T));
+				}
+			/**
+			  @brief Allocate a block of frames() samples aligned to blockAlignment [realtime]
+			  \return the block, or NULL if the arena is full
+			  */
+			jack_default_audio_sample_t * scratchBlock();
+			///Make all of the memory available again, invalidating everything allocated [realtime]
+			void reset();
+
+			///Get the number of bytes the arena holds
+			size_t capacity() const { return mCapacity; }
+			///Get the number of bytes allocated since the last reset
+			size_t used() const { return mUsed; }
+			///Get the most bytes that have been allocated between two resets
+			size_t highWater() const { return mHighWater; }
+			///Get the number of allocations that failed because the arena was full
+			unsigned int failures() const { return mFailures; }
+			///Get the number of samples in a scratch block
+			jack_nframes_t frames() const { return mFrames; }
+			///See if the memory could be locked
+			bool locked() const { return mLocked; }
+
+			///Get the number of bytes a scratch block of frames samples takes up in an arena
+			static size_t blockBytes(jack_nframes_t frames);
+		private:
+			//not copyable
+			RTArena(const RTArena&);
+			RTArena& operator=(const RTArena&);
+
+			char * mData;
+			size_t mCapacity;
+			size_t mUsed;
+			size_t mHighWater;
+			unsigned int mFailures;
+			jack_nframes_t mFrames;
+			bool mLocked;
+	};
+}
+
+#endif
+
@@ -0,0 +1,86 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef JACK_RT_CHECK_HPP
+#define JACK_RT_CHECK_HPP
+
+#include <iostream>
+
+namespace JackCpp {
+
+/**
+@class RTChecker
+
+@brief A debugging aid that catches things that are not realtime safe in the jack callback.
+
+When the library is built with JACKCPP_RTCHECK defined (see config.mk), it
+replaces malloc, free, new, delete, pthread_mutex_lock, the sleep functions
+and a few blocking calls with versions that record a violation whenever they
+are called from inside AudioIO's process callback while checking is enabled.
+Each violation keeps the raw addresses of its backtrace, they are only
+turned into symbols when report is called from another thread.
+
+Without JACKCPP_RTCHECK nothing is replaced, available returns false and
+violations always returns 0.
+
+@author Alex Norman
+
+*/
+	class RTChecker {
+		public:
+			///The kinds of violations
+			enum kind_t {mallocCall, freeCall, newCall, deleteCall, mutexLock, blockingCall, sleepCall};
+			///The number of backtrace frames kept for each violation
+			enum {maxFrames = 24};
+			///The number of violations that are kept, more are counted but not kept
+			enum {maxViolations = 256};
+
+			///See if the library was built with the checker
+			static bool available();
+			///Start or stop recording violations
+			static void enable(bool enable = true);
+			///See if violations are being recorded
+			static bool enabled();
+			///Get the number of violations since the last clear
+			static unsigned int violations();
+			///Forget the violations, don't call this while a client is running
+			static void clear();
+			///Write the violations with symbolized backtraces to out [non realtime]
+			static void report(std::ostream& out);
+			///Get the name of a kind of violation
+			static const char * kindName(kind_t kind);
+
+			///Mark the calling thread as being in the realtime callback, calls nest
+			static void enter();
+			///Undo enter
+			static void leave();
+			///See if the calling thread is in the realtime callback
+			static bool inRealtime();
+			///Record a violation in the calling thread, if it is in the realtime callback
+			static void record(kind_t kind);
+
+			///Calls enter and leave for as long as it is in scope
+			class Scope {
+				public:
+					Scope(){ RTChecker::enter(); }
+					~Scope(){ RTChecker::leave(); }
+			};
+	};
+}
+
+#endif
+
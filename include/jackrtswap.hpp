@@ -0,0 +1,142 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_RT_SWAP_HPP
+#define JACK_RT_SWAP_HPP
+
+#include "jackringbuffer.hpp"
+
+namespace JackCpp {
+
+template<typename Type>
+
+/**
+@class RTSwap
+
+@brief This template class hands heap objects to the jack callback without locking.
+
+Objects are allocated outside of the callback and published.  At the start
+of a cycle the callback calls acquire, which adopts the newest published
+object and hands the one it replaces back.  The replaced objects are deleted
+the next time the non realtime side publishes or calls reclaim, so the
+callback never allocates or frees.
+
+Like RingBuffer there can only be one non realtime thread and one realtime
+thread using an RTSwap.
+
+@author Alex Norman
+
+*/
+	class RTSwap {
+		private:
+			Type * mCurrent;
+			//non realtime -> realtime
+			RingBuffer<Type *> mPending;
+			//realtime -> non realtime
+			RingBuffer<Type *> mRetired;
+		public:
+			/**
+			  @brief The Constructor
+			  \param initial the object to start with, may be NULL, we take ownership of it
+			  \param depth the number of objects that can be published before the callback adopts them
+			  */
+			RTSwap(Type * initial = NULL, size_t depth = 4) :
+				mCurrent(initial),
+				//the jack ring buffer holds one less byte than it is created with
+				mPending(depth + 1, true),
+				mRetired(2 * depth + 1, true)
+			{
+			}
+
+			///The Destructor, deletes everything that we still own
+			~RTSwap(){
+				reclaim();
+				while(mPending.getReadSpace() > 0){
+					Type * item;
+					mPending.read(item);
+					delete item;
+				}
+				delete mCurrent;
+			}
+
+			/**
+			  @brief Hand a new object to the realtime side [non realtime]
+
+			  We take ownership of next, it is adopted the next time acquire is
+			  called.
+			  \return false if too many objects are waiting to be adopted, in
+			  which case we do not take ownership of next.
+			  */
+			bool publish(Type * next){
+				reclaim();
+				if(mPending.getWriteSpace() == 0)
+					return false;
+				mPending.write(next);
+				return true;
+			}
+
+			/**
+			  @brief Adopt the newest published object [realtime]
+			  \return the current object, may be NULL
+			  */
+			Type * acquire(){
+				while(mPending.getReadSpace() > 0){
+					Type * next;
+					mPending.read(next);
+					if(mCurrent != NULL)
+						mRetired.write(mCurrent);
+					mCurrent = next;
+				}
+				return mCurrent;
+			}
+
+			///Get the current object without adopting a published one
+			Type * get() const {
+				return mCurrent;
+			}
+
+			///Delete the objects the realtime side has replaced [non realtime]
+			void reclaim(){
+				while(mRetired.getReadSpace() > 0){
+					Type * item;
+					mRetired.read(item);
+					delete item;
+				}
+			}
+
+			/**
+			  @brief Replace the current object immediately
+
+			  This is not threadsafe, only use it when the realtime side isn't
+			  running, ie. the jack client is not active.
+			  */
+			void reset(Type * next){
+				while(mPending.getReadSpace() > 0){
+					Type * item;
+					mPending.read(item);
+					delete item;
+				}
+				reclaim();
+				delete mCurrent;
+				mCurrent = next;
+			}
+	};
+}
+
+#endif
+
@@ -0,0 +1,115 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_SAMPLE_FORMAT_HPP
+#define JACK_SAMPLE_FORMAT_HPP
+
+extern "C" {
+#include <jack/types.h>
+}
+#include <stdint.h>
+
+namespace JackCpp {
+
+/**
+@struct Int24
+
+@brief A packed 24 bit sample, 3 bytes, least significant byte first.
+
+@author Alex Norman
+
+*/
+	struct Int24 {
+		unsigned char bytes[3];
+	};
+
+/**
+@struct Int24In32
+
+@brief A 24 bit sample in the low 24 bits of a sign extended 32 bit integer.
+
+@author Alex Norman
+
+*/
+	struct Int24In32 {
+		int32_t value;
+	};
+
+/**
+@class Dither
+
+@brief Triangular (TPDF) dither noise.
+
+Each call to next returns the sum of two independent uniform random values,
+so the noise is spread over plus and minus one step of the narrower format.
+The generator is a simple LCG, it never allocates or locks.
+
+@author Alex Norman
+
+*/
+	class Dither {
+		public:
+			///The Constructor
+			Dither(uint32_t seed = 1) : mState(seed) {}
+			///Get the next value, between -1 and 1 [realtime]
+			float next(){ return uniform() + uniform(); }
+		private:
+			float uniform(){
+				mState = mState * 1664525u + 1013904223u;
+				return (float)(mState >> 8) * (1.0f / 16777216.0f) - 0.5f;
+			}
+			uint32_t mState;
+	};
+
+	/**
+	  @brief Convert samples to floats
+
+	  Integers are scaled so that full scale is -1 to 1, doubles are copied.
+	  \param src the first sample to convert
+	  \param srcStride the distance between samples in src, for converting one channel of interleaved data
+	  \param dest where to put the floats, contiguous
+	  \param cnt the number of samples to convert
+	  */
+	void toFloat(const int16_t * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt);
+	void toFloat(const Int24 * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt);
+	void toFloat(const Int24In32 * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt);
+	void toFloat(const int32_t * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt);
+	void toFloat(const double * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt);
+	void toFloat(const jack_default_audio_sample_t * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt);
+
+	/**
+	  @brief Convert floats to samples
+
+	  Values outside of -1 to 1 are clipped.  When dither is given, TPDF
+	  dither is added before rounding to int16 and 24 bit samples, the other
+	  formats hold a float without losing precision so they ignore it.
+	  \param src the floats to convert, contiguous
+	  \param dest where to put the first sample
+	  \param destStride the distance between samples in dest, for converting into one channel of interleaved data
+	  \param cnt the number of samples to convert
+	  \param dither the noise source to dither with, NULL for none
+	  */
+	void fromFloat(const jack_default_audio_sample_t * src, int16_t * dest, unsigned int destStride, unsigned int cnt, Dither * dither = NULL);
+	void fromFloat(const jack_default_audio_sample_t * src, Int24 * dest, unsigned int destStride, unsigned int cnt, Dither * dither = NULL);
+	void fromFloat(const jack_default_audio_sample_t * src, Int24In32 * dest, unsigned int destStride, unsigned int cnt, Dither * dither = NULL);
+	void fromFloat(const jack_default_audio_sample_t * src, int32_t * dest, unsigned int destStride, unsigned int cnt, Dither * dither = NULL);
+	void fromFloat(const jack_default_audio_sample_t * src, double * dest, unsigned int destStride, unsigned int cnt, Dither * dither = NULL);
+	void fromFloat(const jack_default_audio_sample_t * src, jack_default_audio_sample_t * dest, unsigned int destStride, unsigned int cnt, Dither * dither = NULL);
+}
+
+#endif
@@ -0,0 +1,87 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_SEQ_LOCK_HPP
+#define JACK_SEQ_LOCK_HPP
+
+namespace JackCpp {
+
+template<typename Type>
+
+/**
+@class SeqLock
+
+@brief This template class publishes a value from the jack callback to other threads.
+
+A sequence lock lets a single writer update a value without ever waiting,
+while any number of readers take consistent copies of it.  A reader that
+overlaps a write simply tries again, so readers never hold up the writer.
+This makes it suitable for publishing state from the realtime thread.
+
+The writer should be the realtime thread, if a non realtime thread is
+preempted in the middle of a write then readers spin until it continues.
+Type should be a plain struct that can be copied with assignment.
+
+@author Alex Norman
+
+*/
+	class SeqLock {
+		private:
+			volatile unsigned int mSequence;
+			Type mValue;
+		public:
+			SeqLock() : mSequence(0), mValue() {}
+
+			///Publish a new value, there can only be one writer
+			void write(const Type& value){
+				//an odd sequence tells readers a write is in progress
+				mSequence = mSequence + 1;
+				__sync_synchronize();
+				mValue = value;
+				__sync_synchronize();
+				mSequence = mSequence + 1;
+			}
+
+			///Take a consistent copy of the value
+			void read(Type& value) const {
+				unsigned int before, after;
+				do {
+					before = mSequence;
+					__sync_synchronize();
+					value = mValue;
+					__sync_synchronize();
+					after = mSequence;
+				} while(before != after || (before & 1));
+			}
+
+			///Take a consistent copy of the value
+			Type read() const {
+				Type value;
+				read(value);
+				return value;
+			}
+
+			///Get the number of writes so far, readers can use this to see if anything changed
+			unsigned int sequence() const {
+				return mSequence / 2;
+			}
+	};
+}
+
+#endif
+
@@ -0,0 +1,221 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_STREAM_REACTOR_HPP
+#define JACK_STREAM_REACTOR_HPP
+
+#include <pthread.h>
+#include <deque>
+#include <list>
+#include <vector>
+#include <stdexcept>
+#include "jackcompat.hpp"
+#include "jackblockingaudioio.hpp"
+#include "jacknotifier.hpp"
+
+namespace JackCpp {
+
+/**
+@class Executor
+
+@brief Somewhere to run the completions of asynchronous operations.
+
+StreamReactor hands every finished read and write to an executor, which
+decides what thread the completion runs on.
+
+@author Alex Norman
+
+*/
+	class Executor {
+		public:
+			///The type of a task, called with the argument it was posted with
+			typedef void (*task_t)(void * arg);
+			virtual ~Executor() {}
+			///Run task(arg), now or later, from any thread
+			virtual void post(task_t task, void * arg) = 0;
+	};
+
+/**
+@class InlineExecutor
+
+@brief An Executor that runs tasks immediately on the thread that posts them.
+
+Used by StreamReactor when no executor is given, completions then run on
+the reactor's thread and should not block.
+
+@author Alex Norman
+
+*/
+	class InlineExecutor : public Executor {
+		public:
+			virtual void post(task_t task, void * arg) { task(arg); }
+	};
+
+/**
+@class QueueExecutor
+
+@brief An Executor that queues tasks for the threads that call run or poll.
+
+This is how a small number of threads of your own service many streams:
+each calls run, and every completion executes on one of them.
+
+@author Alex Norman
+
+*/
+	class QueueExecutor : public Executor {
+		public:
+			QueueExecutor();
+			virtual ~QueueExecutor();
+			///Queue a task, wakes up a thread in run
+			virtual void post(task_t task, void * arg);
+			///Run tasks as they are posted until stop is called
+			void run();
+			///Run the tasks that are queued without waiting, returns the number run
+			unsigned int poll();
+			///Make run return once the task it is running, if any, finishes
+			void stop();
+			///Let run be called again after stop
+			void restart();
+		private:
+			//not copyable
+			QueueExecutor(const QueueExecutor&);
+			QueueExecutor& operator=(const QueueExecutor&);
+			struct entry_t {
+				task_t task;
+				void * arg;
+			};
+			pthread_mutex_t mMutex;
+			pthread_cond_t mCond;
+			std::deque<entry_t> mTasks;
+			bool mStopped;
+	};
+
+/**
+@class StreamReactor
+
+@brief Completes reads and writes on many BlockingAudioIO streams from one thread.
+
+readFrames and writeFrames queue an operation and return straight away.
+The reactor's thread waits on the readiness descriptors of every stream
+with a pending operation, moves frames whenever the jack callback has made
+input or space available, and posts the completion to the executor once
+all of the frames have been moved.  Operations on the same stream and
+direction complete in the order they were queued.
+
+The reactor takes over the readiness descriptors and watermarks of the
+streams it is given, so don't use them elsewhere at the same time.
+Buffers must stay valid until their operation completes.  Call cancel
+before deleting a stream that may still have operations pending.  The
+coroutine interface in jackcoroutine.hpp is built on this.
+
+@author Alex Norman
+
+*/
+	class StreamReactor {
+		public:
+			/**
+			  @brief The type of a completion
+
+			  \param arg the argument given with the operation
+			  \param frames the number of frames moved, fewer than asked for
+			  only if the operation was cancelled
+			  */
+			typedef void (*completion_t)(void * arg, unsigned int frames);
+
+			/**
+			  @brief The Constructor, starts the reactor's thread
+			  \param executor where completions run, NULL runs them on the reactor's thread
+			  */
+			StreamReactor(Executor * executor = NULL)
+				JACKCPP_THROW(std::runtime_error);
+			///The Destructor, stops the thread and completes pending operations as cancelled
+			~StreamReactor();
+
+			/**
+			  @brief Read interleaved frames from every input of a stream
+
+			  \param io the stream to read from
+			  \param dest where to put frames * io.inPorts() samples, as for BlockingAudioIO::readBlock
+			  \param frames the number of frames to read
+			  \param completion called through the executor when the frames have been read
+			  \param arg passed to completion
+			  \throw std::runtime_error if the stream has no inputs
+			  */
+			void readFrames(BlockingAudioIO& io, jack_default_audio_sample_t * dest,
+					unsigned int frames, completion_t completion, void * arg)
+				JACKCPP_THROW(std::runtime_error);
+			/**
+			  @brief Write interleaved frames to every output of a stream
+
+			  Like readFrames, src holds frames * io.outPorts() samples.
+			  \throw std::runtime_error if the stream has no outputs
+			  */
+			void writeFrames(BlockingAudioIO& io, const jack_default_audio_sample_t * src,
+					unsigned int frames, completion_t completion, void * arg)
+				JACKCPP_THROW(std::runtime_error);
+
+			/**
+			  @brief Complete every pending operation on a stream as cancelled
+
+			  Blocks until the reactor's thread no longer uses the stream.  Don't
+			  call this from a completion running on the reactor's thread.
+			  */
+			void cancel(BlockingAudioIO& io);
+			///Get the number of operations that have not completed
+			unsigned int pending() const { return mPending; }
+		private:
+			//not copyable
+			StreamReactor(const StreamReactor&);
+			StreamReactor& operator=(const StreamReactor&);
+
+			struct request_t {
+				BlockingAudioIO * io;
+				jack_default_audio_sample_t * dest;
+				const jack_default_audio_sample_t * src;
+				unsigned int frames;
+				unsigned int done;
+				completion_t completion;
+				void * arg;
+			};
+
+			void submit(request_t * request);
+			//post a request's completion and forget about it
+			void complete(request_t * request);
+			//move as many frames as we can without waiting, true when finished
+			bool transfer(request_t * request);
+			static void runCompletion(void * arg);
+			static void * run(void * arg);
+			void loop();
+
+			Executor * mExecutor;
+			InlineExecutor mInline;
+			pthread_t mThread;
+			pthread_mutex_t mMutex;
+			pthread_cond_t mCancelled;
+			Notifier mWake;
+			//requests handed to the thread, and the streams waiting to be cancelled
+			std::vector<request_t *> mSubmitted;
+			std::vector<BlockingAudioIO *> mCancelling;
+			bool mStopping;
+			//only touched by the reactor's thread
+			std::list<request_t *> mActive;
+			volatile unsigned int mPending;
+	};
+}
+
+#endif
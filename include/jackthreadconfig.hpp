@@ -0,0 +1,93 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef JACK_THREAD_CONFIG_HPP
+#define JACK_THREAD_CONFIG_HPP
+
+#include <stddef.h>
+#include <vector>
+
+namespace JackCpp {
+
+/**
+@struct ThreadConfig
+
+@brief How to set up the jack process thread when it starts.
+
+AudioIO applies this from jack's thread init callback, see
+AudioIO::setThreadConfig.  The defaults leave everything alone.
+
+@author Alex Norman
+
+*/
+	struct ThreadConfig {
+		///What to do about denormal floats
+		enum denormal_t {denormalsUnchanged, flushDenormals};
+		///Whether to lock the process's memory
+		enum mlock_t {mlockUnchanged, mlockCurrent, mlockCurrentAndFuture};
+
+		ThreadConfig() : denormals(denormalsUnchanged), stackPrefault(0), mlock(mlockUnchanged) {}
+
+		///The cpus the thread may run on, empty leaves the affinity alone
+		std::vector<int> cpus;
+		///flushDenormals sets flush to zero and denormals are zero
+		denormal_t denormals;
+		///The number of bytes of stack to touch so that the callback doesn't fault it in
+		size_t stackPrefault;
+		///Lock the memory of the whole process with mlockall
+		mlock_t mlock;
+	};
+
+/**
+@struct ThreadStatus
+
+@brief What was actually done when a ThreadConfig was applied.
+
+@author Alex Norman
+
+*/
+	struct ThreadStatus {
+		ThreadStatus() : applied(false), affinitySet(false), denormalsFlushed(false),
+			stackPrefaulted(0), memoryLocked(false), error(0) {}
+
+		///false until the config has been applied
+		bool applied;
+		///true if the thread was pinned to the requested cpus
+		bool affinitySet;
+		///true if denormals were being flushed when we were done
+		bool denormalsFlushed;
+		///the number of bytes of stack that were touched
+		size_t stackPrefaulted;
+		///true if mlockall succeeded
+		bool memoryLocked;
+		///the errno of the last thing that failed, 0 if nothing did
+		int error;
+	};
+
+	/**
+	  @brief Apply a config to the calling thread
+	  \return what was done
+	  */
+	ThreadStatus applyThreadConfig(const ThreadConfig& config);
+	///Turn flush to zero and denormals are zero on or off for the calling thread
+	void setDenormalFlushing(bool flush);
+	///See if the calling thread flushes denormals to zero, false where we can't tell
+	bool denormalsFlushed();
+}
+
+#endif
+
@@ -0,0 +1,145 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JACK_TRANSPORT_HPP
+#define JACK_TRANSPORT_HPP
+
+extern "C" {
+#include <jack/jack.h>
+#include <jack/types.h>
+#include <jack/transport.h>
+}
+
+namespace JackCpp {
+
+/**
+@class TransportInfo
+
+@brief A snapshot of the jack transport taken at the start of a process cycle.
+
+AudioIO queries the transport once per cycle and keeps the result in one of
+these, so code in audioCallback can look at the transport without querying
+jack again.
+
+@author Alex Norman
+
+*/
+	struct TransportInfo {
+		TransportInfo();
+		///Fill this in from the results of jack_transport_query
+		void set(jack_transport_state_t transportState, const jack_position_t& pos);
+
+		///Is the transport rolling?
+		bool rolling() const { return state == JackTransportRolling; }
+		///Get the number of frames in one beat, 0 if there is no BBT information
+		double framesPerBeat() const;
+		/**
+		  @brief Get the position of frame, in beats since bar 1 beat 1
+
+		  This assumes the meter hasn't changed since the start of the song.
+		  \return the position in beats, 0 if there is no BBT information
+		  */
+		double beatPosition() const;
+
+		///The transport state
+		jack_transport_state_t state;
+		///The transport frame at the start of the cycle
+		jack_nframes_t frame;
+		///The sample rate
+		jack_nframes_t frameRate;
+		///The time in microseconds that the position was computed for
+		jack_time_t usecs;
+
+		///Whether the BBT fields below are valid
+		bool hasBBT;
+		///The current bar, starting at 1
+		int32_t bar;
+		///The current beat within the bar, starting at 1
+		int32_t beat;
+		///The current tick within the beat, starting at 0
+		int32_t tick;
+		///The number of ticks in the song before this bar
+		double barStartTick;
+		///The time signature numerator
+		float beatsPerBar;
+		///The time signature denominator
+		float beatType;
+		///The number of ticks in a beat
+		double ticksPerBeat;
+		///The tempo
+		double beatsPerMinute;
+		///The BBT fields describe frame + bbtOffset rather than frame
+		jack_nframes_t bbtOffset;
+	};
+
+/**
+@class BeatGrid
+
+@brief Finds the exact frames within a cycle where beats and their subdivisions fall.
+
+Given the transport snapshot for a cycle, this computes the frame offsets of
+every grid line in the cycle, so tempo synced processing can trigger on the
+exact sample without querying the transport itself.
+
+@author Alex Norman
+
+*/
+	class BeatGrid {
+		public:
+			///One line of the grid that falls within a cycle
+			struct event_t {
+				///The frame within the cycle
+				jack_nframes_t offset;
+				///The bar, starting at 1
+				int32_t bar;
+				///The beat within the bar, starting at 1
+				int32_t beat;
+				///The subdivision within the beat, starting at 0
+				unsigned int division;
+			};
+
+			/**
+			  @brief The Constructor
+			  \param divisions the number of grid lines per beat, 1 gives just beats, 4 gives sixteenths in 4/4
+			  */
+			BeatGrid(unsigned int divisions = 1);
+			///Set the number of grid lines per beat
+			void setDivisions(unsigned int divisions);
+			///Get the number of grid lines per beat
+			unsigned int divisions() const { return mDivisions; }
+
+			/**
+			  @brief Find the grid lines in a cycle
+
+			  Nothing is found unless the transport is rolling and has BBT information.
+
+			  \param transport the transport snapshot for the cycle
+			  \param nframes the number of frames in the cycle
+			  \param events an array to fill with the grid lines found
+			  \param maxEvents the size of events
+			  \return the number of grid lines written to events
+			  */
+			unsigned int find(const TransportInfo& transport, jack_nframes_t nframes,
+					event_t * events, unsigned int maxEvents) const;
+		private:
+			unsigned int mDivisions;
+	};
+}
+
+#endif
+
@@ -22,6 +22,7 @@
 #include <sstream>
 #include <algorithm>
 #include <unistd.h>
+#include <string.h>
 
 template <typename T>
 std::string ToString(T aValue){
@@ -40,16 +41,183 @@ static void shutdown_callback (void *arg) {
 	return ((JackCpp::AudioIO *)arg)->jackShutdownCallback();
 }
 
+static int bufsize_callback (jack_nframes_t nframes, void *arg) {
+	return ((JackCpp::AudioIO *)arg)->jackBufferSizeCallback(nframes);
+}
+
+static int srate_callback (jack_nframes_t nframes, void *arg) {
+	return ((JackCpp::AudioIO *)arg)->jackSampleRateCallback(nframes);
+}
+
+static void freewheel_callback (int starting, void *arg) {
+	JackCpp::AudioIO * callbackjackobject = (JackCpp::AudioIO *)arg;
+	callbackjackobject->jackFreewheelCallback(starting != 0);
+}
+
+static void thread_init_callback (void *arg) {
+	((JackCpp::AudioIO *)arg)->jackThreadInitCallback();
+}
+
+void JackCpp::AudioIO::jackThreadInitCallback(){
+	mThreadStatus.write(applyThreadConfig(mThreadConfig));
+}
+
+void JackCpp::AudioIO::jackFreewheelCallback(bool starting){
+	mFreewheeling = starting;
+}
+
 void JackCpp::AudioIO::jackShutdownCallback(){
 	std::cerr << std::endl << "jack has shutdown" << std::endl;
 }
 
+static JackCpp::GraphEvent graph_event (JackCpp::GraphEvent::type_t type,
+		jack_port_id_t port = 0, jack_port_id_t other = 0) {
+	JackCpp::GraphEvent event;
+	event.type = type;
+	event.usecs = jack_get_time();
+	event.port = port;
+	event.otherPort = other;
+	event.client[0] = '\0';
+	return event;
+}
+
+static void port_registration_callback (jack_port_id_t port, int reg, void *arg) {
+	((JackCpp::AudioIO *)arg)->portRegistry().portRegistered(port, reg != 0);
+	((JackCpp::AudioIO *)arg)->jackGraphEventCallback(graph_event(
+				reg ? JackCpp::GraphEvent::portRegistered : JackCpp::GraphEvent::portUnregistered, port));
+}
+
+static void port_rename_callback (jack_port_id_t port, const char *old_name, const char *new_name, void *arg) {
+	((JackCpp::AudioIO *)arg)->portRegistry().portRenamed(port, old_name, new_name);
+	((JackCpp::AudioIO *)arg)->jackGraphEventCallback(graph_event(JackCpp::GraphEvent::portRenamed, port));
+}
+
+static void client_registration_callback (const char *name, int reg, void *arg) {
+	JackCpp::GraphEvent event = graph_event(
+			reg ? JackCpp::GraphEvent::clientRegistered : JackCpp::GraphEvent::clientUnregistered);
+	strncpy(event.client, name, JackCpp::GraphEvent::clientNameSize - 1);
+	event.client[JackCpp::GraphEvent::clientNameSize - 1] = '\0';
+	((JackCpp::AudioIO *)arg)->jackGraphEventCallback(event);
+}
+
+static void port_connect_callback (jack_port_id_t a, jack_port_id_t b, int connect, void *arg) {
+	((JackCpp::AudioIO *)arg)->jackGraphEventCallback(graph_event(
+				connect ? JackCpp::GraphEvent::portsConnected : JackCpp::GraphEvent::portsDisconnected, a, b));
+}
+
+static int graph_order_callback (void *arg) {
+	((JackCpp::AudioIO *)arg)->jackGraphEventCallback(graph_event(JackCpp::GraphEvent::graphReordered));
+	return 0;
+}
+
+static int xrun_callback (void *arg) {
+	((JackCpp::AudioIO *)arg)->jackGraphEventCallback(graph_event(JackCpp::GraphEvent::xrun));
+	return 0;
+}
+
+void JackCpp::AudioIO::jackGraphEventCallback(const GraphEvent& event){
+	if(mGraphEvents.getWriteSpace() == 0){
+		mDroppedGraphEvents++;
+	} else
+		mGraphEvents.write(event);
+	//wake the reader either way so it can catch up
+	mGraphNotifier.notify();
+}
+
+bool JackCpp::AudioIO::getGraphEvent(GraphEvent& event){
+	if(mGraphEvents.getReadSpace() == 0)
+		return false;
+	mGraphEvents.read(event);
+	return true;
+}
+
+bool JackCpp::AudioIO::waitGraphEvent(GraphEvent& event, int timeoutMs){
+	//the notifier remembers notifications, so an event that arrives between
+	//the check and the wait still wakes us up
+	while(!getGraphEvent(event)){
+		if(!mGraphNotifier.wait(timeoutMs))
+			return false;
+	}
+	return true;
+}
+
+int JackCpp::AudioIO::graphEventFd(){
+	return mGraphNotifier.fd();
+}
+
+unsigned int JackCpp::AudioIO::droppedGraphEvents(){
+	return mDroppedGraphEvents;
+}
+
+static void latency_callback (jack_latency_callback_mode_t mode, void *arg) {
+	return ((JackCpp::AudioIO *)arg)->jackLatencyCallback(mode);
+}
+
+static void timebase_callback (jack_transport_state_t state, jack_nframes_t nframes,
+		jack_position_t *pos, int new_pos, void *arg) {
+	return ((JackCpp::AudioIO *)arg)->jackTimebaseCallback(state, nframes, pos, new_pos != 0);
+}
+
+//hand a rebuilt object to the callback, or swap it in at once if the callback
+//isn't running, returns false, having deleted next, if too many are waiting
+template<typename Type>
+static bool hand_over(JackCpp::RTSwap<Type>& swap, Type * next, bool active){
+	if(!active){
+		swap.reset(next);
+		return true;
+	}
+	if(swap.publish(next))
+		return true;
+	delete next;
+	return false;
+}
+
+int JackCpp::AudioIO::jackBufferSizeCallback(jack_nframes_t nframes){
+	bool ok = true;
+	if(mLatencyCompensation)
+		ok = hand_over(mLatencyComp, createLatencyComp(mCompDelays, nframes), mCallbacksLive) && ok;
+	if(mArenaBlocks > 0 || mArenaExtraBytes > 0)
+		ok = hand_over(mArena, createArena(nframes), mCallbacksLive) && ok;
+	if(!mInBusDefs.empty() || !mOutBusDefs.empty())
+		ok = hand_over(mBuses, createBuses(nframes), mCallbacksLive) && ok;
+	//the callback would carry on with state sized for the old buffer
+	return ok ? 0 : 1;
+}
+
+int JackCpp::AudioIO::jackSampleRateCallback(jack_nframes_t rate){
+	//the ballistics depend on the sample rate
+	bool ok = true;
+	if(mMetering){
+		pthread_rwlock_wrlock(&mMeterLock);
+		ok = updateMeters(rate);
+		pthread_rwlock_unlock(&mMeterLock);
+	}
+	return ok ? 0 : 1;
+}
+
 int JackCpp::AudioIO::jackProcessCallback(jack_nframes_t nframes, void *arg){
 	JackCpp::AudioIO* callbackjackobject = (AudioIO * )arg;
 	return callbackjackobject->jackToClassAudioCallback(nframes);
 }
 
+int JackCpp::AudioIO::audioCallback(jack_nframes_t nframes,
+		audioBufVector /* inBufs */,
+		audioBufVector outBufs){
+	for(unsigned int i = 0; i < outBufs.size(); i++)
+		memset(outBufs[i], 0, nframes * sizeof(jack_default_audio_sample_t));
+	return 0;
+}
+
+int JackCpp::AudioIO::processAudio(jack_nframes_t nframes,
+		const audioBufVector& inBufs,
+		const audioBufVector& outBufs){
+	return audioCallback(nframes, inBufs, outBufs);
+}
+
 int JackCpp::AudioIO::jackToClassAudioCallback(jack_nframes_t nframes){
+	//lets the realtime checker know that we're in the process thread, if it is built
+	RTChecker::Scope rtScope;
+
 	//read in commands
 	while(mCmdBuffer.getReadSpace() > 0){
 		cmd_t cmd;
@@ -70,13 +238,100 @@ int JackCpp::AudioIO::jackToClassAudioCallback(jack_nframes_t nframes){
 		}
 	}
 
+	RTArena * arena = startCycle();
+
 	//get the input and output buffers
 	for(unsigned int i = 0; i < mNumInputPorts; i++)
 		mJackInBuf[i] = (jack_default_audio_sample_t *) jack_port_get_buffer ( mInputPorts[i], nframes);
 	for(unsigned int i = 0; i < mNumOutputPorts; i++)
 		mJackOutBuf[i] = (jack_default_audio_sample_t *) jack_port_get_buffer ( mOutputPorts[i], nframes);
 
-	return audioCallback(nframes, mJackInBuf, mJackOutBuf);
+	latency_comp_t * comp = mLatencyComp.acquire();
+	if(comp != NULL)
+		compensateLatency(comp, nframes);
+
+	applyBuses(nframes, mNumInputPorts ? &mJackInBuf[0] : NULL, mNumInputPorts,
+			mNumOutputPorts ? &mJackOutBuf[0] : NULL, mNumOutputPorts);
+
+	int ret = processAudio(nframes, mJackInBuf, mJackOutBuf);
+	scatterBuses();
+	finishCycle(arena);
+	meterBuffers(nframes, mNumInputPorts ? &mJackInBuf[0] : NULL, mNumInputPorts,
+			mNumOutputPorts ? &mJackOutBuf[0] : NULL, mNumOutputPorts);
+	renderOutputs(nframes, mNumOutputPorts ? &mJackOutBuf[0] : NULL, mNumOutputPorts);
+	return ret;
+}
+
+JackCpp::RTArena * JackCpp::AudioIO::startCycle(){
+	//take a snapshot of the transport for this cycle
+	jack_position_t pos;
+	jack_transport_state_t state = jack_transport_query(mJackClient, &pos);
+	mTransport.set(state, pos);
+	mTransportShared.write(mTransport);
+
+	//the clock can't be fed while freewheeling, the frame times run ahead of
+	//the system clock, it restarts when we're back in realtime
+	if(!mFreewheeling && jack_get_cycle_times(mJackClient, &mCycleTimes.frames,
+				&mCycleTimes.usecs, &mCycleTimes.nextUsecs, &mCycleTimes.periodUsecs) == 0)
+		mClock.update(mCycleTimes, jack_get_buffer_size(mJackClient), jack_get_sample_rate(mJackClient));
+	else
+		mCycleTimes.frames = jack_last_frame_time(mJackClient);
+
+	//start timing a freewheel run on its first cycle
+	if(mFreewheeling && !mFreewheelState.running && !mFreewheelState.finished){
+		mFreewheelState.running = true;
+		mFreewheelState.rendering = mRenderSink != NULL;
+		mFreewheelState.frames = 0;
+		mFreewheelState.startUsecs = mFreewheelState.lastUsecs = jack_get_time();
+		mFreewheelShared.write(mFreewheelState);
+	}
+
+	RTArena * arena = mArena.acquire();
+	if(arena != NULL){
+		arena->reset();
+		mArenaFailuresAtStart = arena->failures();
+	}
+	return arena;
+}
+
+void JackCpp::AudioIO::finishCycle(RTArena * arena){
+	if(arena == NULL)
+		return;
+	if(arena->highWater() > mArenaHighWater)
+		mArenaHighWater = arena->highWater();
+	mArenaFailures += arena->failures() - mArenaFailuresAtStart;
+}
+
+void JackCpp::AudioIO::renderOutputs(jack_nframes_t nframes,
+		jack_default_audio_sample_t * const * outBufs, unsigned int channels){
+	bool freewheeling = mFreewheeling;
+	RenderSink * sink = mRenderSink;
+	//a sink may block while freewheeling, so it counts as part of the run
+	if(sink != NULL)
+		sink->renderFrames(outBufs, channels, nframes, freewheeling);
+	__sync_fetch_and_add(&mRenderCycles, 1);
+
+	if(mFreewheelState.running){
+		//a render's run ends with the last cycle that went to the sink, so the
+		//stats match what was rendered
+		if(freewheeling && (sink != NULL || !mFreewheelState.rendering)){
+			mFreewheelState.frames += nframes;
+			mFreewheelState.lastUsecs = jack_get_time();
+		} else {
+			mFreewheelState.running = false;
+			mFreewheelState.finished = freewheeling;
+		}
+		mFreewheelShared.write(mFreewheelState);
+	} else if(!freewheeling)
+		mFreewheelState.finished = false;
+}
+
+void JackCpp::AudioIO::meterBuffers(jack_nframes_t nframes,
+		jack_default_audio_sample_t * const * inBufs, unsigned int inCount,
+		jack_default_audio_sample_t * const * outBufs, unsigned int outCount){
+	MeterBank * meters = mMeters.acquire();
+	if(meters != NULL)
+		meters->process(nframes, inBufs, inCount, outBufs, outCount);
 }
 
 jack_client_t * JackCpp::AudioIO::client(){
@@ -84,17 +339,49 @@ jack_client_t * JackCpp::AudioIO::client(){
 }
 
 JackCpp::AudioIO::AudioIO(std::string name, unsigned int inPorts, unsigned int outPorts, bool startServer) 
-	throw(std::runtime_error) : mCmdBuffer(256,true)
+	JACKCPP_THROW(std::runtime_error) : mCmdBuffer(256,true),
+	mCallbacksLive(false),
+	mLatencyCompensation(false), mMaxCompensationDelay(0),
+	mTempoBuffer(16,true),
+	mArenaBlocks(0), mArenaExtraBytes(0),
+	mArenaCapacity(0), mArenaHighWater(0), mArenaFailures(0), mArenaFailuresAtStart(0),
+	mGraphEvents(256), mDroppedGraphEvents(0),
+	mFreewheeling(false), mRenderSink(NULL), mRenderCycles(0), mRenderFreewheel(false),
+	mMetering(false), mCycleBuses(NULL)
 {
+	memset(&mCycleTimes, 0, sizeof(mCycleTimes));
+	memset(&mFreewheelState, 0, sizeof(mFreewheelState));
+	pthread_rwlock_init(&mMeterLock, NULL);
+	mProcessingLatency.min = mProcessingLatency.max = 0;
+	mTempo.beatsPerMinute = 120.0;
+	mTempo.beatsPerBar = 4.0f;
+	mTempo.beatType = 4.0f;
+	mTempo.ticksPerBeat = 1920.0;
   createClient(name, inPorts, outPorts, startServer);
 }
 
-JackCpp::AudioIO::AudioIO() : mCmdBuffer(256,true), mJackClient(NULL)
+JackCpp::AudioIO::AudioIO() : mCmdBuffer(256,true), mJackClient(NULL), mJackState(closed),
+	mCallbacksLive(false),
+	mLatencyCompensation(false), mMaxCompensationDelay(0),
+	mTempoBuffer(16,true),
+	mArenaBlocks(0), mArenaExtraBytes(0),
+	mArenaCapacity(0), mArenaHighWater(0), mArenaFailures(0), mArenaFailuresAtStart(0),
+	mGraphEvents(256), mDroppedGraphEvents(0),
+	mFreewheeling(false), mRenderSink(NULL), mRenderCycles(0), mRenderFreewheel(false),
+	mMetering(false), mCycleBuses(NULL)
 {
+	memset(&mCycleTimes, 0, sizeof(mCycleTimes));
+	memset(&mFreewheelState, 0, sizeof(mFreewheelState));
+	pthread_rwlock_init(&mMeterLock, NULL);
+	mProcessingLatency.min = mProcessingLatency.max = 0;
+	mTempo.beatsPerMinute = 120.0;
+	mTempo.beatsPerBar = 4.0f;
+	mTempo.beatType = 4.0f;
+	mTempo.ticksPerBeat = 1920.0;
 }
 
 void JackCpp::AudioIO::createClient(std::string name, unsigned int inPorts, unsigned int outPorts, bool startServer) 
-	throw(std::runtime_error) 
+	JACKCPP_THROW(std::runtime_error) 
 {
   if (mJackClient) {
     //XXX close it
@@ -124,6 +411,37 @@ void JackCpp::AudioIO::createClient(std::string name, unsigned int inPorts, unsi
 	//set the shutdown callback
 	jack_on_shutdown (mJackClient, shutdown_callback, this);
 
+	//set up the process thread when it starts
+	if(0 != jack_set_thread_init_callback (mJackClient, thread_init_callback, this))
+		throw std::runtime_error("cannot register thread init callback");
+
+	//find out about buffer size and sample rate changes
+	if(0 != jack_set_buffer_size_callback (mJackClient, bufsize_callback, this))
+		throw std::runtime_error("cannot register buffer size callback");
+	if(0 != jack_set_sample_rate_callback (mJackClient, srate_callback, this))
+		throw std::runtime_error("cannot register sample rate callback");
+	if(0 != jack_set_latency_callback (mJackClient, latency_callback, this))
+		throw std::runtime_error("cannot register latency callback");
+	if(0 != jack_set_freewheel_callback (mJackClient, freewheel_callback, this))
+		throw std::runtime_error("cannot register freewheel callback");
+
+	//keep our port cache up to date, fill it after registering so we don't miss anything
+	if(0 != jack_set_port_registration_callback (mJackClient, port_registration_callback, this))
+		throw std::runtime_error("cannot register port registration callback");
+	if(0 != jack_set_port_rename_callback (mJackClient, port_rename_callback, this))
+		throw std::runtime_error("cannot register port rename callback");
+	mPortRegistry.init(mJackClient);
+
+	//tell the user about the rest of the graph changes
+	if(0 != jack_set_client_registration_callback (mJackClient, client_registration_callback, this))
+		throw std::runtime_error("cannot register client registration callback");
+	if(0 != jack_set_port_connect_callback (mJackClient, port_connect_callback, this))
+		throw std::runtime_error("cannot register port connect callback");
+	if(0 != jack_set_graph_order_callback (mJackClient, graph_order_callback, this))
+		throw std::runtime_error("cannot register graph order callback");
+	if(0 != jack_set_xrun_callback (mJackClient, xrun_callback, this))
+		throw std::runtime_error("cannot register xrun callback");
+
 	//allocate ports
 	if (inPorts > 0){
 		for(unsigned int i = 0; i < inPorts; i++){
@@ -131,7 +449,7 @@ void JackCpp::AudioIO::createClient(std::string name, unsigned int inPorts, unsi
 			portname.append(ToString(i));
 			mInputPorts.push_back(
 					jack_port_register (mJackClient, portname.c_str(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0));
-			mPortNames.push_back(portname);
+			mPortNames.insert(portname);
 		}
 		//reserve the data for the jack callback buffers
 		for(unsigned int i = 0; i < mInputPorts.size(); i++)
@@ -143,12 +461,16 @@ void JackCpp::AudioIO::createClient(std::string name, unsigned int inPorts, unsi
 			portname.append(ToString(i));
 			mOutputPorts.push_back(
 					jack_port_register (mJackClient, portname.c_str(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0));
-			mPortNames.push_back(portname);
+			mPortNames.insert(portname);
 		}
 		//reserve the data for the jack callback buffers
 		for(unsigned int i = 0; i < mOutputPorts.size(); i++)
 			mJackOutBuf.push_back(NULL);
-	} 
+	}
+	//start updates these too, but keep them valid for a callback that is
+	//called directly, as the benchmarks do
+	mNumInputPorts = mInputPorts.size();
+	mNumOutputPorts = mOutputPorts.size(); 
 
 	//set up the callback
 	if(0 != jack_set_process_callback (mJackClient, JackCpp::AudioIO::jackProcessCallback, this))
@@ -169,20 +491,16 @@ JackCpp::AudioIO::~AudioIO(){
 			break;
 			//do nothing
 	}
+	pthread_rwlock_destroy(&mMeterLock);
 }
 
 bool JackCpp::AudioIO::portExists(std::string name){
 	//see if the port name exists
-	std::vector<std::string>::iterator it;
-	it = std::find(mPortNames.begin(),mPortNames.end(), name);
-	if (it != mPortNames.end())
-		return true;
-	else
-		return false;
+	return mPortNames.find(name) != mPortNames.end();
 }
 
 void JackCpp::AudioIO::reserveOutPorts(unsigned int num)
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	if(getState() == active)
 		throw std::runtime_error("reserving ports while the client is running is not supported yet.");
@@ -191,7 +509,7 @@ void JackCpp::AudioIO::reserveOutPorts(unsigned int num)
 }
 
 void JackCpp::AudioIO::reserveInPorts(unsigned int num)
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	if(getState() == active)
 		throw std::runtime_error("reserving ports while the client is running is not supported yet.");
@@ -208,7 +526,7 @@ unsigned int JackCpp::AudioIO::outPorts(){
 }
 
 unsigned int JackCpp::AudioIO::addInPort(std::string name)
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	if (mJackState == active && mInputPorts.size() == mInputPorts.capacity())
 		throw std::runtime_error("trying to add input ports while the client is running and there are not reserved ports");
@@ -228,15 +546,17 @@ unsigned int JackCpp::AudioIO::addInPort(std::string name)
 		throw std::runtime_error(ret_string);
 	}
 	mInputPorts.push_back(newPort);
-	mPortNames.push_back(name);
+	mPortNames.insert(name);
 
 	//if we're active then send a command indicating this change
 	if (mJackState == active) {
 		//loop while there isn't space to write
 		while(mCmdBuffer.getWriteSpace() == 0);
 		mCmdBuffer.write(add_in_port);
-	} else 
+	} else {
 		mJackInBuf.push_back(NULL);
+		mNumInputPorts = mInputPorts.size();
+	}
 
 	return mInputPorts.size() - 1;
 }
@@ -244,7 +564,7 @@ unsigned int JackCpp::AudioIO::addInPort(std::string name)
 //add an output port, if we are active then deactivate and reactivate after
 //maybe we can do this more intelligently in the future?
 unsigned int JackCpp::AudioIO::addOutPort(std::string name)
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	if (mJackState == active && mOutputPorts.size() == mOutputPorts.capacity())
 		throw std::runtime_error("trying to add output ports while the client is running and there are not reserved ports");
@@ -264,21 +584,23 @@ unsigned int JackCpp::AudioIO::addOutPort(std::string name)
 		throw std::runtime_error(ret_string);
 	}
 	mOutputPorts.push_back(newPort);
-	mPortNames.push_back(name);
+	mPortNames.insert(name);
 
 	//if we're active then send a command indicating this change
 	if (mJackState == active) {
 		//loop while there isn't space to write
 		while(mCmdBuffer.getWriteSpace() == 0);
 		mCmdBuffer.write(add_out_port);
-	} else
+	} else {
 		mJackOutBuf.push_back(NULL);
+		mNumOutputPorts = mOutputPorts.size();
+	}
 
 	return mOutputPorts.size() - 1;
 }
 
 void JackCpp::AudioIO::connectTo(unsigned int index, std::string destPortName)
-	throw(std::range_error, std::runtime_error)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
 {
 	int connect_ret;
 	if (mJackState != active)
@@ -298,7 +620,7 @@ void JackCpp::AudioIO::connectTo(unsigned int index, std::string destPortName)
 }
 
 void JackCpp::AudioIO::connectFrom(unsigned int index, std::string sourcePortName)
-	throw(std::range_error, std::runtime_error)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
 {
 	int connect_ret;
 	if (mJackState != active)
@@ -317,56 +639,67 @@ void JackCpp::AudioIO::connectFrom(unsigned int index, std::string sourcePortNam
 		throw std::range_error("inport index out of range");
 }
 
-//XXX should the "free" free the names that these ports point too as well?
 void JackCpp::AudioIO::connectToPhysical(unsigned int index, unsigned physical_index)
-	throw(std::range_error, std::runtime_error)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
 {
-	const char **ports;
 	if (mJackState != active)
 		throw std::runtime_error("client must be active before connecting ports");
 	if (index > mOutputPorts.size())
 		throw std::range_error("outport index out of range");
-	ports = jack_get_ports (mJackClient, NULL, NULL, JackPortIsPhysical|JackPortIsInput);
-	if(ports == NULL){
+	if (mPortRegistry.numPhysicalDestinations() == 0)
 		throw std::range_error("no physical inports to connect to");
-	}
-	//make sure the port exists
-	for(unsigned int i = 0; i <= physical_index; i++){
-		if(ports[i] == NULL){
-			free(ports);
-			throw std::range_error("physical inport index out of range");
-		}
-	}
-	connectTo(index, ports[physical_index]);
-	free(ports);
+	connectTo(index, mPortRegistry.physicalDestination(physical_index));
 }
 
-//XXX should the "free" free the names that these ports point too as well?
 void JackCpp::AudioIO::connectFromPhysical(unsigned int index, unsigned physical_index)
-	throw(std::range_error, std::runtime_error)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
 {
-	const char **ports;
 	if (mJackState != active)
 		throw std::runtime_error("client must be active before connecting ports");
 	if (index > mInputPorts.size())
 		throw std::range_error("inport index out of range");
-	ports = jack_get_ports (mJackClient, NULL, NULL, JackPortIsPhysical|JackPortIsOutput);
-	if(ports == NULL){
+	if (mPortRegistry.numPhysicalSources() == 0)
 		throw std::range_error("no physical outports to connect to");
+	connectFrom(index, mPortRegistry.physicalSource(physical_index));
+}
+
+JackCpp::ConnectionJob * JackCpp::AudioIO::applyConnections(const ConnectionSet& set, bool exclusive,
+		ConnectionJob::callback_t callback, void * arg)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if (mJackState != active)
+		throw std::runtime_error("client must be active before connecting ports");
+	std::vector<std::string> ownPorts;
+	for(unsigned int i = 0; i < mInputPorts.size(); i++)
+		ownPorts.push_back(jack_port_name(mInputPorts[i]));
+	for(unsigned int i = 0; i < mOutputPorts.size(); i++)
+		ownPorts.push_back(jack_port_name(mOutputPorts[i]));
+	return new ConnectionJob(mJackClient, mPortRegistry, set, ownPorts, exclusive, callback, arg);
+}
+
+JackCpp::ConnectionSet JackCpp::AudioIO::getConnections(){
+	ConnectionSet set;
+	for(unsigned int i = 0; i < mOutputPorts.size(); i++){
+		const char ** connections = jack_port_get_all_connections(mJackClient, mOutputPorts[i]);
+		if(connections == NULL)
+			continue;
+		for(unsigned int j = 0; connections[j] != NULL; j++)
+			set.add(jack_port_name(mOutputPorts[i]), connections[j]);
+		free(connections);
 	}
-	//make sure the port exists
-	for(unsigned int i = 0; i <= physical_index; i++){
-		if(ports[i] == NULL){
-			free(ports);
-			throw std::range_error("physical outport index out of range");
-		}
+	for(unsigned int i = 0; i < mInputPorts.size(); i++){
+		const char ** connections = jack_port_get_all_connections(mJackClient, mInputPorts[i]);
+		if(connections == NULL)
+			continue;
+		for(unsigned int j = 0; connections[j] != NULL; j++)
+			set.add(connections[j], jack_port_name(mInputPorts[i]));
+		free(connections);
 	}
-	connectFrom(index, ports[physical_index]);
-	free(ports);
+	return set;
 }
 
 void JackCpp::AudioIO::disconnectInPort(unsigned int index)
-	throw(std::range_error, std::runtime_error)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
 {
 	if (mJackState != active)
 		throw std::runtime_error("client must be active before disconnecting ports");
@@ -377,7 +710,7 @@ void JackCpp::AudioIO::disconnectInPort(unsigned int index)
 }
 
 void JackCpp::AudioIO::disconnectOutPort(unsigned int index)
-	throw(std::range_error, std::runtime_error)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
 {
 	if (mJackState != active)
 		throw std::runtime_error("client must be active before disconnecting ports");
@@ -388,7 +721,7 @@ void JackCpp::AudioIO::disconnectOutPort(unsigned int index)
 }
 
 unsigned int JackCpp::AudioIO::numConnectionsInPort(unsigned int index)
-	throw(std::range_error)
+	JACKCPP_THROW(std::range_error)
 {
 	if(index < mInputPorts.size())
 		return jack_port_connected(mInputPorts[index]);
@@ -397,7 +730,7 @@ unsigned int JackCpp::AudioIO::numConnectionsInPort(unsigned int index)
 }
 
 unsigned int JackCpp::AudioIO::numConnectionsOutPort(unsigned int index)
-	throw(std::range_error)
+	JACKCPP_THROW(std::range_error)
 {
 	if(index < mOutputPorts.size())
 		return jack_port_connected(mOutputPorts[index]);
@@ -406,34 +739,33 @@ unsigned int JackCpp::AudioIO::numConnectionsOutPort(unsigned int index)
 }
 
 unsigned int JackCpp::AudioIO::numPhysicalDestinationPorts(){
-	const char **ports;
-	unsigned int cnt = 0;
-	ports = jack_get_ports (mJackClient, NULL, NULL, JackPortIsPhysical|JackPortIsInput);
-	if (ports != NULL){
-		while(ports[cnt] != NULL)
-			cnt++;
-		free(ports);
-		return cnt;
-	} else
-		return 0;
+	return mPortRegistry.numPhysicalDestinations();
 }
 
 unsigned int JackCpp::AudioIO::numPhysicalSourcePorts(){
-	const char **ports;
-	unsigned int cnt = 0;
-	//XXX is this really correct? we should get the naming right...
-	ports = jack_get_ports (mJackClient, NULL, NULL, JackPortIsPhysical|JackPortIsOutput);
-	if (ports != NULL){
-		while(ports[cnt] != NULL)
-			cnt++;
-		free(ports);
-		return cnt;
-	} else
-		return 0;
+	return mPortRegistry.numPhysicalSources();
+}
+
+jack_port_t * JackCpp::AudioIO::getInputPort(unsigned int index)
+	JACKCPP_THROW(std::range_error)
+{
+	if(index < mInputPorts.size())
+		return mInputPorts[index];
+	else 
+		throw std::range_error("inport index out of range");
+}
+
+jack_port_t * JackCpp::AudioIO::getOutputPort(unsigned int index)
+	JACKCPP_THROW(std::range_error)
+{
+	if(index < mOutputPorts.size())
+		return mOutputPorts[index];
+	else 
+		throw std::range_error("outport index out of range");
 }
 
 std::string JackCpp::AudioIO::getInputPortName(unsigned int index)
-	throw(std::range_error)
+	JACKCPP_THROW(std::range_error)
 {
 	if(index < mInputPorts.size())
 		return std::string(jack_port_name(mInputPorts[index]));
@@ -442,7 +774,7 @@ std::string JackCpp::AudioIO::getInputPortName(unsigned int index)
 
 }
 std::string JackCpp::AudioIO::getOutputPortName(unsigned int index)
-	throw(std::range_error)
+	JACKCPP_THROW(std::range_error)
 {
 	if(index < mOutputPorts.size())
 		return std::string(jack_port_name(mOutputPorts[index]));
@@ -451,32 +783,47 @@ std::string JackCpp::AudioIO::getOutputPortName(unsigned int index)
 }
 
 void JackCpp::AudioIO::start()
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	//update these so that the callback can use them
 	if(mJackState != active){
 		mNumOutputPorts = mOutputPorts.size();
 		mNumInputPorts = mInputPorts.size();
+		//ports may have been added since metering was turned on
+		if(mMetering){
+			pthread_rwlock_wrlock(&mMeterLock);
+			updateMeters(getSampleRate());
+			pthread_rwlock_unlock(&mMeterLock);
+		}
 	}
-	if (jack_activate(mJackClient) != 0)
+	mCallbacksLive = true;
+	__sync_synchronize();
+	if (jack_activate(mJackClient) != 0){
+		mCallbacksLive = false;
 		throw std::runtime_error("cannot activate the client");
+	}
 	mJackState = active;
+	//jack only sends the registration callbacks to active clients, so
+	//anything registered while we were inactive was missed
+	mPortRegistry.init(mJackClient);
 }
 
 void JackCpp::AudioIO::stop()
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	if (jack_deactivate(mJackClient) != 0)
 		throw std::runtime_error("cannot deactivate the client");
 	mJackState = notActive;
+	mCallbacksLive = false;
 }
 
 void JackCpp::AudioIO::close()
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	if (jack_client_close(mJackClient) != 0)
 		throw std::runtime_error("cannot close the client");
 	mJackState = closed;
+	mPortRegistry.clear();
 }
 
 float JackCpp::AudioIO::getCpuLoad(){
@@ -491,3 +838,541 @@ jack_nframes_t JackCpp::AudioIO::getBufferSize(){
 	return jack_get_buffer_size(mJackClient);
 }
 
+jack_time_t JackCpp::AudioIO::framesToTime(jack_nframes_t frames){
+	if(mFreewheeling || !mClock.valid())
+		return jack_frames_to_time(mJackClient, frames);
+	return mClock.framesToTime(frames);
+}
+
+jack_nframes_t JackCpp::AudioIO::timeToFrames(jack_time_t usecs){
+	if(mFreewheeling || !mClock.valid())
+		return jack_time_to_frames(mJackClient, usecs);
+	return mClock.timeToFrames(usecs);
+}
+
+double JackCpp::AudioIO::getMeasuredSampleRate(){
+	if(!mClock.valid())
+		return getSampleRate();
+	return mClock.sampleRate();
+}
+
+void JackCpp::AudioIO::setFreewheel(bool onoff)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if (jack_set_freewheel(mJackClient, onoff ? 1 : 0) != 0)
+		throw std::runtime_error("cannot change freewheel mode");
+}
+
+JackCpp::AudioIO::freewheel_stats_t JackCpp::AudioIO::getFreewheelStats(){
+	freewheel_state_t state = mFreewheelShared.read();
+	freewheel_stats_t stats;
+	stats.running = state.running;
+	stats.frames = state.frames;
+	stats.seconds = (double)(state.lastUsecs - state.startUsecs) / 1000000.0;
+	stats.speedup = 0.0;
+	if(stats.seconds > 0.0)
+		stats.speedup = ((double)stats.frames / (double)getSampleRate()) / stats.seconds;
+	return stats;
+}
+
+void JackCpp::AudioIO::setMetering(bool enable, const MeterConfig& config)
+	JACKCPP_THROW(std::runtime_error)
+{
+	pthread_rwlock_wrlock(&mMeterLock);
+	const bool wasMetering = mMetering;
+	const MeterConfig oldConfig = mMeterConfig;
+	mMetering = enable;
+	mMeterConfig = config;
+	if(!updateMeters(getSampleRate())){
+		mMetering = wasMetering;
+		mMeterConfig = oldConfig;
+		pthread_rwlock_unlock(&mMeterLock);
+		throw std::runtime_error("too many meter updates waiting for the callback");
+	}
+	pthread_rwlock_unlock(&mMeterLock);
+}
+
+bool JackCpp::AudioIO::updateMeters(jack_nframes_t rate){
+	MeterBank * meters = NULL;
+	//reserved ports can be added while we're running, so they get meters too
+	if(mMetering)
+		meters = new MeterBank(std::max(mInputPorts.size(), mInputPorts.capacity()),
+				std::max(mOutputPorts.size(), mOutputPorts.capacity()),
+				mMeterConfig, rate);
+	//the callback adopts them at the start of its next cycle, this is called
+	//with the meter lock held, and from jack's thread, so it doesn't wait
+	return hand_over(mMeters, meters, mCallbacksLive);
+}
+
+JackCpp::MeterReading JackCpp::AudioIO::getInputMeter(unsigned int index)
+	JACKCPP_THROW(std::range_error)
+{
+	if(index >= mInputPorts.size())
+		throw std::range_error("inport index out of range");
+	MeterReading reading;
+	memset(&reading, 0, sizeof(reading));
+	pthread_rwlock_rdlock(&mMeterLock);
+	MeterBank * meters = mMeters.get();
+	if(meters != NULL && index < meters->inputs())
+		reading = meters->input(index).read();
+	pthread_rwlock_unlock(&mMeterLock);
+	return reading;
+}
+
+JackCpp::MeterReading JackCpp::AudioIO::getOutputMeter(unsigned int index)
+	JACKCPP_THROW(std::range_error)
+{
+	if(index >= mOutputPorts.size())
+		throw std::range_error("outport index out of range");
+	MeterReading reading;
+	memset(&reading, 0, sizeof(reading));
+	pthread_rwlock_rdlock(&mMeterLock);
+	MeterBank * meters = mMeters.get();
+	if(meters != NULL && index < meters->outputs())
+		reading = meters->output(index).read();
+	pthread_rwlock_unlock(&mMeterLock);
+	return reading;
+}
+
+void JackCpp::AudioIO::getMeters(std::vector<MeterReading>& inputs, std::vector<MeterReading>& outputs){
+	MeterReading zero;
+	memset(&zero, 0, sizeof(zero));
+	inputs.assign(mInputPorts.size(), zero);
+	outputs.assign(mOutputPorts.size(), zero);
+	pthread_rwlock_rdlock(&mMeterLock);
+	MeterBank * meters = mMeters.get();
+	if(meters != NULL){
+		for(unsigned int i = 0; i < inputs.size() && i < meters->inputs(); i++)
+			inputs[i] = meters->input(i).read();
+		for(unsigned int i = 0; i < outputs.size() && i < meters->outputs(); i++)
+			outputs[i] = meters->output(i).read();
+	}
+	pthread_rwlock_unlock(&mMeterLock);
+}
+
+void JackCpp::AudioIO::resetMeterHolds(){
+	pthread_rwlock_rdlock(&mMeterLock);
+	MeterBank * meters = mMeters.get();
+	if(meters != NULL)
+		meters->resetHolds();
+	pthread_rwlock_unlock(&mMeterLock);
+}
+
+void JackCpp::AudioIO::startRender(RenderSink * sink, bool freewheel)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(mRenderSink != NULL)
+		throw std::runtime_error("already rendering");
+	__sync_synchronize();
+	mRenderSink = sink;
+	if(freewheel){
+		try {
+			setFreewheel(true);
+		} catch (std::runtime_error&){
+			mRenderSink = NULL;
+			throw;
+		}
+	}
+	mRenderFreewheel = freewheel;
+}
+
+void JackCpp::AudioIO::stopRender()
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(mRenderSink == NULL)
+		return;
+	mRenderSink = NULL;
+	__sync_synchronize();
+	//a cycle that started before we cleared the sink may still be using it,
+	//wait until a cycle is done with it, we are still freewheeling so it's quick
+	unsigned int cycle = mRenderCycles;
+	while(mJackState == active && mRenderCycles == cycle)
+		usleep(1000);
+	if(mRenderFreewheel){
+		mRenderFreewheel = false;
+		setFreewheel(false);
+	}
+}
+
+
+//the union of the latency ranges of a set of ports
+static jack_latency_range_t latency_union(const std::vector<jack_port_t *>& ports,
+		jack_latency_callback_mode_t mode){
+	jack_latency_range_t range;
+	range.min = range.max = 0;
+	for(unsigned int i = 0; i < ports.size(); i++){
+		jack_latency_range_t r;
+		jack_port_get_latency_range(ports[i], mode, &r);
+		if(i == 0 || r.min < range.min)
+			range.min = r.min;
+		if(i == 0 || r.max > range.max)
+			range.max = r.max;
+	}
+	return range;
+}
+
+void JackCpp::AudioIO::jackLatencyCallback(jack_latency_callback_mode_t mode){
+	jack_latency_range_t range;
+	if(mode == JackCaptureLatency){
+		//our outputs carry what arrived at our inputs, plus what we add
+		range = latency_union(mInputPorts, JackCaptureLatency);
+		if(mLatencyCompensation)
+			range.min = range.max = updateLatencyComp();
+		range.min += mProcessingLatency.min;
+		range.max += mProcessingLatency.max;
+		for(unsigned int i = 0; i < mOutputPorts.size(); i++)
+			jack_port_set_latency_range(mOutputPorts[i], JackCaptureLatency, &range);
+	} else {
+		//our inputs will be played back as late as our outputs, plus what we add
+		range = latency_union(mOutputPorts, JackPlaybackLatency);
+		range.min += mProcessingLatency.min;
+		range.max += mProcessingLatency.max;
+		for(unsigned int i = 0; i < mInputPorts.size(); i++)
+			jack_port_set_latency_range(mInputPorts[i], JackPlaybackLatency, &range);
+	}
+}
+
+void JackCpp::AudioIO::setProcessingLatency(jack_nframes_t min, jack_nframes_t max, bool recompute)
+	JACKCPP_THROW(std::runtime_error)
+{
+	mProcessingLatency.min = min;
+	mProcessingLatency.max = (max < min) ? min : max;
+	if(recompute && mJackState == active)
+		recomputeLatencies();
+}
+
+void JackCpp::AudioIO::recomputeLatencies()
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(jack_recompute_total_latencies(mJackClient) != 0)
+		throw std::runtime_error("cannot recompute latencies");
+}
+
+jack_latency_range_t JackCpp::AudioIO::getInPortLatencyRange(unsigned int index,
+		jack_latency_callback_mode_t mode)
+	JACKCPP_THROW(std::range_error)
+{
+	jack_latency_range_t range;
+	if(index < mInputPorts.size())
+		jack_port_get_latency_range(mInputPorts[index], mode, &range);
+	else 
+		throw std::range_error("inport index out of range");
+	return range;
+}
+
+jack_latency_range_t JackCpp::AudioIO::getOutPortLatencyRange(unsigned int index,
+		jack_latency_callback_mode_t mode)
+	JACKCPP_THROW(std::range_error)
+{
+	jack_latency_range_t range;
+	if(index < mOutputPorts.size())
+		jack_port_get_latency_range(mOutputPorts[index], mode, &range);
+	else 
+		throw std::range_error("outport index out of range");
+	return range;
+}
+
+void JackCpp::AudioIO::setInPortLatencyRange(unsigned int index,
+		jack_latency_callback_mode_t mode, jack_latency_range_t range)
+	JACKCPP_THROW(std::range_error)
+{
+	if(index < mInputPorts.size())
+		jack_port_set_latency_range(mInputPorts[index], mode, &range);
+	else 
+		throw std::range_error("inport index out of range");
+}
+
+void JackCpp::AudioIO::setOutPortLatencyRange(unsigned int index,
+		jack_latency_callback_mode_t mode, jack_latency_range_t range)
+	JACKCPP_THROW(std::range_error)
+{
+	if(index < mOutputPorts.size())
+		jack_port_set_latency_range(mOutputPorts[index], mode, &range);
+	else 
+		throw std::range_error("outport index out of range");
+}
+
+void JackCpp::AudioIO::setThreadConfig(const ThreadConfig& config)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(mJackState == active)
+		throw std::runtime_error("the thread config must be set before the client is started");
+	mThreadConfig = config;
+}
+
+void JackCpp::AudioIO::setRTArenaSize(unsigned int blocks, size_t extraBytes)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(mJackState == active)
+		throw std::runtime_error("the realtime arena must be sized before the client is started");
+	mArenaBlocks = blocks;
+	mArenaExtraBytes = extraBytes;
+	if(blocks > 0 || extraBytes > 0)
+		mArena.reset(createArena(getBufferSize()));
+	else {
+		mArena.reset(NULL);
+		mArenaCapacity = 0;
+	}
+}
+
+JackCpp::RTArena * JackCpp::AudioIO::createArena(jack_nframes_t frames){
+	RTArena * arena = new RTArena(mArenaBlocks * RTArena::blockBytes(frames) + mArenaExtraBytes, frames);
+	mArenaCapacity = arena->capacity();
+	return arena;
+}
+
+JackCpp::AudioIO::arena_stats_t JackCpp::AudioIO::getRTArenaStats(){
+	arena_stats_t stats;
+	stats.capacity = mArenaCapacity;
+	stats.highWater = mArenaHighWater;
+	stats.failures = mArenaFailures;
+	return stats;
+}
+
+void JackCpp::AudioIO::setLatencyCompensation(bool enable, jack_nframes_t maxDelay)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(mJackState == active)
+		throw std::runtime_error("latency compensation must be set before the client is started");
+	mLatencyCompensation = enable;
+	mMaxCompensationDelay = maxDelay;
+	mCompDelays.assign(mInputPorts.size(), 0);
+	if(enable)
+		mLatencyComp.reset(createLatencyComp(mCompDelays, getBufferSize()));
+	else
+		mLatencyComp.reset(NULL);
+}
+
+JackCpp::AudioIO::latency_comp_t * JackCpp::AudioIO::createLatencyComp(
+		const std::vector<jack_nframes_t>& delays, jack_nframes_t frames){
+	latency_comp_t * comp = new latency_comp_t;
+	comp->frames = frames;
+	comp->lineLength = mMaxCompensationDelay + frames;
+	comp->delays = delays;
+	comp->writePos.assign(delays.size(), 0);
+	comp->lines.assign(delays.size() * comp->lineLength, 0.0f);
+	comp->scratch.assign(delays.size() * frames, 0.0f);
+	return comp;
+}
+
+jack_nframes_t JackCpp::AudioIO::updateLatencyComp(){
+	std::vector<jack_nframes_t> delays(mInputPorts.size(), 0);
+	jack_nframes_t aligned = 0;
+	for(unsigned int i = 0; i < mInputPorts.size(); i++){
+		jack_latency_range_t r;
+		jack_port_get_latency_range(mInputPorts[i], JackCaptureLatency, &r);
+		delays[i] = r.max;
+		aligned = std::max(aligned, r.max);
+	}
+	for(unsigned int i = 0; i < delays.size(); i++)
+		delays[i] = std::min(aligned - delays[i], mMaxCompensationDelay);
+
+	//only swap in new delay lines when something changed, swapping clears them
+	if(delays != mCompDelays){
+		//if the callback hasn't caught up, keep the old delays so the next call tries again
+		if(hand_over(mLatencyComp, createLatencyComp(delays, getBufferSize()), mCallbacksLive))
+			mCompDelays = delays;
+	}
+	return aligned;
+}
+
+void JackCpp::AudioIO::compensateLatency(latency_comp_t * comp, jack_nframes_t nframes){
+	if(nframes > comp->frames)
+		return;
+	unsigned int ports = std::min((unsigned int)comp->delays.size(), mNumInputPorts);
+	unsigned int len = comp->lineLength;
+	for(unsigned int i = 0; i < ports; i++){
+		if(comp->delays[i] == 0)
+			continue;
+		jack_default_audio_sample_t * line = &comp->lines[i * len];
+		jack_default_audio_sample_t * out = &comp->scratch[i * comp->frames];
+		unsigned int w = comp->writePos[i];
+		unsigned int r = (w + len - comp->delays[i]) % len;
+
+		//write this cycle into the delay line, then read the delayed block out
+		unsigned int first = std::min(nframes, len - w);
+		memcpy(line + w, mJackInBuf[i], first * sizeof(jack_default_audio_sample_t));
+		memcpy(line, mJackInBuf[i] + first, (nframes - first) * sizeof(jack_default_audio_sample_t));
+		first = std::min(nframes, len - r);
+		memcpy(out, line + r, first * sizeof(jack_default_audio_sample_t));
+		memcpy(out + first, line, (nframes - first) * sizeof(jack_default_audio_sample_t));
+
+		comp->writePos[i] = (w + nframes) % len;
+		mJackInBuf[i] = out;
+	}
+}
+
+JackCpp::AudioIO::bus_set_t::~bus_set_t(){
+	for(unsigned int i = 0; i < in.size(); i++)
+		delete in[i];
+	for(unsigned int i = 0; i < out.size(); i++)
+		delete out[i];
+}
+
+JackCpp::AudioIO::bus_set_t * JackCpp::AudioIO::createBuses(jack_nframes_t frames){
+	bus_set_t * buses = new bus_set_t;
+	buses->inDefs = mInBusDefs;
+	buses->outDefs = mOutBusDefs;
+	try {
+		for(unsigned int i = 0; i < mInBusDefs.size(); i++)
+			buses->in.push_back(new AudioBus(mInBusDefs[i].count, frames, mInBusDefs[i].contiguous));
+		for(unsigned int i = 0; i < mOutBusDefs.size(); i++)
+			buses->out.push_back(new AudioBus(mOutBusDefs[i].count, frames, mOutBusDefs[i].contiguous));
+	} catch (...){
+		delete buses;
+		throw;
+	}
+	return buses;
+}
+
+void JackCpp::AudioIO::gatherBuses(bus_set_t * buses, jack_nframes_t nframes,
+		jack_default_audio_sample_t ** inBufs, unsigned int inCount,
+		jack_default_audio_sample_t ** outBufs, unsigned int outCount){
+	for(unsigned int i = 0; i < buses->in.size(); i++){
+		const bus_def_t& def = buses->inDefs[i];
+		if(def.first + def.count > inCount)
+			continue;
+		AudioBus * bus = buses->in[i];
+		bus->gather(&inBufs[def.first], nframes);
+		for(unsigned int j = 0; j < def.count; j++)
+			inBufs[def.first + j] = bus->channel(j);
+	}
+	for(unsigned int i = 0; i < buses->out.size(); i++){
+		const bus_def_t& def = buses->outDefs[i];
+		if(def.first + def.count > outCount)
+			continue;
+		AudioBus * bus = buses->out[i];
+		bus->bind(&outBufs[def.first], nframes);
+		for(unsigned int j = 0; j < def.count; j++)
+			outBufs[def.first + j] = bus->channel(j);
+	}
+}
+
+void JackCpp::AudioIO::applyBuses(jack_nframes_t nframes,
+		jack_default_audio_sample_t ** inBufs, unsigned int inCount,
+		jack_default_audio_sample_t ** outBufs, unsigned int outCount){
+	mCycleBuses = mBuses.acquire();
+	if(mCycleBuses != NULL)
+		gatherBuses(mCycleBuses, nframes, inBufs, inCount, outBufs, outCount);
+}
+
+void JackCpp::AudioIO::scatterBuses(){
+	if(mCycleBuses == NULL)
+		return;
+	for(unsigned int i = 0; i < mCycleBuses->out.size(); i++)
+		mCycleBuses->out[i]->scatter();
+}
+
+unsigned int JackCpp::AudioIO::addBus(std::vector<bus_def_t>& defs, unsigned int ports,
+		unsigned int first, unsigned int count, bool contiguous)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
+{
+	if(mJackState == active)
+		throw std::runtime_error("buses must be added before the client is started");
+	if(count == 0 || first + count > ports)
+		throw std::range_error("bus ports out of range");
+	for(unsigned int i = 0; i < defs.size(); i++){
+		if(first < defs[i].first + defs[i].count && defs[i].first < first + count)
+			throw std::runtime_error("buses cannot share ports");
+	}
+	bus_def_t def;
+	def.first = first;
+	def.count = count;
+	def.contiguous = contiguous;
+	defs.push_back(def);
+	try {
+		mBuses.reset(createBuses(getBufferSize()));
+	} catch (...){
+		defs.pop_back();
+		throw;
+	}
+	return defs.size() - 1;
+}
+
+unsigned int JackCpp::AudioIO::addInBus(unsigned int first, unsigned int count, bool contiguous)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
+{
+	return addBus(mInBusDefs, mInputPorts.size(), first, count, contiguous);
+}
+
+unsigned int JackCpp::AudioIO::addOutBus(unsigned int first, unsigned int count, bool contiguous)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
+{
+	return addBus(mOutBusDefs, mOutputPorts.size(), first, count, contiguous);
+}
+
+void JackCpp::AudioIO::clearBuses()
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(mJackState == active)
+		throw std::runtime_error("buses cannot be removed while the client is active");
+	mInBusDefs.clear();
+	mOutBusDefs.clear();
+	mBuses.reset(NULL);
+}
+
+JackCpp::AudioBus * JackCpp::AudioIO::inBus(unsigned int index){
+	if(mCycleBuses == NULL || index >= mCycleBuses->in.size())
+		return NULL;
+	return mCycleBuses->in[index];
+}
+
+JackCpp::AudioBus * JackCpp::AudioIO::outBus(unsigned int index){
+	if(mCycleBuses == NULL || index >= mCycleBuses->out.size())
+		return NULL;
+	return mCycleBuses->out[index];
+}
+
+void JackCpp::AudioIO::setTimebaseMaster(bool conditional)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(jack_set_timebase_callback(mJackClient, conditional ? 1 : 0, timebase_callback, this) != 0)
+		throw std::runtime_error("cannot become timebase master");
+}
+
+void JackCpp::AudioIO::releaseTimebase()
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(jack_release_timebase(mJackClient) != 0)
+		throw std::runtime_error("cannot release timebase, we are not the timebase master");
+}
+
+void JackCpp::AudioIO::setTimebaseTempo(double beatsPerMinute, float beatsPerBar,
+		float beatType, double ticksPerBeat){
+	tempo_t tempo;
+	tempo.beatsPerMinute = beatsPerMinute;
+	tempo.beatsPerBar = beatsPerBar;
+	tempo.beatType = beatType;
+	tempo.ticksPerBeat = ticksPerBeat;
+	if(mJackState == active){
+		//loop while there isn't space to write
+		while(mTempoBuffer.getWriteSpace() == 0);
+		mTempoBuffer.write(tempo);
+	} else
+		mTempo = tempo;
+}
+
+//compute the bar, beat and tick from the frame, at a constant tempo
+void JackCpp::AudioIO::jackTimebaseCallback(jack_transport_state_t /* state */,
+		jack_nframes_t /* nframes */, jack_position_t *pos, bool /* newPos */){
+	while(mTempoBuffer.getReadSpace() > 0)
+		mTempoBuffer.read(mTempo);
+
+	double minutes = pos->frame / ((double)pos->frame_rate * 60.0);
+	int64_t absTick = (int64_t)(minutes * mTempo.beatsPerMinute * mTempo.ticksPerBeat);
+	int64_t absBeat = absTick / (int64_t)mTempo.ticksPerBeat;
+	int64_t beatsPerBar = (int64_t)mTempo.beatsPerBar;
+	if(beatsPerBar < 1)
+		beatsPerBar = 1;
+
+	pos->valid = JackPositionBBT;
+	pos->bar = (int32_t)(absBeat / beatsPerBar);
+	pos->beat = (int32_t)(absBeat - pos->bar * beatsPerBar + 1);
+	pos->tick = (int32_t)(absTick - absBeat * (int64_t)mTempo.ticksPerBeat);
+	pos->bar_start_tick = (double)pos->bar * beatsPerBar * mTempo.ticksPerBeat;
+	pos->bar++;
+	pos->beats_per_bar = mTempo.beatsPerBar;
+	pos->beat_type = mTempo.beatType;
+	pos->ticks_per_beat = mTempo.ticksPerBeat;
+	pos->beats_per_minute = mTempo.beatsPerMinute;
+}
@@ -18,6 +18,8 @@
 
 #include "jackblockingaudioio.hpp"
 #include <unistd.h>
+#include <string.h>
+#include <math.h>
 #define MIN(x,y) ((x) < (y) ? (x) : (y))
 
 #if 0
@@ -31,23 +33,31 @@ using std::endl;
 JackCpp::BlockingAudioIO::BlockingAudioIO(std::string name,
 		unsigned int inChans, unsigned int outChans,
 		unsigned int inBufSize, unsigned int outBufSize,
-		bool startServer) throw(std::runtime_error):
+		bool startServer) JACKCPP_THROW(std::runtime_error):
 	AudioIO(name, inChans, outChans, startServer),
+	mLockstep(false), mUserOutFrames(NULL), mUserInFrames(NULL),
+	mDither(false), mUserInPushed(0), mUserInRead(0),
+	mConcealMode(GapConcealer::silence), mConcealRampFrames(32), mConcealRepeatFrames(256),
+	mOutConceal(NULL), mInConceal(NULL), mInGap(false),
 	mOutputBufferMaxSize((unsigned int)getSampleRate()),
-	mInputBufferMaxSize((unsigned int)getSampleRate())
+	mInputBufferMaxSize((unsigned int)getSampleRate()),
+	mOutputBufferRequestSize(outBufSize),
+	mInputBufferRequestSize(inBufSize),
+	mUserSampleRate(0),
+	mResampleQuality(Resampler::medium),
+	mDriftCompensation(false),
+	mInputWatermark(1), mOutputWatermark(1),
+	mInputReadyPolled(false), mOutputReadyPolled(false)
 {
-	if(inBufSize < 2 * getBufferSize())
-		inBufSize = 2 * getBufferSize();
-	else if (inBufSize > mInputBufferMaxSize)
-		inBufSize = mInputBufferMaxSize;
-	if(outBufSize < 2 * getBufferSize())
-		outBufSize = 2 * getBufferSize();
-	else if (outBufSize > mOutputBufferMaxSize)
-		outBufSize = mOutputBufferMaxSize;
-
-	//set the amount of the ring buffer that we leave free
-	mOutputBufferFreeSize = mOutputBufferMaxSize - outBufSize;
-	mInputBufferFreeSize = mInputBufferMaxSize - inBufSize;
+	updateBufferFreeSizes(getBufferSize());
+	updateReportedLatency(getSampleRate(), NULL);
+	//the drift loops keep running across buffer size and sample rate changes
+	mOutDrift.error = mOutDrift.integral = 0.0;
+	mInDrift.error = mInDrift.integral = 0.0;
+	memset(&mXruns, 0, sizeof(mXruns));
+	mXrunsAtReset = mXruns;
+	mXrunsShared.write(mXruns);
+	mDriftRatio.write(1.0);
 
 	//create input and output buffers, give them extra space to work with and memory lock them
 	for(unsigned int i = 0; i < outChans; i++)
@@ -58,19 +68,35 @@ JackCpp::BlockingAudioIO::BlockingAudioIO(std::string name,
 
 //clean up the buffers we allocated
 JackCpp::BlockingAudioIO::~BlockingAudioIO(){
-	stop();
+	//the client may already be closed
+	if(getState() == AudioIO::active)
+		stop();
 	for(std::vector<RingBuffer<jack_default_audio_sample_t> *>::iterator it = mUserOutBuff.begin();
 			it != mUserOutBuff.end(); it++)
 		delete *it;
 	for(std::vector<RingBuffer<jack_default_audio_sample_t> *>::iterator it = mUserInBuff.begin();
 			it != mUserInBuff.end(); it++)
 		delete *it;
+	delete mUserOutFrames;
+	delete mUserInFrames;
+	delete mOutConceal;
+	delete mInConceal;
 }
 
 //wait until we can write, then write
 void JackCpp::BlockingAudioIO::write(unsigned int channel, jack_default_audio_sample_t val){
 	if (channel >= outPorts())
 		return;
+	if(mLockstep){
+		//the frame is written when its last channel is
+		mOutFrame[channel] = val;
+		if(channel + 1 == outPorts()){
+			while(outputFramesWritable() == 0)
+				usleep(10);
+			mUserOutFrames->write(&mOutFrame[0], outPorts());
+		}
+		return;
+	}
 	while(mUserOutBuff[channel]->getWriteSpace() <= mOutputBufferFreeSize)
 		usleep(10);
 	mUserOutBuff[channel]->write(val);
@@ -78,6 +104,18 @@ void JackCpp::BlockingAudioIO::write(unsigned int channel, jack_default_audio_sa
 
 //we we can write then write, otherwise return false
 bool JackCpp::BlockingAudioIO::tryWrite(unsigned int channel, jack_default_audio_sample_t val){
+	if(mLockstep){
+		if(channel >= outPorts())
+			return false;
+		if(channel + 1 == outPorts()){
+			if(outputFramesWritable() == 0)
+				return false;
+			mOutFrame[channel] = val;
+			mUserOutFrames->write(&mOutFrame[0], outPorts());
+		} else
+			mOutFrame[channel] = val;
+		return true;
+	}
 	if (channel < outPorts() && mUserOutBuff[channel]->getWriteSpace() > mOutputBufferFreeSize){
 		mUserOutBuff[channel]->write(val);
 		return true;
@@ -90,92 +128,852 @@ jack_default_audio_sample_t JackCpp::BlockingAudioIO::read(unsigned int channel)
 	jack_default_audio_sample_t val;
 	if (channel >= inPorts())
 		return 0;
+	if(mLockstep){
+		//a new frame is read with its first channel
+		if(channel == 0){
+			while(inputFramesAvailable() == 0)
+				usleep(10);
+			mUserInFrames->read(&mInFrame[0], inPorts());
+			mUserInRead++;
+		}
+		return mInFrame[channel];
+	}
 	while(mUserInBuff[channel]->getReadSpace() == 0)
 		usleep(10);
 	mUserInBuff[channel]->read(val);
+	if(channel == 0)
+		mUserInRead++;
 	return val;
 }
 
 //if we cannot read then return false, otherwise, read and return true
 bool JackCpp::BlockingAudioIO::tryRead(unsigned int channel, jack_default_audio_sample_t &val){
+	if(mLockstep){
+		if(channel >= inPorts())
+			return false;
+		if(channel == 0){
+			if(inputFramesAvailable() == 0)
+				return false;
+			mUserInFrames->read(&mInFrame[0], inPorts());
+			mUserInRead++;
+		}
+		val = mInFrame[channel];
+		return true;
+	}
 	if (channel >= inPorts() || mUserInBuff[channel]->getReadSpace() == 0)
 		return false;
 	mUserInBuff[channel]->read(val);
+	if(channel == 0)
+		mUserInRead++;
 	return true;
 }
 
+namespace {
+	//convert cnt samples, stride apart, straight into a ring's free space
+	template<typename Sample>
+		void write_ring(JackCpp::RingBuffer<jack_default_audio_sample_t> * ring,
+				const Sample * src, unsigned int stride, unsigned int cnt){
+			jack_default_audio_sample_t * first, * second;
+			size_t firstCnt, secondCnt;
+			ring->getWriteVector(first, firstCnt, second, secondCnt);
+			unsigned int part = MIN(cnt, firstCnt);
+			JackCpp::toFloat(src, stride, first, part);
+			JackCpp::toFloat(src + part * stride, stride, second, cnt - part);
+			ring->writeAdvance(cnt);
+		}
+
+	//convert cnt samples straight out of a ring, stride apart in dest
+	template<typename Sample>
+		void read_ring(JackCpp::RingBuffer<jack_default_audio_sample_t> * ring,
+				Sample * dest, unsigned int stride, unsigned int cnt, JackCpp::Dither * dither){
+			jack_default_audio_sample_t * first, * second;
+			size_t firstCnt, secondCnt;
+			ring->getReadVector(first, firstCnt, second, secondCnt);
+			unsigned int part = MIN(cnt, firstCnt);
+			JackCpp::fromFloat(first, dest, stride, part, dither);
+			JackCpp::fromFloat(second, dest + part * stride, stride, cnt - part, dither);
+			ring->readAdvance(cnt);
+		}
+}
+
+//write as much as every channel has space for, until we're done
+template<typename Sample>
+unsigned int JackCpp::BlockingAudioIO::writeConverted(const Sample * src,
+		unsigned int frames, unsigned int channels, bool block)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(channels != outPorts())
+		throw std::runtime_error("JackCpp::BlockingAudioIO::writeBlock channels must equal the number of output ports");
+	//wait about a quarter of a jack period at a time
+	useconds_t wait = (useconds_t)(250000.0 * getBufferSize() / getSampleRate());
+	unsigned int done = 0;
+	while(done < frames){
+		unsigned int cnt = MIN(frames - done, outputFramesWritable());
+		if(cnt == 0){
+			if(!block)
+				break;
+			usleep(wait);
+			continue;
+		}
+		if(mLockstep)
+			write_ring(mUserOutFrames, src + done * channels, 1, cnt * channels);
+		else {
+			for(unsigned int i = 0; i < channels; i++)
+				write_ring(mUserOutBuff[i], src + done * channels + i, channels, cnt);
+		}
+		done += cnt;
+	}
+	return done;
+}
+
+//read as much as every channel has, until we're done
+template<typename Sample>
+unsigned int JackCpp::BlockingAudioIO::readConverted(Sample * dest,
+		unsigned int frames, unsigned int channels, bool block,
+		jack_time_t * captureTime)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(channels != inPorts())
+		throw std::runtime_error("JackCpp::BlockingAudioIO::readBlock channels must equal the number of input ports");
+	useconds_t wait = (useconds_t)(250000.0 * getBufferSize() / getSampleRate());
+	Dither * dither = mDither ? &mDitherNoise : NULL;
+	unsigned int done = 0;
+	if(captureTime != NULL)
+		*captureTime = 0;
+	while(done < frames){
+		unsigned int cnt = MIN(frames - done, inputFramesAvailable());
+		if(cnt == 0){
+			if(!block)
+				break;
+			usleep(wait);
+			continue;
+		}
+		if(done == 0 && captureTime != NULL)
+			*captureTime = oldestCaptureTime();
+		if(mLockstep)
+			read_ring(mUserInFrames, dest + done * channels, 1, cnt * channels, dither);
+		else {
+			for(unsigned int i = 0; i < channels; i++)
+				read_ring(mUserInBuff[i], dest + done * channels + i, channels, cnt, dither);
+		}
+		mUserInRead += cnt;
+		done += cnt;
+	}
+	return done;
+}
+
+unsigned int JackCpp::BlockingAudioIO::writeBlock(const jack_default_audio_sample_t * src,
+		unsigned int frames, unsigned int channels, bool block)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return writeConverted(src, frames, channels, block);
+}
+
+unsigned int JackCpp::BlockingAudioIO::writeBlock(const int16_t * src,
+		unsigned int frames, unsigned int channels, bool block)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return writeConverted(src, frames, channels, block);
+}
+
+unsigned int JackCpp::BlockingAudioIO::writeBlock(const Int24 * src,
+		unsigned int frames, unsigned int channels, bool block)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return writeConverted(src, frames, channels, block);
+}
+
+unsigned int JackCpp::BlockingAudioIO::writeBlock(const Int24In32 * src,
+		unsigned int frames, unsigned int channels, bool block)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return writeConverted(src, frames, channels, block);
+}
+
+unsigned int JackCpp::BlockingAudioIO::writeBlock(const int32_t * src,
+		unsigned int frames, unsigned int channels, bool block)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return writeConverted(src, frames, channels, block);
+}
+
+unsigned int JackCpp::BlockingAudioIO::writeBlock(const double * src,
+		unsigned int frames, unsigned int channels, bool block)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return writeConverted(src, frames, channels, block);
+}
+
+unsigned int JackCpp::BlockingAudioIO::readBlock(jack_default_audio_sample_t * dest,
+		unsigned int frames, unsigned int channels, bool block,
+		jack_time_t * captureTime)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return readConverted(dest, frames, channels, block, captureTime);
+}
+
+unsigned int JackCpp::BlockingAudioIO::readBlock(int16_t * dest,
+		unsigned int frames, unsigned int channels, bool block,
+		jack_time_t * captureTime)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return readConverted(dest, frames, channels, block, captureTime);
+}
+
+unsigned int JackCpp::BlockingAudioIO::readBlock(Int24 * dest,
+		unsigned int frames, unsigned int channels, bool block,
+		jack_time_t * captureTime)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return readConverted(dest, frames, channels, block, captureTime);
+}
+
+unsigned int JackCpp::BlockingAudioIO::readBlock(Int24In32 * dest,
+		unsigned int frames, unsigned int channels, bool block,
+		jack_time_t * captureTime)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return readConverted(dest, frames, channels, block, captureTime);
+}
+
+unsigned int JackCpp::BlockingAudioIO::readBlock(int32_t * dest,
+		unsigned int frames, unsigned int channels, bool block,
+		jack_time_t * captureTime)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return readConverted(dest, frames, channels, block, captureTime);
+}
+
+unsigned int JackCpp::BlockingAudioIO::readBlock(double * dest,
+		unsigned int frames, unsigned int channels, bool block,
+		jack_time_t * captureTime)
+	JACKCPP_THROW(std::runtime_error)
+{
+	return readConverted(dest, frames, channels, block, captureTime);
+}
+
+void JackCpp::BlockingAudioIO::setDither(bool enable){
+	mDither = enable;
+}
+
+bool JackCpp::BlockingAudioIO::getDither(){
+	return mDither;
+}
+
 void JackCpp::BlockingAudioIO::reserveOutPorts(unsigned int num)
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	AudioIO::reserveOutPorts(num);
 	mUserOutBuff.reserve(num);
 }
 
 void JackCpp::BlockingAudioIO::reserveInPorts(unsigned int num)
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	AudioIO::reserveInPorts(num);
 	mUserInBuff.reserve(num);
 }
 
 unsigned int JackCpp::BlockingAudioIO::addInPort(std::string name)
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	unsigned int ret;
 	if(getState() == AudioIO::active)
 		throw std::runtime_error("JackCpp::BlockingAudioIO::addInPort not allowed while the client is active");
 	ret = AudioIO::addInPort(name);
 	mUserInBuff.push_back(new RingBuffer<jack_default_audio_sample_t>(mInputBufferMaxSize, true));
+	updateLockstepBuffers();
+	updateConcealers();
+	mResampleState.reset(createResamplers(getBufferSize(), getSampleRate()));
 	return ret;
 }
 
 unsigned int JackCpp::BlockingAudioIO::addOutPort(std::string name)
-	throw(std::runtime_error)
+	JACKCPP_THROW(std::runtime_error)
 {
 	unsigned int ret;
 	if(getState() == AudioIO::active)
 		throw std::runtime_error("JackCpp::BlockingAudioIO::addOutPort not allowed while the client is active");
 	ret = AudioIO::addOutPort(name);
 	mUserOutBuff.push_back(new RingBuffer<jack_default_audio_sample_t>(mOutputBufferMaxSize, true));
+	updateLockstepBuffers();
+	updateConcealers();
+	mResampleState.reset(createResamplers(getBufferSize(), getSampleRate()));
 	return ret;
 }
 
 //read the jack input buffers into the user input buffers
 //write the user output buffers into the jack output buffers
-int JackCpp::BlockingAudioIO::audioCallback(jack_nframes_t nframes, 
-		audioBufVector inBufs,
-		audioBufVector outBufs){
+int JackCpp::BlockingAudioIO::processAudio(jack_nframes_t nframes,
+		const audioBufVector& inBufs,
+		const audioBufVector& outBufs){
 
-	//only try to write as much as we have space to write
-	unsigned int numToWrite = MIN(mUserOutBuff[0]->getReadSpace(), nframes);
-	unsigned int numToRead = MIN(mUserInBuff[0]->getWriteSpace(), nframes);
+	//pick up resamplers rebuilt for a new buffer size or sample rate
+	resample_state_t * rs = mResampleState.acquire();
+	int ret;
+	double ratio = 1.0;
+	if(rs != NULL){
+		ret = resampledCallback(nframes, rs, inBufs, outBufs);
+		if(rs->out != NULL)
+			ratio = rs->out->ratioAdjust();
+		else if(rs->in != NULL)
+			ratio = rs->in->ratioAdjust();
+	} else
+		ret = directCallback(nframes, inBufs, outBufs);
+	mDriftRatio.write(ratio);
+	signalReadiness();
+	return ret;
+}
 
-	//make sure we leave the amount of free space we require
-	if(mUserInBuff[0]->getWriteSpace() - numToRead < mInputBufferFreeSize)
-		numToRead = mUserInBuff[0]->getWriteSpace() - mInputBufferFreeSize;
+//wake up anyone polling our descriptors, the notifiers never block
+void JackCpp::BlockingAudioIO::signalReadiness(){
+	if(mInputReadyPolled && inPorts() > 0 && inputFramesAvailable() >= mInputWatermark)
+		mInputReady.notify();
+	if(mOutputReadyPolled && outPorts() > 0 && outputFramesWritable() >= mOutputWatermark)
+		mOutputReady.notify();
+}
 
-	//if (numToWrite < nframes)
-		//cerr << "oops" << endl;
+unsigned int JackCpp::BlockingAudioIO::inputFramesAvailable(){
+	if(mLockstep)
+		return (mUserInFrames == NULL) ? 0 : mUserInFrames->getReadSpace() / inPorts();
+	unsigned int cnt = 0;
+	for(unsigned int i = 0; i < mUserInBuff.size(); i++){
+		unsigned int avail = mUserInBuff[i]->getReadSpace();
+		cnt = (i == 0) ? avail : MIN(cnt, avail);
+	}
+	return cnt;
+}
+
+unsigned int JackCpp::BlockingAudioIO::outputFramesWritable(){
+	if(mLockstep){
+		if(mUserOutFrames == NULL)
+			return 0;
+		unsigned int space = mUserOutFrames->getWriteSpace() / outPorts();
+		return (space > mOutputBufferFreeSize) ? space - mOutputBufferFreeSize : 0;
+	}
+	unsigned int cnt = 0;
+	for(unsigned int i = 0; i < mUserOutBuff.size(); i++){
+		unsigned int space = mUserOutBuff[i]->getWriteSpace();
+		space = (space > mOutputBufferFreeSize) ? space - mOutputBufferFreeSize : 0;
+		cnt = (i == 0) ? space : MIN(cnt, space);
+	}
+	return cnt;
+}
+
+void JackCpp::BlockingAudioIO::setInputWatermark(unsigned int frames){
+	mInputWatermark = (frames > 0) ? frames : 1;
+}
+
+void JackCpp::BlockingAudioIO::setOutputWatermark(unsigned int frames){
+	mOutputWatermark = (frames > 0) ? frames : 1;
+}
+
+int JackCpp::BlockingAudioIO::inputReadyFd(){
+	mInputReadyPolled = true;
+	return mInputReady.fd();
+}
+
+int JackCpp::BlockingAudioIO::outputReadyFd(){
+	mOutputReadyPolled = true;
+	return mOutputReady.fd();
+}
+
+void JackCpp::BlockingAudioIO::clearInputReady(){
+	mInputReady.clear();
+}
+
+void JackCpp::BlockingAudioIO::clearOutputReady(){
+	mOutputReady.clear();
+}
+
+//the callback when we aren't converting sample rates
+int JackCpp::BlockingAudioIO::directCallback(jack_nframes_t nframes,
+		const audioBufVector& inBufs,
+		const audioBufVector& outBufs){
+	//only move as much as every channel has, so that they stay aligned
+	unsigned int numToWrite = MIN(userOutFrames(), nframes);
+	unsigned int numToRead = MIN(userInSpace(), nframes);
 
 	//read get inputs
-	for(unsigned int i = 0; i < inPorts(); i++){
-		for(unsigned int j = 0; j < numToRead; j++)
-			mUserInBuff[i]->write(inBufs[i][j]);
+	if(inPorts() > 0){
+		if(mInConceal == NULL || (!mInGap && numToRead == nframes))
+			pushUserIn(&inBufs[0], numToRead);
+		else
+			pushUserInConcealed(&inBufs[0], numToRead, numToRead < nframes);
+		stampCapture(numToRead, cycleStartFrame() + numToRead);
 	}
 
 	//write output
-	for(unsigned int i = 0; i < outPorts(); i++){
-		for(unsigned int j = 0; j < numToWrite; j++){
-			jack_default_audio_sample_t val;
-			mUserOutBuff[i]->read(val);
-			outBufs[i][j] = val;
-		}
-		//write zeros for the rest
-		for(unsigned int j = numToWrite; j < nframes; j++)
-			outBufs[i][j] = 0.0;
-		//if(numToWrite < nframes)
-			//cerr << "oops" << endl;
+	if(outPorts() > 0){
+		pullUserOut(&outBufs[0], numToWrite);
+		//fill in the rest
+		if(mOutConceal != NULL)
+			mOutConceal->fillGap(&outBufs[0], numToWrite, nframes);
+		else {
+			for(unsigned int i = 0; i < outPorts(); i++){
+				for(unsigned int j = numToWrite; j < nframes; j++)
+					outBufs[i][j] = 0.0;
+			}
+		}
 	}
+	countXruns(outPorts() > 0 ? nframes - numToWrite : 0,
+			inPorts() > 0 ? nframes - numToRead : 0);
 	return 0;
 }
 
+unsigned int JackCpp::BlockingAudioIO::userOutFrames(){
+	if(mLockstep)
+		return (mUserOutFrames == NULL) ? 0 : mUserOutFrames->getReadSpace() / outPorts();
+	unsigned int cnt = 0;
+	for(unsigned int i = 0; i < mUserOutBuff.size(); i++){
+		unsigned int avail = mUserOutBuff[i]->getReadSpace();
+		cnt = (i == 0) ? avail : MIN(cnt, avail);
+	}
+	return cnt;
+}
+
+//leave the amount of free space we require
+unsigned int JackCpp::BlockingAudioIO::userInSpace(){
+	unsigned int space = 0;
+	if(mLockstep){
+		if(mUserInFrames != NULL)
+			space = mUserInFrames->getWriteSpace() / inPorts();
+	} else {
+		for(unsigned int i = 0; i < mUserInBuff.size(); i++){
+			unsigned int s = mUserInBuff[i]->getWriteSpace();
+			space = (i == 0) ? s : MIN(space, s);
+		}
+	}
+	return (space > mInputBufferFreeSize) ? space - mInputBufferFreeSize : 0;
+}
+
+namespace {
+	//copy interleaved frames out to one buffer per channel, starting at
+	//offset, the stereo case is written out so that it vectorizes
+	void deinterleave(const jack_default_audio_sample_t * src, unsigned int chans,
+			jack_default_audio_sample_t * const * dest, unsigned int offset, unsigned int frames){
+		if(chans == 1){
+			memcpy(dest[0] + offset, src, frames * sizeof(jack_default_audio_sample_t));
+		} else if(chans == 2){
+			jack_default_audio_sample_t * left = dest[0] + offset;
+			jack_default_audio_sample_t * right = dest[1] + offset;
+			for(unsigned int j = 0; j < frames; j++){
+				left[j] = src[2 * j];
+				right[j] = src[2 * j + 1];
+			}
+		} else {
+			for(unsigned int i = 0; i < chans; i++){
+				jack_default_audio_sample_t * d = dest[i] + offset;
+				for(unsigned int j = 0; j < frames; j++)
+					d[j] = src[j * chans + i];
+			}
+		}
+	}
+
+	//the reverse of deinterleave
+	void interleave(jack_default_audio_sample_t * const * src, unsigned int offset,
+			unsigned int chans, jack_default_audio_sample_t * dest, unsigned int frames){
+		if(chans == 1){
+			memcpy(dest, src[0] + offset, frames * sizeof(jack_default_audio_sample_t));
+		} else if(chans == 2){
+			const jack_default_audio_sample_t * left = src[0] + offset;
+			const jack_default_audio_sample_t * right = src[1] + offset;
+			for(unsigned int j = 0; j < frames; j++){
+				dest[2 * j] = left[j];
+				dest[2 * j + 1] = right[j];
+			}
+		} else {
+			for(unsigned int i = 0; i < chans; i++){
+				const jack_default_audio_sample_t * s = src[i] + offset;
+				for(unsigned int j = 0; j < frames; j++)
+					dest[j * chans + i] = s[j];
+			}
+		}
+	}
+}
+
+void JackCpp::BlockingAudioIO::pullUserOut(jack_default_audio_sample_t * const * dest, unsigned int frames){
+	if(!mLockstep){
+		for(unsigned int i = 0; i < outPorts(); i++)
+			mUserOutBuff[i]->read(dest[i], frames);
+		return;
+	}
+	if(frames == 0)
+		return;
+
+	//read in place, a frame may be split across the end of the buffer
+	unsigned int chans = outPorts();
+	jack_default_audio_sample_t * first, * second;
+	size_t firstCnt, secondCnt;
+	mUserOutFrames->getReadVector(first, firstCnt, second, secondCnt);
+	unsigned int done = MIN(firstCnt / chans, frames);
+	deinterleave(first, chans, dest, 0, done);
+	if(done < frames){
+		unsigned int part = firstCnt - done * chans;
+		if(part > 0){
+			for(unsigned int i = 0; i < chans; i++)
+				dest[i][done] = (i < part) ? first[done * chans + i] : second[i - part];
+			second += chans - part;
+			done++;
+		}
+		deinterleave(second, chans, dest, done, frames - done);
+	}
+	mUserOutFrames->readAdvance(frames * chans);
+}
+
+void JackCpp::BlockingAudioIO::pushUserIn(jack_default_audio_sample_t * const * src, unsigned int frames){
+	if(!mLockstep){
+		for(unsigned int i = 0; i < inPorts(); i++)
+			mUserInBuff[i]->write(src[i], frames);
+		return;
+	}
+	if(frames == 0)
+		return;
+
+	unsigned int chans = inPorts();
+	jack_default_audio_sample_t * first, * second;
+	size_t firstCnt, secondCnt;
+	mUserInFrames->getWriteVector(first, firstCnt, second, secondCnt);
+	unsigned int done = MIN(firstCnt / chans, frames);
+	interleave(src, 0, chans, first, done);
+	if(done < frames){
+		unsigned int part = firstCnt - done * chans;
+		if(part > 0){
+			for(unsigned int i = 0; i < chans; i++){
+				if(i < part)
+					first[done * chans + i] = src[i][done];
+				else
+					second[i - part] = src[i][done];
+			}
+			second += chans - part;
+			done++;
+		}
+		interleave(src, done, chans, second, frames - done);
+	}
+	mUserInFrames->writeAdvance(frames * chans);
+}
+
+void JackCpp::BlockingAudioIO::setLockstep(bool enable)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(getState() == AudioIO::active)
+		throw std::runtime_error("JackCpp::BlockingAudioIO::setLockstep not allowed while the client is active");
+	mLockstep = enable;
+	updateLockstepBuffers();
+}
+
+bool JackCpp::BlockingAudioIO::getLockstep(){
+	return mLockstep;
+}
+
+void JackCpp::BlockingAudioIO::updateLockstepBuffers(){
+	delete mUserOutFrames;
+	delete mUserInFrames;
+	mUserOutFrames = mUserInFrames = NULL;
+	if(mLockstep && outPorts() > 0)
+		mUserOutFrames = new RingBuffer<jack_default_audio_sample_t>(mOutputBufferMaxSize * outPorts(), true);
+	if(mLockstep && inPorts() > 0)
+		mUserInFrames = new RingBuffer<jack_default_audio_sample_t>(mInputBufferMaxSize * inPorts(), true);
+	mOutFrame.assign(outPorts(), 0.0f);
+	mInFrame.assign(inPorts(), 0.0f);
+	//we're not active, line the capture stamps up with what can be read now
+	mUserInPushed = mUserInRead + inputFramesAvailable();
+	capture_stamp_t stamp = mCaptureStamp.read();
+	stamp.frames = mUserInPushed;
+	mCaptureStamp.write(stamp);
+}
+
+void JackCpp::BlockingAudioIO::stampCapture(unsigned int frames, jack_nframes_t endFrame){
+	if(frames == 0)
+		return;
+	mUserInPushed += frames;
+	capture_stamp_t stamp;
+	stamp.frames = mUserInPushed;
+	stamp.endFrame = endFrame;
+	mCaptureStamp.write(stamp);
+}
+
+jack_time_t JackCpp::BlockingAudioIO::oldestCaptureTime(){
+	capture_stamp_t stamp = mCaptureStamp.read();
+	//the user inputs may be at another rate
+	double scale = (mUserSampleRate == 0) ? 1.0 : (double)getSampleRate() / mUserSampleRate;
+	jack_nframes_t back = (jack_nframes_t)floor((stamp.frames - mUserInRead) * scale + 0.5);
+	jack_nframes_t latency = 0;
+	if(inPorts() > 0)
+		latency = getInPortLatencyRange(0, JackCaptureLatency).min;
+	return framesToTime(stamp.endFrame - back - latency);
+}
+
+void JackCpp::BlockingAudioIO::setUserSampleRate(unsigned int rate, Resampler::quality_t quality)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(getState() == AudioIO::active)
+		throw std::runtime_error("JackCpp::BlockingAudioIO::setUserSampleRate not allowed while the client is active");
+	mUserSampleRate = rate;
+	mResampleQuality = quality;
+	mResampleState.reset(createResamplers(getBufferSize(), getSampleRate()));
+	updateReportedLatency(getSampleRate(), mResampleState.get());
+}
+
+unsigned int JackCpp::BlockingAudioIO::getUserSampleRate(){
+	if(mUserSampleRate == 0)
+		return getSampleRate();
+	return mUserSampleRate;
+}
+
+void JackCpp::BlockingAudioIO::setDriftCompensation(bool enable)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(getState() == AudioIO::active)
+		throw std::runtime_error("JackCpp::BlockingAudioIO::setDriftCompensation not allowed while the client is active");
+	mDriftCompensation = enable;
+	mResampleState.reset(createResamplers(getBufferSize(), getSampleRate()));
+	updateReportedLatency(getSampleRate(), mResampleState.get());
+}
+
+double JackCpp::BlockingAudioIO::getDriftRatio(){
+	return mDriftRatio.read();
+}
+
+int JackCpp::BlockingAudioIO::jackBufferSizeCallback(jack_nframes_t nframes){
+	int ret = AudioIO::jackBufferSizeCallback(nframes);
+	updateBufferFreeSizes(nframes);
+	resample_state_t * rs = createResamplers(nframes, getSampleRate());
+	updateReportedLatency(getSampleRate(), rs);
+	//NULL too, so a rate back at the user rate goes back to passing straight through
+	if(!mResampleState.publish(rs)){
+		delete rs;
+		return 1;
+	}
+	return ret;
+}
+
+int JackCpp::BlockingAudioIO::jackSampleRateCallback(jack_nframes_t rate){
+	AudioIO::jackSampleRateCallback(rate);
+	resample_state_t * rs = createResamplers(getBufferSize(), rate);
+	updateReportedLatency(rate, rs);
+	if(!mResampleState.publish(rs)){
+		delete rs;
+		return 1;
+	}
+	return 0;
+}
+
+void JackCpp::BlockingAudioIO::updateBufferFreeSizes(jack_nframes_t nframes){
+	unsigned int inBufSize = mInputBufferRequestSize;
+	unsigned int outBufSize = mOutputBufferRequestSize;
+
+	if(inBufSize < 2 * nframes)
+		inBufSize = 2 * nframes;
+	if (inBufSize > mInputBufferMaxSize)
+		inBufSize = mInputBufferMaxSize;
+	if(outBufSize < 2 * nframes)
+		outBufSize = 2 * nframes;
+	if (outBufSize > mOutputBufferMaxSize)
+		outBufSize = mOutputBufferMaxSize;
+
+	//set the amount of the ring buffer that we leave free
+	mOutputBufferFreeSize = mOutputBufferMaxSize - outBufSize;
+	mInputBufferFreeSize = mInputBufferMaxSize - inBufSize;
+}
+
+//the user buffers are in user frames, convert them to server frames
+void JackCpp::BlockingAudioIO::updateReportedLatency(jack_nframes_t serverRate, const resample_state_t * rs){
+	double scale = (mUserSampleRate == 0) ? 1.0 : (double)serverRate / mUserSampleRate;
+	double outLatency = (mOutputBufferMaxSize - mOutputBufferFreeSize) * scale;
+	double inLatency = (mInputBufferMaxSize - mInputBufferFreeSize) * scale;
+	if(rs != NULL && rs->out != NULL)
+		outLatency += rs->out->latency() * scale;
+	if(rs != NULL && rs->in != NULL)
+		inLatency += rs->in->latency();
+	//these callers are either not active or inside a jack callback, so don't recompute
+	setProcessingLatency((jack_nframes_t)outLatency, (jack_nframes_t)(outLatency + inLatency), false);
+}
+
+//build the filters here, outside of the callback
+JackCpp::BlockingAudioIO::resample_state_t * JackCpp::BlockingAudioIO::createResamplers(
+		jack_nframes_t nframes, jack_nframes_t serverRate){
+	double server = serverRate;
+	double user = (mUserSampleRate == 0) ? server : mUserSampleRate;
+	if(user == server && !mDriftCompensation)
+		return NULL;
+
+	resample_state_t * rs = new resample_state_t;
+	if(outPorts() > 0){
+		rs->out = new Resampler(outPorts(), user, server, nframes, mResampleQuality);
+		rs->outPushBufs.resize(outPorts());
+	}
+	if(inPorts() > 0){
+		rs->in = new Resampler(inPorts(), server, user, nframes, mResampleQuality);
+		//the most output one period of input can produce
+		double minStep = rs->in->nominalStep() * (1.0 - Resampler::maxRatioAdjust);
+		rs->inScratchFrames = (unsigned int)ceil(nframes / minStep) + 2;
+		rs->inScratch.assign(inPorts() * rs->inScratchFrames, 0.0f);
+		rs->inScratchBufs.resize(inPorts());
+		for(unsigned int i = 0; i < inPorts(); i++)
+			rs->inScratchBufs[i] = &rs->inScratch[i * rs->inScratchFrames];
+	}
+	return rs;
+}
+
+//a slow PI loop, the error is low passed so the ratio doesn't warble with
+//the period sized steps of the fill level
+void JackCpp::BlockingAudioIO::compensateDrift(Resampler * resampler, drift_state_t &state,
+		unsigned int fill, unsigned int target){
+	if(target == 0)
+		return;
+	double error = ((double)fill - (double)target) / (double)target;
+	state.error += 0.01 * (error - state.error);
+	state.integral += 1e-5 * state.error;
+	if(state.integral > Resampler::maxRatioAdjust)
+		state.integral = Resampler::maxRatioAdjust;
+	else if(state.integral < -Resampler::maxRatioAdjust)
+		state.integral = -Resampler::maxRatioAdjust;
+	resampler->setRatioAdjust(1.0 + 1e-3 * state.error + state.integral);
+}
+
+//like processAudio but with a resampler between the user buffers and jack
+int JackCpp::BlockingAudioIO::resampledCallback(jack_nframes_t nframes, resample_state_t * rs,
+		const audioBufVector &inBufs, const audioBufVector &outBufs){
+	unsigned int produced = 0;
+
+	//user rate -> jack rate
+	if(rs->out != NULL && nframes <= rs->out->maxFrames()){
+		unsigned int avail = userOutFrames();
+		if(mDriftCompensation)
+			compensateDrift(rs->out, mOutDrift, avail,
+					(mOutputBufferMaxSize - mOutputBufferFreeSize) / 2);
+
+		unsigned int toPush = MIN(rs->out->inputFramesNeeded(nframes), rs->out->inputSpace());
+		toPush = MIN(toPush, avail);
+		if(toPush > 0){
+			for(unsigned int i = 0; i < outPorts(); i++)
+				rs->outPushBufs[i] = rs->out->inputBuffer(i);
+			pullUserOut(&rs->outPushBufs[0], toPush);
+			rs->out->commitInput(toPush);
+		}
+		produced = rs->out->process(outBufs, nframes);
+	}
+	//fill in the rest
+	if(mOutConceal != NULL && outPorts() > 0)
+		mOutConceal->fillGap(&outBufs[0], produced, nframes);
+	else {
+		for(unsigned int i = 0; i < outPorts(); i++){
+			for(unsigned int j = produced; j < nframes; j++)
+				outBufs[i][j] = 0.0;
+		}
+	}
+	unsigned int dropped = 0;
+
+	//jack rate -> user rate
+	if(rs->in != NULL && nframes <= rs->in->inputSpace()){
+		for(unsigned int i = 0; i < inPorts(); i++)
+			memcpy(rs->in->inputBuffer(i), inBufs[i], nframes * sizeof(jack_default_audio_sample_t));
+		rs->in->commitInput(nframes);
+
+		if(mDriftCompensation)
+			compensateDrift(rs->in, mInDrift, inputFramesAvailable(),
+					(mInputBufferMaxSize - mInputBufferFreeSize) / 2);
+
+		//always drain the resampler, what doesn't fit in the user buffers is dropped
+		unsigned int resampled = rs->in->process(rs->inScratchBufs,
+				MIN(rs->in->outputFramesAvailable(), rs->inScratchFrames));
+		unsigned int toWrite = MIN(resampled, userInSpace());
+		dropped = resampled - toWrite;
+		if(mInConceal == NULL || (!mInGap && dropped == 0))
+			pushUserIn(&rs->inScratchBufs[0], toWrite);
+		else
+			pushUserInConcealed(&rs->inScratchBufs[0], toWrite, dropped > 0);
+		//the newest output of the resampler is its latency behind its newest input
+		stampCapture(toWrite, cycleStartFrame() + nframes - rs->in->latency());
+	} else if(rs->in != NULL){
+		//the resampler is full, the whole cycle is dropped, counted at the user rate
+		dropped = (unsigned int)(nframes / rs->in->nominalStep() + 0.5);
+		if(mInConceal != NULL)
+			mInGap = true;
+	}
+	countXruns(outPorts() > 0 ? nframes - produced : 0, dropped);
+	return 0;
+}
+
+void JackCpp::BlockingAudioIO::countXruns(unsigned int outMissing, unsigned int inDropped){
+	if((outMissing | inDropped) == 0)
+		return;
+	mXruns.outputUnderruns += (outMissing > 0);
+	mXruns.outputFramesMissing += outMissing;
+	mXruns.inputOverruns += (inDropped > 0);
+	mXruns.inputFramesDropped += inDropped;
+	mXrunsShared.write(mXruns);
+}
+
+void JackCpp::BlockingAudioIO::pushUserInConcealed(jack_default_audio_sample_t * const * src,
+		unsigned int frames, bool dropping){
+	const bool fadeIn = mInGap;
+	const unsigned int ramp = mInConceal->rampFrames();
+	mInGap = dropping;
+	unsigned int pos = 0;
+	while(pos < frames){
+		//the frames within a ramp of a faded end go through the concealer, the rest go straight in
+		bool edge = (fadeIn && pos < ramp) || (dropping && frames - pos <= ramp);
+		unsigned int cnt;
+		if(edge)
+			cnt = MIN(ramp, frames - pos);
+		else
+			cnt = (dropping && frames > ramp) ? frames - ramp - pos : frames - pos;
+		if(fadeIn && pos < ramp)
+			cnt = MIN(cnt, ramp - pos);
+		if(edge)
+			pushUserIn(mInConceal->rampInput(src, pos, cnt, frames, fadeIn, dropping), cnt);
+		else {
+			for(unsigned int i = 0; i < inPorts(); i++)
+				mInConcealBufs[i] = src[i] + pos;
+			pushUserIn(&mInConcealBufs[0], cnt);
+		}
+		pos += cnt;
+	}
+}
+
+void JackCpp::BlockingAudioIO::updateConcealers(){
+	delete mOutConceal;
+	delete mInConceal;
+	mOutConceal = mInConceal = NULL;
+	if(mConcealMode != GapConcealer::silence){
+		if(outPorts() > 0)
+			mOutConceal = new GapConcealer(outPorts(), mConcealMode, mConcealRampFrames, mConcealRepeatFrames);
+		if(inPorts() > 0)
+			mInConceal = new GapConcealer(inPorts(), mConcealMode, mConcealRampFrames, mConcealRepeatFrames);
+	}
+	mInConcealBufs.resize(inPorts());
+	mInGap = false;
+}
+
+JackCpp::BlockingAudioIO::xrun_stats_t JackCpp::BlockingAudioIO::getXrunStats(){
+	xrun_stats_t stats = mXrunsShared.read();
+	stats.outputUnderruns -= mXrunsAtReset.outputUnderruns;
+	stats.outputFramesMissing -= mXrunsAtReset.outputFramesMissing;
+	stats.inputOverruns -= mXrunsAtReset.inputOverruns;
+	stats.inputFramesDropped -= mXrunsAtReset.inputFramesDropped;
+	return stats;
+}
+
+void JackCpp::BlockingAudioIO::resetXrunStats(){
+	mXrunsAtReset = mXrunsShared.read();
+}
+
+void JackCpp::BlockingAudioIO::setConcealment(GapConcealer::mode_t mode,
+		unsigned int rampFrames, unsigned int repeatFrames)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(getState() == AudioIO::active)
+		throw std::runtime_error("JackCpp::BlockingAudioIO::setConcealment not allowed while the client is active");
+	if(rampFrames == 0 || repeatFrames == 0)
+		throw std::runtime_error("JackCpp::BlockingAudioIO::setConcealment the ramp and repeat must be at least one frame");
+	mConcealMode = mode;
+	mConcealRampFrames = rampFrames;
+	mConcealRepeatFrames = repeatFrames;
+	updateConcealers();
+}
+
+JackCpp::GapConcealer::mode_t JackCpp::BlockingAudioIO::getConcealment(){
+	return mConcealMode;
+}
@@ -0,0 +1,128 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackbus.hpp"
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define JACKCPP_HAVE_SSE
+#endif
+
+namespace {
+	//dest += gain * src, over nframes
+	void mix_in(jack_default_audio_sample_t * dest, const jack_default_audio_sample_t * src,
+			float gain, unsigned int nframes, bool aligned){
+		unsigned int j = 0;
+#ifdef JACKCPP_HAVE_SSE
+		__m128 g = _mm_set1_ps(gain);
+		if(aligned){
+			for(; j + 8 <= nframes; j += 8){
+				__m128 a = _mm_add_ps(_mm_load_ps(dest + j), _mm_mul_ps(g, _mm_load_ps(src + j)));
+				__m128 b = _mm_add_ps(_mm_load_ps(dest + j + 4), _mm_mul_ps(g, _mm_load_ps(src + j + 4)));
+				_mm_store_ps(dest + j, a);
+				_mm_store_ps(dest + j + 4, b);
+			}
+		} else {
+			for(; j + 8 <= nframes; j += 8){
+				__m128 a = _mm_add_ps(_mm_loadu_ps(dest + j), _mm_mul_ps(g, _mm_loadu_ps(src + j)));
+				__m128 b = _mm_add_ps(_mm_loadu_ps(dest + j + 4), _mm_mul_ps(g, _mm_loadu_ps(src + j + 4)));
+				_mm_storeu_ps(dest + j, a);
+				_mm_storeu_ps(dest + j + 4, b);
+			}
+		}
+#else
+		(void)aligned;
+#endif
+		for(; j < nframes; j++)
+			dest[j] += gain * src[j];
+	}
+}
+
+JackCpp::AudioBus::AudioBus(unsigned int channels, jack_nframes_t maxFrames, bool contiguous)
+	JACKCPP_THROW(std::runtime_error) :
+	mChannels(channels, (jack_default_audio_sample_t *)NULL), mPorts(channels, (jack_default_audio_sample_t *)NULL),
+	mBlock(NULL), mStride(0), mBytes(0), mLocked(false), mInBlock(false),
+	mMaxFrames(maxFrames), mFrames(0)
+{
+	if(!contiguous || channels == 0 || maxFrames == 0)
+		return;
+	//pad every channel out to the alignment, so they all start on a cache line
+	const size_t perAlign = alignment / sizeof(jack_default_audio_sample_t);
+	mStride = (maxFrames + perAlign - 1) / perAlign * perAlign;
+	mBytes = mStride * channels * sizeof(jack_default_audio_sample_t);
+	void * data;
+	if(posix_memalign(&data, alignment, mBytes) != 0)
+		throw std::runtime_error("cannot allocate audio bus");
+	mBlock = (jack_default_audio_sample_t *)data;
+	//keep it in memory and touch every page so the callback never faults
+	mLocked = mlock(mBlock, mBytes) == 0;
+	memset(mBlock, 0, mBytes);
+	for(unsigned int i = 0; i < channels; i++)
+		mChannels[i] = mBlock + i * mStride;
+}
+
+JackCpp::AudioBus::~AudioBus(){
+	if(mBlock == NULL)
+		return;
+	if(mLocked)
+		munlock(mBlock, mBytes);
+	free(mBlock);
+}
+
+void JackCpp::AudioBus::gather(jack_default_audio_sample_t * const * ports, jack_nframes_t nframes){
+	bind(ports, nframes);
+	if(!mInBlock)
+		return;
+	for(unsigned int i = 0; i < mChannels.size(); i++)
+		memcpy(mChannels[i], ports[i], nframes * sizeof(jack_default_audio_sample_t));
+}
+
+void JackCpp::AudioBus::bind(jack_default_audio_sample_t * const * ports, jack_nframes_t nframes){
+	mFrames = nframes;
+	mInBlock = mBlock != NULL && nframes <= mMaxFrames;
+	for(unsigned int i = 0; i < mChannels.size(); i++){
+		mPorts[i] = ports[i];
+		mChannels[i] = mInBlock ? mBlock + i * mStride : ports[i];
+	}
+}
+
+void JackCpp::AudioBus::scatter(){
+	if(!mInBlock)
+		return;
+	for(unsigned int i = 0; i < mChannels.size(); i++)
+		memcpy(mPorts[i], mChannels[i], mFrames * sizeof(jack_default_audio_sample_t));
+}
+
+void JackCpp::mixMatrix(const AudioBus& in, AudioBus& out, const float * gains){
+	const unsigned int ins = in.channelCount();
+	const jack_nframes_t nframes = std::min(in.frames(), out.frames());
+	const bool aligned = in.contiguous() && out.contiguous();
+	for(unsigned int o = 0; o < out.channelCount(); o++){
+		jack_default_audio_sample_t * dest = out.channel(o);
+		const float * row = gains + o * ins;
+		memset(dest, 0, nframes * sizeof(jack_default_audio_sample_t));
+		for(unsigned int i = 0; i < ins; i++){
+			if(row[i] != 0.0f)
+				mix_in(dest, in.channel(i), row[i], nframes, aligned);
+		}
+	}
+}
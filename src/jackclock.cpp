@@ -0,0 +1,97 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackclock.hpp"
+#include <math.h>
+#include <stdint.h>
+
+namespace {
+	//restart the loop if a cycle is this many periods off the prediction
+	const double max_error_periods = 0.5;
+}
+
+JackCpp::FrameClock::FrameClock(double bandwidth) :
+	mBandwidth(bandwidth), mRunning(false), mNextFrame(0),
+	mT0(0.0), mT1(0.0), mE2(0.0)
+{
+	estimate_t e;
+	e.valid = false;
+	e.frame = 0;
+	e.usecs = 0.0;
+	e.usecsPerFrame = 0.0;
+	e.times.frames = 0;
+	e.times.usecs = e.times.nextUsecs = 0;
+	e.times.periodUsecs = 0.0f;
+	mShared.write(e);
+}
+
+//see Fons Adriaensen, "Using a DLL to filter time"
+void JackCpp::FrameClock::update(const CycleTimes& times, jack_nframes_t nframes, jack_nframes_t sampleRate){
+	if(nframes == 0 || sampleRate == 0)
+		return;
+	double t = (double)times.usecs;
+	double period = 1000000.0 * nframes / sampleRate;
+	if(mRunning && times.frames == mNextFrame){
+		double e = t - mT1;
+		if(fabs(e) > max_error_periods * period)
+			mRunning = false;
+		else {
+			double omega = 2.0 * M_PI * mBandwidth * period / 1000000.0;
+			mT0 = mT1;
+			mT1 += sqrt(2.0) * omega * e + mE2;
+			mE2 += omega * omega * e;
+		}
+	} else
+		mRunning = false;
+	if(!mRunning){
+		mE2 = period;
+		mT0 = t;
+		mT1 = t + period;
+		mRunning = true;
+	}
+	mNextFrame = times.frames + nframes;
+
+	estimate_t est;
+	est.valid = true;
+	est.frame = times.frames;
+	est.usecs = mT0;
+	//the loop's filtered period, t1 - t0 also carries this cycle's correction
+	est.usecsPerFrame = mE2 / nframes;
+	est.times = times;
+	mShared.write(est);
+}
+
+jack_time_t JackCpp::FrameClock::framesToTime(jack_nframes_t frames) const {
+	estimate_t est = mShared.read();
+	//the difference is signed so frames before the cycle work, and wrap around
+	double offset = (double)(int32_t)(frames - est.frame) * est.usecsPerFrame;
+	return (jack_time_t)floor(est.usecs + offset + 0.5);
+}
+
+jack_nframes_t JackCpp::FrameClock::timeToFrames(jack_time_t usecs) const {
+	estimate_t est = mShared.read();
+	if(est.usecsPerFrame <= 0.0)
+		return est.frame;
+	double offset = ((double)usecs - est.usecs) / est.usecsPerFrame;
+	return est.frame + (jack_nframes_t)(int32_t)floor(offset + 0.5);
+}
+
+double JackCpp::FrameClock::sampleRate() const {
+	estimate_t est = mShared.read();
+	return (est.usecsPerFrame > 0.0) ? 1000000.0 / est.usecsPerFrame : 0.0;
+}
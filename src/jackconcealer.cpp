@@ -0,0 +1,144 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackconcealer.hpp"
+#include <string.h>
+#include <algorithm>
+
+JackCpp::GapConcealer::GapConcealer(unsigned int channels, mode_t mode,
+		unsigned int rampFrames, unsigned int repeatFrames) :
+	mChannels(channels), mMode(mode),
+	mRampFrames(std::max(rampFrames, 1u)),
+	//fade mode only needs the last sample before a gap
+	mRepeatFrames((mode == repeat) ? std::max(repeatFrames, 1u) : 1),
+	mRamp(mRampFrames),
+	mHistory(mChannels * mRepeatFrames, 0.0f),
+	mSegment(mChannels * mRepeatFrames, 0.0f),
+	mHold(mChannels, 0.0f),
+	mInGap(false), mGapPos(0),
+	mScratch(mChannels * mRampFrames, 0.0f),
+	mScratchBufs(mChannels)
+{
+	for(unsigned int i = 0; i < mRampFrames; i++)
+		mRamp[i] = (jack_default_audio_sample_t)(i + 1) / (mRampFrames + 1);
+	for(unsigned int c = 0; c < mChannels; c++)
+		mScratchBufs[c] = &mScratch[c * mRampFrames];
+}
+
+void JackCpp::GapConcealer::fillGap(jack_default_audio_sample_t * const * bufs,
+		unsigned int valid, unsigned int nframes){
+	if(mMode == silence){
+		for(unsigned int c = 0; c < mChannels; c++)
+			memset(bufs[c] + valid, 0, (nframes - valid) * sizeof(jack_default_audio_sample_t));
+		return;
+	}
+
+	//the data is back, fade it in
+	if(mInGap && valid > 0){
+		unsigned int n = std::min(valid, mRampFrames);
+		for(unsigned int c = 0; c < mChannels; c++){
+			for(unsigned int j = 0; j < n; j++)
+				bufs[c][j] *= mRamp[j];
+		}
+		mInGap = false;
+	}
+
+	if(valid < nframes && !mInGap){
+		mInGap = true;
+		mGapPos = 0;
+		const unsigned int h = mRepeatFrames;
+		for(unsigned int c = 0; c < mChannels; c++){
+			const jack_default_audio_sample_t * history = &mHistory[c * h];
+			mHold[c] = (valid > 0) ? bufs[c][valid - 1] : history[h - 1];
+			if(mMode == fade && valid > 0){
+				//fade out what we have, the last frame gets the least gain
+				unsigned int n = std::min(valid, mRampFrames);
+				for(unsigned int j = 0; j < n; j++)
+					bufs[c][valid - 1 - j] *= mRamp[j];
+				mHold[c] = 0.0f;
+			} else if(mMode == repeat){
+				//the stretch just before the gap, some of it may be in this cycle
+				jack_default_audio_sample_t * segment = &mSegment[c * h];
+				for(unsigned int k = 0; k < h; k++){
+					int i = (int)valid - (int)h + (int)k;
+					segment[k] = (i >= 0) ? bufs[c][i] : history[h + i];
+				}
+			}
+		}
+	}
+	if(valid < nframes)
+		conceal(bufs, valid, nframes);
+
+	remember(bufs, nframes);
+}
+
+void JackCpp::GapConcealer::conceal(jack_default_audio_sample_t * const * bufs,
+		unsigned int from, unsigned int nframes){
+	const unsigned int r = mRampFrames;
+	const unsigned int h = mRepeatFrames;
+	for(unsigned int c = 0; c < mChannels; c++){
+		const jack_default_audio_sample_t * segment = &mSegment[c * h];
+		for(unsigned int j = from; j < nframes; j++){
+			unsigned int p = mGapPos + j - from;
+			jack_default_audio_sample_t v = 0.0f;
+			if(mMode == fade){
+				if(p < r)
+					v = mHold[c] * mRamp[r - 1 - p];
+			} else if(p < h){
+				//crossfade from the last sample into the repeat, and fade the repeat out
+				jack_default_audio_sample_t w = (p < r) ? mRamp[p] : 1.0f;
+				v = (segment[p] * w + mHold[c] * (1.0f - w)) * ((jack_default_audio_sample_t)(h - p) / (h + 1));
+			}
+			bufs[c][j] = v;
+		}
+	}
+	mGapPos += nframes - from;
+}
+
+void JackCpp::GapConcealer::remember(jack_default_audio_sample_t * const * bufs, unsigned int nframes){
+	const unsigned int h = mRepeatFrames;
+	for(unsigned int c = 0; c < mChannels; c++){
+		jack_default_audio_sample_t * history = &mHistory[c * h];
+		if(nframes >= h)
+			memcpy(history, bufs[c] + nframes - h, h * sizeof(jack_default_audio_sample_t));
+		else {
+			memmove(history, history + nframes, (h - nframes) * sizeof(jack_default_audio_sample_t));
+			memcpy(history + h - nframes, bufs[c], nframes * sizeof(jack_default_audio_sample_t));
+		}
+	}
+}
+
+jack_default_audio_sample_t * const * JackCpp::GapConcealer::rampInput(
+		jack_default_audio_sample_t * const * src,
+		unsigned int start, unsigned int cnt, unsigned int total,
+		bool fadeIn, bool fadeOut){
+	const unsigned int r = mRampFrames;
+	cnt = std::min(cnt, r);
+	for(unsigned int c = 0; c < mChannels; c++){
+		for(unsigned int j = 0; j < cnt; j++){
+			unsigned int f = start + j;
+			jack_default_audio_sample_t g = 1.0f;
+			if(fadeIn && f < r)
+				g *= mRamp[f];
+			if(fadeOut && total - 1 - f < r)
+				g *= mRamp[total - 1 - f];
+			mScratchBufs[c][j] = src[c][f] * g;
+		}
+	}
+	return &mScratchBufs[0];
+}
@@ -0,0 +1,292 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackconnections.hpp"
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <stdlib.h>
+#include <errno.h>
+#include <ctype.h>
+#include <fnmatch.h>
+#include <regex.h>
+
+namespace {
+	//compare names so that capture_2 comes before capture_10
+	bool natural_less(const std::string& a, const std::string& b){
+		size_t i = 0, j = 0;
+		while(i < a.size() && j < b.size()){
+			if(isdigit(a[i]) && isdigit(b[j])){
+				size_t si = i, sj = j;
+				while(i < a.size() && isdigit(a[i]))
+					i++;
+				while(j < b.size() && isdigit(b[j]))
+					j++;
+				unsigned long na = strtoul(a.substr(si, i - si).c_str(), NULL, 10);
+				unsigned long nb = strtoul(b.substr(sj, j - sj).c_str(), NULL, 10);
+				if(na != nb)
+					return na < nb;
+			} else {
+				if(a[i] != b[j])
+					return a[i] < b[j];
+				i++;
+				j++;
+			}
+		}
+		return (a.size() - i) < (b.size() - j);
+	}
+
+	//the names in candidates that match pattern
+	std::vector<std::string> match_ports(const std::string& pattern,
+			JackCpp::ConnectionSet::match_t match,
+			const std::vector<std::string>& candidates) JACKCPP_THROW(std::runtime_error) {
+		std::vector<std::string> matches;
+		if(match == JackCpp::ConnectionSet::exact){
+			matches.push_back(pattern);
+			return matches;
+		}
+
+		regex_t re;
+		if(match == JackCpp::ConnectionSet::regex &&
+				regcomp(&re, pattern.c_str(), REG_EXTENDED | REG_NOSUB) != 0)
+			throw std::runtime_error("invalid connection regular expression: " + pattern);
+
+		for(unsigned int i = 0; i < candidates.size(); i++){
+			bool found;
+			if(match == JackCpp::ConnectionSet::glob)
+				found = fnmatch(pattern.c_str(), candidates[i].c_str(), 0) == 0;
+			else
+				found = regexec(&re, candidates[i].c_str(), 0, NULL, 0) == 0;
+			if(found)
+				matches.push_back(candidates[i]);
+		}
+		if(match == JackCpp::ConnectionSet::regex)
+			regfree(&re);
+
+		std::sort(matches.begin(), matches.end(), natural_less);
+		return matches;
+	}
+
+	const char * match_names[] = {"exact", "glob", "regex"};
+}
+
+void JackCpp::ConnectionSet::add(std::string source, std::string destination, match_t match){
+	rule_t rule;
+	rule.source = source;
+	rule.destination = destination;
+	rule.match = match;
+	mRules.push_back(rule);
+}
+
+void JackCpp::ConnectionSet::clear(){
+	mRules.clear();
+}
+
+std::vector<JackCpp::ConnectionSet::connection_t> JackCpp::ConnectionSet::expand(PortRegistry& registry) const
+	JACKCPP_THROW(std::runtime_error)
+{
+	std::vector<connection_t> connections;
+	std::vector<std::string> sources;
+	std::vector<std::string> destinations;
+	//only look the candidates up if there is a pattern to match against them
+	for(unsigned int i = 0; i < mRules.size(); i++){
+		if(mRules[i].match != exact){
+			sources = registry.ports(JackPortIsOutput);
+			destinations = registry.ports(JackPortIsInput);
+			break;
+		}
+	}
+
+	for(unsigned int i = 0; i < mRules.size(); i++){
+		std::vector<std::string> src = match_ports(mRules[i].source, mRules[i].match, sources);
+		std::vector<std::string> dst = match_ports(mRules[i].destination, mRules[i].match, destinations);
+		if(src.empty() || dst.empty())
+			continue;
+
+		unsigned int cnt;
+		if(src.size() == 1 || dst.size() == 1)
+			cnt = std::max(src.size(), dst.size());
+		else
+			cnt = std::min(src.size(), dst.size());
+		for(unsigned int j = 0; j < cnt; j++){
+			connection_t c;
+			c.source = src[(src.size() == 1) ? 0 : j];
+			c.destination = dst[(dst.size() == 1) ? 0 : j];
+			connections.push_back(c);
+		}
+	}
+	return connections;
+}
+
+void JackCpp::ConnectionSet::write(std::ostream& out) const {
+	for(unsigned int i = 0; i < mRules.size(); i++)
+		out << match_names[mRules[i].match] << "\t" << mRules[i].source << "\t" << mRules[i].destination << std::endl;
+}
+
+void JackCpp::ConnectionSet::read(std::istream& in)
+	JACKCPP_THROW(std::runtime_error)
+{
+	std::string line;
+	while(std::getline(in, line)){
+		if(line.empty() || line[0] == '#')
+			continue;
+		size_t first = line.find('\t');
+		size_t second = (first == std::string::npos) ? first : line.find('\t', first + 1);
+		if(second == std::string::npos)
+			throw std::runtime_error("malformed connection line: " + line);
+
+		std::string type = line.substr(0, first);
+		match_t match;
+		if(type == match_names[exact])
+			match = exact;
+		else if(type == match_names[glob])
+			match = glob;
+		else if(type == match_names[regex])
+			match = regex;
+		else
+			throw std::runtime_error("unknown connection match type: " + type);
+		add(line.substr(first + 1, second - first - 1), line.substr(second + 1), match);
+	}
+}
+
+JackCpp::ConnectionJob::ConnectionJob(jack_client_t * client, PortRegistry& registry,
+		const ConnectionSet& set, const std::vector<std::string>& ownPorts,
+		bool exclusive, callback_t callback, void * arg)
+	JACKCPP_THROW(std::runtime_error) :
+	mClient(client), mRegistry(registry), mSet(set), mOwnPorts(ownPorts),
+	mExclusive(exclusive), mCallback(callback), mCallbackArg(arg),
+	mJoined(false), mDone(false)
+{
+	if(pthread_create(&mThread, NULL, ConnectionJob::run, this) != 0)
+		throw std::runtime_error("cannot start connection thread");
+}
+
+JackCpp::ConnectionJob::~ConnectionJob(){
+	wait();
+}
+
+void JackCpp::ConnectionJob::wait(){
+	if(mJoined)
+		return;
+	//from the callback the job is done, and the thread can't join itself
+	if(pthread_equal(pthread_self(), mThread))
+		pthread_detach(mThread);
+	else
+		pthread_join(mThread, NULL);
+	mJoined = true;
+}
+
+bool JackCpp::ConnectionJob::done() const {
+	return mDone;
+}
+
+unsigned int JackCpp::ConnectionJob::failures() const {
+	unsigned int cnt = 0;
+	for(unsigned int i = 0; i < mResults.size(); i++){
+		if(mResults[i].status == failed)
+			cnt++;
+	}
+	return cnt;
+}
+
+void * JackCpp::ConnectionJob::run(void * arg){
+	((ConnectionJob *)arg)->apply();
+	return NULL;
+}
+
+void JackCpp::ConnectionJob::apply(){
+	typedef std::pair<std::string, std::string> pair_t;
+	std::vector<ConnectionSet::connection_t> wanted;
+	try {
+		wanted = mSet.expand(mRegistry);
+	} catch (std::runtime_error& e){
+		//without the wanted set an exclusive job would disconnect everything
+		mError = e.what();
+		finish();
+		return;
+	}
+
+	//find out what our ports are connected to now
+	std::set<pair_t> existing;
+	for(unsigned int i = 0; i < mOwnPorts.size(); i++){
+		jack_port_t * port = jack_port_by_name(mClient, mOwnPorts[i].c_str());
+		if(port == NULL)
+			continue;
+		bool output = (jack_port_flags(port) & JackPortIsOutput) != 0;
+		const char ** connections = jack_port_get_all_connections(mClient, port);
+		if(connections == NULL)
+			continue;
+		for(unsigned int j = 0; connections[j] != NULL; j++){
+			if(output)
+				existing.insert(pair_t(mOwnPorts[i], connections[j]));
+			else
+				existing.insert(pair_t(connections[j], mOwnPorts[i]));
+		}
+		free(connections);
+	}
+
+	std::set<pair_t> wantedSet;
+	for(unsigned int i = 0; i < wanted.size(); i++){
+		pair_t p(wanted[i].source, wanted[i].destination);
+		if(!wantedSet.insert(p).second)
+			continue;
+
+		result_t result;
+		result.source = p.first;
+		result.destination = p.second;
+		result.error = 0;
+
+		bool connectedAlready = existing.find(p) != existing.end();
+		if(!connectedAlready){
+			//the connection may not involve our ports
+			jack_port_t * src = jack_port_by_name(mClient, p.first.c_str());
+			connectedAlready = src != NULL && jack_port_connected_to(src, p.second.c_str());
+		}
+		if(connectedAlready)
+			result.status = alreadyConnected;
+		else {
+			result.error = jack_connect(mClient, p.first.c_str(), p.second.c_str());
+			result.status = (result.error == 0 || result.error == EEXIST) ? connected : failed;
+		}
+		mResults.push_back(result);
+	}
+
+	if(mExclusive){
+		for(std::set<pair_t>::iterator it = existing.begin(); it != existing.end(); it++){
+			if(wantedSet.find(*it) != wantedSet.end())
+				continue;
+			result_t result;
+			result.source = it->first;
+			result.destination = it->second;
+			result.error = jack_disconnect(mClient, it->first.c_str(), it->second.c_str());
+			result.status = (result.error == 0) ? disconnected : failed;
+			mResults.push_back(result);
+		}
+	}
+
+	finish();
+}
+
+void JackCpp::ConnectionJob::finish(){
+	__sync_synchronize();
+	mDone = true;
+	//the callback may delete us, so it has to be the last thing we do
+	if(mCallback != NULL)
+		mCallback(this, mCallbackArg);
+}
+
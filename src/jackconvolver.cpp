@@ -0,0 +1,532 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackconvolver.hpp"
+#include <algorithm>
+#include <string.h>
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define JACKCPP_HAVE_SSE
+#endif
+
+namespace {
+	//ticket layout, the block in the top bits, then the slot, then the next channel
+	const unsigned int ticket_channel_bits = 16;
+	const unsigned int ticket_channel_mask = (1u << ticket_channel_bits) - 1;
+	const unsigned int ticket_slot_bit = 1u << ticket_channel_bits;
+	const unsigned int ticket_block_shift = ticket_channel_bits + 1;
+	const unsigned int ticket_block_mask = (1u << (32 - ticket_block_shift)) - 1;
+
+	//bins padded so that every partition starts on a multiple of 4
+	unsigned int padded(unsigned int bins){
+		return (bins + 3) & ~3u;
+	}
+
+	bool power_of_two(unsigned int n){
+		return n != 0 && (n & (n - 1)) == 0;
+	}
+
+	//acc += x * h over bins complex values, in split form, bins a multiple of 4
+	void multiply_add(float * accRe, float * accIm,
+			const float * xRe, const float * xIm,
+			const float * hRe, const float * hIm, unsigned int bins){
+		unsigned int k = 0;
+#ifdef JACKCPP_HAVE_SSE
+		for(; k < bins; k += 4){
+			__m128 xr = _mm_loadu_ps(xRe + k);
+			__m128 xi = _mm_loadu_ps(xIm + k);
+			__m128 hr = _mm_loadu_ps(hRe + k);
+			__m128 hi = _mm_loadu_ps(hIm + k);
+			__m128 re = _mm_sub_ps(_mm_mul_ps(xr, hr), _mm_mul_ps(xi, hi));
+			__m128 im = _mm_add_ps(_mm_mul_ps(xr, hi), _mm_mul_ps(xi, hr));
+			_mm_storeu_ps(accRe + k, _mm_add_ps(_mm_loadu_ps(accRe + k), re));
+			_mm_storeu_ps(accIm + k, _mm_add_ps(_mm_loadu_ps(accIm + k), im));
+		}
+#endif
+		for(; k < bins; k++){
+			accRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+			accIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+		}
+	}
+
+	//the spectra of partitions of ir, each half the transform size and zero
+	//padded, scaled so that an inverse transform gives the right level
+	void partition(JackCpp::RealFFT& fft, const float * ir, unsigned int length,
+			JackCpp::Convolver::spectra_t& spectra){
+		const unsigned int size = fft.size() / 2;
+		const unsigned int stride = padded(fft.bins());
+		const float scale = 2.0f / fft.size();
+		std::vector<float> block(fft.size());
+		spectra.parts = (length + size - 1) / size;
+		spectra.re.assign(spectra.parts * stride, 0.0f);
+		spectra.im.assign(spectra.parts * stride, 0.0f);
+		for(unsigned int p = 0; p < spectra.parts; p++){
+			std::fill(block.begin(), block.end(), 0.0f);
+			unsigned int start = p * size;
+			unsigned int cnt = std::min(size, length - start);
+			for(unsigned int i = 0; i < cnt; i++)
+				block[i] = ir[start + i] * scale;
+			fft.forward(&block[0], &spectra.re[p * stride], &spectra.im[p * stride]);
+		}
+	}
+}
+
+JackCpp::Convolver::worker_t::~worker_t(){
+	for(unsigned int i = 0; i < ffts.size(); i++)
+		delete ffts[i];
+}
+
+JackCpp::Convolver::Convolver(unsigned int blockSize, unsigned int maxBlockSize, unsigned int threads,
+		const ThreadConfig& workerConfig)
+	JACKCPP_THROW(std::runtime_error) :
+	mBlockSize(blockSize), mStarted(false),
+	mHeadFFT(power_of_two(blockSize) && blockSize >= 2 ? 2 * blockSize : 4),
+	mLateBlocks(0), mWorkerConfig(workerConfig), mRunning(true)
+{
+	if(maxBlockSize == 0)
+		maxBlockSize = 64 * blockSize;
+	if(!power_of_two(mBlockSize) || mBlockSize < 2)
+		throw std::runtime_error("the convolver block size must be a power of two");
+	if(!power_of_two(maxBlockSize) || maxBlockSize < mBlockSize)
+		throw std::runtime_error("the largest convolver partition must be a power of two multiple of the block size");
+	if(threads == 0)
+		throw std::runtime_error("the convolver needs at least one thread");
+
+	//each level's partitions are four times the size of the last level's,
+	//and start twice their size into the impulse
+	for(unsigned int size = std::min(4 * mBlockSize, maxBlockSize); size > mBlockSize;
+			size = (size == maxBlockSize) ? 0 : std::min(4 * size, maxBlockSize)){
+		level_t level;
+		level.size = size;
+		level.bins = padded(size + 1);
+		level.start = 2 * size;
+		level.end = 0xffffffff;
+		if(!mLevels.empty())
+			mLevels.back().end = level.start;
+		level.fill = level.fillSlot = level.blocks = 0;
+		level.issuedBlock = level.issuedSlot = level.playSlot = 0;
+		level.valid = false;
+		level.ticket = ticket_channel_mask;
+		level.jobsDone = level.jobChannels = 0;
+		mLevels.push_back(level);
+	}
+	mHeadEnd = mLevels.empty() ? 0xffffffff : mLevels[0].start;
+	mHeadBins = padded(mBlockSize + 1);
+	mTime.resize(2 * mBlockSize);
+	mAccRe.resize(mHeadBins);
+	mAccIm.resize(mHeadBins);
+
+	if(mLevels.empty())
+		return;
+	const unsigned int largest = mLevels.back().size;
+	for(unsigned int i = 0; i < threads; i++){
+		worker_t * w = new worker_t;
+		w->convolver = this;
+		for(unsigned int l = 0; l < mLevels.size(); l++)
+			w->ffts.push_back(new RealFFT(2 * mLevels[l].size));
+		w->time.resize(2 * largest);
+		w->accRe.resize(padded(largest + 1));
+		w->accIm.resize(padded(largest + 1));
+		if(pthread_create(&w->thread, NULL, Convolver::runWorker, w) != 0){
+			delete w;
+			stopWorkers();
+			throw std::runtime_error("cannot start convolver thread");
+		}
+		mWorkers.push_back(w);
+	}
+}
+
+JackCpp::Convolver::~Convolver(){
+	stopWorkers();
+	for(unsigned int i = 0; i < mChannels.size(); i++)
+		delete mChannels[i];
+	mChannels.clear();
+	for(unsigned int i = 0; i < mImpulses.size(); i++)
+		delete mImpulses[i];
+	mImpulses.clear();
+}
+
+void JackCpp::Convolver::stopWorkers(){
+	mRunning = false;
+	__sync_synchronize();
+	for(unsigned int i = 0; i < mWorkers.size(); i++){
+		mWorkers[i]->wake.notify();
+		pthread_join(mWorkers[i]->thread, NULL);
+		delete mWorkers[i];
+	}
+	mWorkers.clear();
+}
+
+unsigned int JackCpp::Convolver::addImpulse(const float * ir, unsigned int length)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(mStarted)
+		throw std::runtime_error("impulses must be added before the convolver starts");
+	impulse_t * imp = new impulse_t;
+	unsigned int headLength = std::min(length, mHeadEnd);
+	partition(mHeadFFT, ir, headLength, imp->head);
+	imp->levels.resize(mLevels.size());
+	for(unsigned int l = 0; l < mLevels.size(); l++){
+		const level_t& level = mLevels[l];
+		unsigned int end = std::min(length, level.end);
+		if(end <= level.start){
+			imp->levels[l].parts = 0;
+			continue;
+		}
+		RealFFT fft(2 * level.size);
+		partition(fft, ir + level.start, end - level.start, imp->levels[l]);
+	}
+	mImpulses.push_back(imp);
+	return mImpulses.size() - 1;
+}
+
+unsigned int JackCpp::Convolver::addChannel(unsigned int impulse)
+	JACKCPP_THROW(std::range_error, std::runtime_error)
+{
+	if(impulse >= mImpulses.size())
+		throw std::range_error("no such impulse");
+	if(mStarted)
+		throw std::runtime_error("channels must be added before the convolver starts");
+	if(mChannels.size() >= ticket_channel_mask)
+		throw std::runtime_error("too many convolver channels");
+	const impulse_t * imp = mImpulses[impulse];
+	channel_t * ch = new channel_t;
+	ch->impulse = imp;
+	ch->headIn.assign(2 * mBlockSize, 0.0f);
+	ch->head.re.assign(std::max(1u, imp->head.parts) * mHeadBins, 0.0f);
+	ch->head.im.assign(std::max(1u, imp->head.parts) * mHeadBins, 0.0f);
+	ch->head.pos = 0;
+	ch->levels.resize(mLevels.size());
+	for(unsigned int l = 0; l < mLevels.size(); l++){
+		const unsigned int parts = imp->levels[l].parts;
+		if(parts == 0)
+			continue;
+		const unsigned int size = mLevels[l].size;
+		channel_level_t& cl = ch->levels[l];
+		for(unsigned int s = 0; s < 2; s++){
+			cl.in[s].assign(size, 0.0f);
+			cl.out[s].assign(size, 0.0f);
+		}
+		cl.prev.assign(size, 0.0f);
+		cl.line.re.assign(parts * mLevels[l].bins, 0.0f);
+		cl.line.im.assign(parts * mLevels[l].bins, 0.0f);
+		cl.line.pos = 0;
+		cl.lastBlock = 0;
+		cl.started = false;
+	}
+	mChannels.push_back(ch);
+	return mChannels.size() - 1;
+}
+
+bool JackCpp::Convolver::process(const float * const * in, float * const * out, unsigned int nframes,
+		bool waitForTail){
+	const unsigned int count = mChannels.size();
+	mStarted = true;
+	if(nframes % mBlockSize != 0){
+		for(unsigned int c = 0; c < count; c++)
+			memset(out[c], 0, nframes * sizeof(float));
+		return false;
+	}
+	const size_t blockBytes = mBlockSize * sizeof(float);
+	for(unsigned int pos = 0; pos < nframes; pos += mBlockSize){
+		for(unsigned int c = 0; c < count; c++){
+			channel_t * ch = mChannels[c];
+			const impulse_t * imp = ch->impulse;
+			//the levels get the input before out, which may be the same buffer, is written
+			for(unsigned int l = 0; l < mLevels.size(); l++){
+				if(imp->levels[l].parts > 0)
+					memcpy(&ch->levels[l].in[mLevels[l].fillSlot][mLevels[l].fill], in[c] + pos, blockBytes);
+			}
+
+			//the head, in the callback
+			float * headIn = &ch->headIn[0];
+			memcpy(headIn + mBlockSize, in[c] + pos, blockBytes);
+			if(imp->head.parts > 0){
+				delay_line_t& line = ch->head;
+				mHeadFFT.forward(headIn, &line.re[line.pos * mHeadBins], &line.im[line.pos * mHeadBins]);
+				accumulate(line, imp->head, mHeadBins, &mAccRe[0], &mAccIm[0]);
+				mHeadFFT.inverse(&mAccRe[0], &mAccIm[0], &mTime[0]);
+				memcpy(out[c] + pos, &mTime[mBlockSize], blockBytes);
+				line.pos = (line.pos + 1) % imp->head.parts;
+			} else
+				memset(out[c] + pos, 0, blockBytes);
+			memcpy(headIn, headIn + mBlockSize, blockBytes);
+
+			//the blocks the threads finished in time
+			for(unsigned int l = 0; l < mLevels.size(); l++){
+				const level_t& level = mLevels[l];
+				if(!level.valid || imp->levels[l].parts == 0)
+					continue;
+				const float * done = &ch->levels[l].out[level.playSlot][level.fill];
+				float * dest = out[c] + pos;
+				for(unsigned int j = 0; j < mBlockSize; j++)
+					dest[j] += done[j];
+			}
+		}
+
+		for(unsigned int l = 0; l < mLevels.size(); l++){
+			level_t& level = mLevels[l];
+			level.fill += mBlockSize;
+			if(level.fill == level.size){
+				level.fill = 0;
+				startBlock(level, waitForTail);
+			}
+		}
+	}
+	return true;
+}
+
+void JackCpp::Convolver::startBlock(level_t& level, bool waitForTail){
+	const unsigned int block = level.blocks++;
+	bool done = level.jobsDone == level.jobChannels;
+	if(!done && waitForTail){
+		while(level.jobsDone != level.jobChannels)
+			mDone.wait(10);
+		done = true;
+	}
+	__sync_synchronize();
+	//a block's output plays two blocks after its input, which is the block after this one
+	level.valid = done && level.jobChannels > 0 && level.issuedBlock + 1 == block;
+	level.playSlot = level.issuedSlot;
+	if(!done){
+		//the threads are still using the other slot, so this block is left out
+		mLateBlocks++;
+		return;
+	}
+	level.issuedBlock = block;
+	level.issuedSlot = level.fillSlot;
+	level.fillSlot ^= 1;
+	level.jobsDone = 0;
+	level.jobChannels = mChannels.size();
+	__sync_synchronize();
+	level.ticket = ((block & ticket_block_mask) << ticket_block_shift) | (level.issuedSlot ? ticket_slot_bit : 0);
+	__sync_synchronize();
+	for(unsigned int i = 0; i < mWorkers.size(); i++)
+		mWorkers[i]->wake.notify();
+}
+
+void * JackCpp::Convolver::runWorker(void * arg){
+	worker_t * w = (worker_t *)arg;
+	applyThreadConfig(w->convolver->mWorkerConfig);
+	w->convolver->work(w);
+	return NULL;
+}
+
+void JackCpp::Convolver::work(worker_t * w){
+	while(mRunning){
+		if(!w->wake.wait(100))
+			continue;
+		//always go back to the smallest level, its blocks are due soonest
+		bool busy = true;
+		while(busy && mRunning){
+			busy = false;
+			for(unsigned int l = 0; l < mLevels.size() && !busy; l++)
+				busy = takeJob(w, l);
+		}
+	}
+}
+
+bool JackCpp::Convolver::takeJob(worker_t * w, unsigned int l){
+	level_t& level = mLevels[l];
+	unsigned int ticket;
+	do {
+		ticket = level.ticket;
+		if((ticket & ticket_channel_mask) >= mChannels.size())
+			return false;
+	} while(!__sync_bool_compare_and_swap(&level.ticket, ticket, ticket + 1));
+
+	channel_t * ch = mChannels[ticket & ticket_channel_mask];
+	if(ch->impulse->levels[l].parts > 0)
+		processLevel(w, l, ch, ticket >> ticket_block_shift, (ticket & ticket_slot_bit) ? 1 : 0);
+	if(__sync_add_and_fetch(&level.jobsDone, 1) == mChannels.size())
+		mDone.notify();
+	return true;
+}
+
+void JackCpp::Convolver::processLevel(worker_t * w, unsigned int l, channel_t * ch,
+		unsigned int block, unsigned int slot){
+	const spectra_t& spectra = ch->impulse->levels[l];
+	const unsigned int size = mLevels[l].size;
+	const unsigned int bins = mLevels[l].bins;
+	channel_level_t& cl = ch->levels[l];
+	delay_line_t& line = cl.line;
+	//blocks that were left out count as silence, so the delay line stays in time
+	unsigned int skipped = cl.started ? ((block - cl.lastBlock - 1) & ticket_block_mask) : 0;
+	if(skipped > 0){
+		std::fill(cl.prev.begin(), cl.prev.end(), 0.0f);
+		for(unsigned int i = 0; i < std::min(skipped, spectra.parts); i++){
+			memset(&line.re[line.pos * bins], 0, bins * sizeof(float));
+			memset(&line.im[line.pos * bins], 0, bins * sizeof(float));
+			line.pos = (line.pos + 1) % spectra.parts;
+		}
+	}
+	cl.started = true;
+	cl.lastBlock = block;
+
+	float * time = &w->time[0];
+	memcpy(time, &cl.prev[0], size * sizeof(float));
+	memcpy(time + size, &cl.in[slot][0], size * sizeof(float));
+	memcpy(&cl.prev[0], time + size, size * sizeof(float));
+	w->ffts[l]->forward(time, &line.re[line.pos * bins], &line.im[line.pos * bins]);
+	accumulate(line, spectra, bins, &w->accRe[0], &w->accIm[0]);
+	w->ffts[l]->inverse(&w->accRe[0], &w->accIm[0], time);
+	memcpy(&cl.out[slot][0], time + size, size * sizeof(float));
+	line.pos = (line.pos + 1) % spectra.parts;
+}
+
+void JackCpp::Convolver::accumulate(const delay_line_t& line, const spectra_t& spectra,
+		unsigned int bins, float * accRe, float * accIm){
+	memset(accRe, 0, bins * sizeof(float));
+	memset(accIm, 0, bins * sizeof(float));
+	//the newest input goes with the first partition, the oldest with the last
+	for(unsigned int p = 0, d = line.pos; p < spectra.parts; p++){
+		multiply_add(accRe, accIm, &line.re[d * bins], &line.im[d * bins],
+				&spectra.re[p * bins], &spectra.im[p * bins], bins);
+		d = (d == 0) ? spectra.parts - 1 : d - 1;
+	}
+}
+
+JackCpp::ConvolverAudioIO::ConvolverAudioIO(std::string name, unsigned int channels, unsigned int threads,
+		unsigned int maxFactor, bool startServer)
+	JACKCPP_THROW(std::runtime_error) :
+	AudioIO(name, channels, channels, startServer),
+	mThreads(threads), mMaxFactor(maxFactor), mChannelImpulse(channels, -1), mNewest(NULL)
+{
+	pthread_mutex_init(&mUpdateLock, NULL);
+}
+
+JackCpp::ConvolverAudioIO::~ConvolverAudioIO(){
+	//stop the callback before the convolver goes away
+	if(getState() == AudioIO::active)
+		stop();
+	pthread_mutex_destroy(&mUpdateLock);
+}
+
+unsigned int JackCpp::ConvolverAudioIO::addImpulse(const std::vector<float>& ir){
+	pthread_mutex_lock(&mUpdateLock);
+	mImpulses.push_back(ir);
+	unsigned int index = mImpulses.size() - 1;
+	pthread_mutex_unlock(&mUpdateLock);
+	return index;
+}
+
+void JackCpp::ConvolverAudioIO::setChannelImpulse(unsigned int channel, unsigned int impulse)
+	JACKCPP_THROW(std::range_error)
+{
+	pthread_mutex_lock(&mUpdateLock);
+	bool ok = channel < mChannelImpulse.size() && impulse < mImpulses.size();
+	if(ok)
+		mChannelImpulse[channel] = impulse;
+	pthread_mutex_unlock(&mUpdateLock);
+	if(!ok)
+		throw std::range_error("no such channel or impulse");
+}
+
+JackCpp::Convolver * JackCpp::ConvolverAudioIO::createConvolver(jack_nframes_t nframes)
+	JACKCPP_THROW(std::runtime_error)
+{
+	Convolver * conv = new Convolver(nframes, mMaxFactor * nframes, mThreads);
+	try {
+		//silent channels get an empty impulse, so the channels line up with the ports
+		const float none = 0.0f;
+		unsigned int silent = conv->addImpulse(&none, 1);
+		std::vector<unsigned int> loaded(mImpulses.size());
+		for(unsigned int i = 0; i < mImpulses.size(); i++)
+			loaded[i] = mImpulses[i].empty() ? silent : conv->addImpulse(&mImpulses[i][0], mImpulses[i].size());
+		for(unsigned int i = 0; i < mChannelImpulse.size(); i++)
+			conv->addChannel(mChannelImpulse[i] < 0 ? silent : loaded[mChannelImpulse[i]]);
+	} catch (...){
+		delete conv;
+		throw;
+	}
+	return conv;
+}
+
+void JackCpp::ConvolverAudioIO::update()
+	JACKCPP_THROW(std::runtime_error)
+{
+	pthread_mutex_lock(&mUpdateLock);
+	try {
+		Convolver * conv = createConvolver(getBufferSize());
+		if(callbacksLive()){
+			if(!mConvolver.publish(conv)){
+				delete conv;
+				throw std::runtime_error("too many convolver updates waiting for the callback");
+			}
+		} else
+			mConvolver.reset(conv);
+		mNewest = conv;
+	} catch (...){
+		pthread_mutex_unlock(&mUpdateLock);
+		throw;
+	}
+	pthread_mutex_unlock(&mUpdateLock);
+}
+
+unsigned int JackCpp::ConvolverAudioIO::lateBlocks(){
+	pthread_mutex_lock(&mUpdateLock);
+	unsigned int late = (mNewest == NULL) ? 0 : mNewest->lateBlocks();
+	pthread_mutex_unlock(&mUpdateLock);
+	return late;
+}
+
+unsigned int JackCpp::ConvolverAudioIO::addInPort(std::string /* name */)
+	JACKCPP_THROW(std::runtime_error)
+{
+	throw std::runtime_error("cannot add ports to a ConvolverAudioIO");
+}
+
+unsigned int JackCpp::ConvolverAudioIO::addOutPort(std::string /* name */)
+	JACKCPP_THROW(std::runtime_error)
+{
+	throw std::runtime_error("cannot add ports to a ConvolverAudioIO");
+}
+
+int JackCpp::ConvolverAudioIO::jackBufferSizeCallback(jack_nframes_t nframes){
+	int ret = AudioIO::jackBufferSizeCallback(nframes);
+	pthread_mutex_lock(&mUpdateLock);
+	if(mNewest != NULL){
+		try {
+			Convolver * conv = createConvolver(nframes);
+			if(mConvolver.publish(conv))
+				mNewest = conv;
+			else {
+				delete conv;
+				ret = 1;
+			}
+		} catch (std::runtime_error&){
+			ret = 1;
+		}
+	}
+	pthread_mutex_unlock(&mUpdateLock);
+	return ret;
+}
+
+int JackCpp::ConvolverAudioIO::processAudio(jack_nframes_t nframes,
+		const audioBufVector& inBufs,
+		const audioBufVector& outBufs){
+	Convolver * conv = mConvolver.acquire();
+	if(conv == NULL || conv->channels() != outBufs.size() || inBufs.size() != outBufs.size()){
+		for(unsigned int i = 0; i < outBufs.size(); i++)
+			memset(outBufs[i], 0, nframes * sizeof(jack_default_audio_sample_t));
+		return 0;
+	}
+	conv->process(&inBufs[0], &outBufs[0], nframes, isFreewheeling());
+	return 0;
+}
@@ -0,0 +1,170 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackfft.hpp"
+#include <math.h>
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define JACKCPP_HAVE_SSE
+#endif
+
+JackCpp::RealFFT::RealFFT(unsigned int size) JACKCPP_THROW(std::runtime_error) :
+	mSize(size), mHalf(size / 2)
+{
+	if(size < 4 || (size & (size - 1)) != 0)
+		throw std::runtime_error("the FFT size must be a power of two of at least 4");
+	unsigned int bits = 0;
+	while((1u << bits) < mHalf)
+		bits++;
+	mBitReverse.resize(mHalf);
+	for(unsigned int i = 0; i < mHalf; i++){
+		unsigned int r = 0;
+		for(unsigned int b = 0; b < bits; b++)
+			r |= ((i >> b) & 1) << (bits - 1 - b);
+		mBitReverse[i] = r;
+	}
+	for(unsigned int len = 8; len <= mHalf; len <<= 1){
+		for(unsigned int j = 0; j < len / 2; j++){
+			mStageCos.push_back(cos(2.0 * M_PI * j / len));
+			mStageSin.push_back(sin(2.0 * M_PI * j / len));
+		}
+	}
+	mSplitCos.resize(mHalf + 1);
+	mSplitSin.resize(mHalf + 1);
+	for(unsigned int i = 0; i <= mHalf; i++){
+		mSplitCos[i] = cos(2.0 * M_PI * i / mSize);
+		mSplitSin[i] = sin(2.0 * M_PI * i / mSize);
+	}
+	mWorkRe.resize(mHalf);
+	mWorkIm.resize(mHalf);
+}
+
+void JackCpp::RealFFT::transform(bool inverse){
+	float * re = &mWorkRe[0];
+	float * im = &mWorkIm[0];
+	const float sign = inverse ? 1.0f : -1.0f;
+	//the first two stages have trivial twiddles
+	for(unsigned int a = 0; a + 1 < mHalf; a += 2){
+		float tr = re[a + 1], ti = im[a + 1];
+		re[a + 1] = re[a] - tr;
+		im[a + 1] = im[a] - ti;
+		re[a] += tr;
+		im[a] += ti;
+	}
+	for(unsigned int a = 0; a + 3 < mHalf; a += 4){
+		float tr = re[a + 2], ti = im[a + 2];
+		re[a + 2] = re[a] - tr;
+		im[a + 2] = im[a] - ti;
+		re[a] += tr;
+		im[a] += ti;
+		//times -i going forward, i going back
+		tr = -sign * im[a + 3];
+		ti = sign * re[a + 3];
+		re[a + 3] = re[a + 1] - tr;
+		im[a + 3] = im[a + 1] - ti;
+		re[a + 1] += tr;
+		im[a + 1] += ti;
+	}
+	//the rest in fours, the twiddles of each stage are stored one after another
+	const float * stageCos = &mStageCos[0];
+	const float * stageSin = &mStageSin[0];
+	for(unsigned int len = 8; len <= mHalf; len <<= 1){
+		const unsigned int half = len / 2;
+		for(unsigned int start = 0; start < mHalf; start += len){
+			float * ar = re + start;
+			float * ai = im + start;
+			float * br = ar + half;
+			float * bi = ai + half;
+#ifdef JACKCPP_HAVE_SSE
+			const __m128 s = _mm_set1_ps(sign);
+			for(unsigned int j = 0; j < half; j += 4){
+				__m128 wr = _mm_loadu_ps(stageCos + j);
+				__m128 wi = _mm_mul_ps(s, _mm_loadu_ps(stageSin + j));
+				__m128 xr = _mm_loadu_ps(br + j);
+				__m128 xi = _mm_loadu_ps(bi + j);
+				__m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+				__m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+				__m128 yr = _mm_loadu_ps(ar + j);
+				__m128 yi = _mm_loadu_ps(ai + j);
+				_mm_storeu_ps(br + j, _mm_sub_ps(yr, tr));
+				_mm_storeu_ps(bi + j, _mm_sub_ps(yi, ti));
+				_mm_storeu_ps(ar + j, _mm_add_ps(yr, tr));
+				_mm_storeu_ps(ai + j, _mm_add_ps(yi, ti));
+			}
+#else
+			for(unsigned int j = 0; j < half; j++){
+				float wr = stageCos[j];
+				float wi = sign * stageSin[j];
+				float tr = br[j] * wr - bi[j] * wi;
+				float ti = br[j] * wi + bi[j] * wr;
+				br[j] = ar[j] - tr;
+				bi[j] = ai[j] - ti;
+				ar[j] += tr;
+				ai[j] += ti;
+			}
+#endif
+		}
+		stageCos += half;
+		stageSin += half;
+	}
+}
+
+void JackCpp::RealFFT::forward(const float * in, float * re, float * im){
+	//pack the even samples into the real part and the odd into the imaginary
+	for(unsigned int i = 0; i < mHalf; i++){
+		mWorkRe[mBitReverse[i]] = in[2 * i];
+		mWorkIm[mBitReverse[i]] = in[2 * i + 1];
+	}
+	transform(false);
+
+	//split the transforms of the even and odd samples back apart
+	re[0] = mWorkRe[0] + mWorkIm[0];
+	im[0] = 0.0f;
+	re[mHalf] = mWorkRe[0] - mWorkIm[0];
+	im[mHalf] = 0.0f;
+	for(unsigned int k = 1; k < mHalf; k++){
+		float ar = mWorkRe[k], ai = mWorkIm[k];
+		float br = mWorkRe[mHalf - k], bi = -mWorkIm[mHalf - k];
+		float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+		float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+		float c = mSplitCos[k], s = mSplitSin[k];
+		re[k] = er + c * or_ + s * oi;
+		im[k] = ei + c * oi - s * or_;
+	}
+}
+
+void JackCpp::RealFFT::inverse(const float * re, const float * im, float * out){
+	//rebuild the transform of the packed even and odd samples
+	for(unsigned int k = 0; k < mHalf; k++){
+		float ar = re[k], ai = im[k];
+		float br = re[mHalf - k], bi = -im[mHalf - k];
+		float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+		float dr = 0.5f * (ar - br), di = 0.5f * (ai - bi);
+		float c = mSplitCos[k], s = mSplitSin[k];
+		float or_ = dr * c - di * s, oi = dr * s + di * c;
+		unsigned int r = mBitReverse[k];
+		mWorkRe[r] = er - oi;
+		mWorkIm[r] = ei + or_;
+	}
+	transform(true);
+	for(unsigned int i = 0; i < mHalf; i++){
+		out[2 * i] = mWorkRe[i];
+		out[2 * i + 1] = mWorkIm[i];
+	}
+}
@@ -0,0 +1,209 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackfilesink.hpp"
+#include <algorithm>
+#include <string.h>
+
+namespace {
+	//the number of frames the writer converts at once
+	const unsigned int write_frames = 4096;
+	const size_t header_bytes = 44;
+
+	void put16(unsigned char * dest, uint16_t value){
+		dest[0] = value & 0xff;
+		dest[1] = (value >> 8) & 0xff;
+	}
+
+	void put32(unsigned char * dest, uint32_t value){
+		put16(dest, value & 0xffff);
+		put16(dest + 2, value >> 16);
+	}
+
+	//interleave cnt samples of the cycle into dest, starting at sample start,
+	//channels we weren't given are silent
+	void interleave(jack_default_audio_sample_t * dest, size_t cnt, size_t start,
+			jack_default_audio_sample_t * const * bufs, unsigned int channels,
+			unsigned int fileChannels){
+		size_t frame = start / fileChannels;
+		unsigned int chan = start % fileChannels;
+		for(size_t i = 0; i < cnt; i++){
+			dest[i] = (chan < channels) ? bufs[chan][frame] : 0.0f;
+			if(++chan == fileChannels){
+				chan = 0;
+				frame++;
+			}
+		}
+	}
+}
+
+JackCpp::WavFileSink::WavFileSink(std::string path, unsigned int channels,
+		jack_nframes_t sampleRate, format_t format, unsigned int bufferFrames)
+	JACKCPP_THROW(std::runtime_error) :
+	mFile(NULL), mChannels(channels), mSampleRate(sampleRate), mFormat(format),
+	mRing((size_t)std::max(bufferFrames, 1u) * std::max(channels, 1u), true),
+	mStop(false), mOpen(false),
+	mScratch(write_frames * std::max(channels, 1u)),
+	mFramesWritten(0), mFramesDropped(0), mWaits(0), mFailed(false)
+{
+	if(channels == 0)
+		throw std::runtime_error("a wav file needs at least one channel");
+	switch(mFormat){
+		case int16:
+			mSampleBytes = 2;
+			break;
+		case int24:
+			mSampleBytes = 3;
+			break;
+		default:
+			mSampleBytes = 4;
+			break;
+	}
+	mBytes.resize(mScratch.size() * mSampleBytes);
+
+	mFile = fopen(path.c_str(), "wb");
+	if(mFile == NULL)
+		throw std::runtime_error("cannot open " + path + " for writing");
+	//the lengths are filled in by close
+	if(!writeHeader(0)){
+		fclose(mFile);
+		throw std::runtime_error("cannot write the header of " + path);
+	}
+	if(pthread_create(&mThread, NULL, WavFileSink::writerThread, this) != 0){
+		fclose(mFile);
+		throw std::runtime_error("cannot start the wav file writer thread");
+	}
+	mOpen = true;
+}
+
+JackCpp::WavFileSink::~WavFileSink(){
+	close();
+}
+
+bool JackCpp::WavFileSink::close(){
+	if(!mOpen)
+		return !mFailed;
+	mStop = true;
+	mDataReady.notify();
+	pthread_join(mThread, NULL);
+	mOpen = false;
+
+	//a RIFF file can't hold more than 4GB, keep what fits in the header
+	uint64_t dataBytes = mFramesWritten * mChannels * mSampleBytes;
+	if(dataBytes > 0xffffffffULL - (header_bytes - 8))
+		dataBytes = 0xffffffffULL - (header_bytes - 8);
+	//RIFF chunks are padded to an even length
+	else if((dataBytes & 1) && fputc(0, mFile) == EOF)
+		mFailed = true;
+	if(fseek(mFile, 0, SEEK_SET) != 0 || !writeHeader((uint32_t)dataBytes))
+		mFailed = true;
+	if(fclose(mFile) != 0)
+		mFailed = true;
+	mFile = NULL;
+	return !mFailed;
+}
+
+bool JackCpp::WavFileSink::renderFrames(jack_default_audio_sample_t * const * bufs,
+		unsigned int channels, jack_nframes_t nframes, bool mayBlock){
+	size_t samples = (size_t)nframes * mChannels;
+	//a cycle that can never fit is dropped rather than waited for
+	while(mRing.getWriteSpace() < samples){
+		if(!mayBlock || !mOpen || mStop || samples >= mRing.length()){
+			mFramesDropped = mFramesDropped + nframes;
+			return false;
+		}
+		mWaits = mWaits + 1;
+		mSpaceReady.wait(100);
+	}
+
+	jack_default_audio_sample_t * first, * second;
+	size_t firstCnt, secondCnt;
+	mRing.getWriteVector(first, firstCnt, second, secondCnt);
+	size_t cnt = std::min(firstCnt, samples);
+	interleave(first, cnt, 0, bufs, channels, mChannels);
+	if(cnt < samples)
+		interleave(second, samples - cnt, cnt, bufs, channels, mChannels);
+	mRing.writeAdvance(samples);
+	mDataReady.notify();
+	return true;
+}
+
+void * JackCpp::WavFileSink::writerThread(void * arg){
+	((WavFileSink *)arg)->writeLoop();
+	return NULL;
+}
+
+void JackCpp::WavFileSink::writeLoop(){
+	while(true){
+		//anything written before we were told to stop is drained first
+		bool stopping = mStop;
+		while(drain() > 0)
+			;
+		if(stopping)
+			break;
+		mDataReady.wait(100);
+	}
+}
+
+unsigned int JackCpp::WavFileSink::drain(){
+	unsigned int frames = std::min(mRing.getReadSpace() / mChannels, (size_t)write_frames);
+	if(frames == 0)
+		return 0;
+	unsigned int samples = frames * mChannels;
+	mRing.read(&mScratch[0], samples);
+	//the callback can carry on while we convert and write
+	mSpaceReady.notify();
+
+	const void * out = &mBytes[0];
+	switch(mFormat){
+		case int16:
+			fromFloat(&mScratch[0], (int16_t *)&mBytes[0], 1, samples, &mDither);
+			break;
+		case int24:
+			fromFloat(&mScratch[0], (Int24 *)&mBytes[0], 1, samples, &mDither);
+			break;
+		case int32:
+			fromFloat(&mScratch[0], (int32_t *)&mBytes[0], 1, samples);
+			break;
+		case float32:
+			out = &mScratch[0];
+			break;
+	}
+	if(fwrite(out, mSampleBytes, samples, mFile) != samples)
+		mFailed = true;
+	mFramesWritten = mFramesWritten + frames;
+	return frames;
+}
+
+bool JackCpp::WavFileSink::writeHeader(uint32_t dataBytes){
+	unsigned char h[header_bytes];
+	memcpy(h, "RIFF", 4);
+	put32(h + 4, dataBytes + header_bytes - 8);
+	memcpy(h + 8, "WAVEfmt ", 8);
+	put32(h + 16, 16);
+	//1 is integer PCM, 3 is IEEE float
+	put16(h + 20, (mFormat == float32) ? 3 : 1);
+	put16(h + 22, mChannels);
+	put32(h + 24, mSampleRate);
+	put32(h + 28, mSampleRate * mChannels * mSampleBytes);
+	put16(h + 32, mChannels * mSampleBytes);
+	put16(h + 34, mSampleBytes * 8);
+	memcpy(h + 36, "data", 4);
+	put32(h + 40, dataBytes);
+	return fwrite(h, 1, header_bytes, mFile) == header_bytes;
+}
@@ -0,0 +1,204 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackmeter.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define JACKCPP_HAVE_SSE
+#endif
+
+namespace {
+	//the true peak detector filters this many samples at a time
+	const unsigned int chunk_frames = 64;
+	const unsigned int history = JackCpp::TruePeakDetector::taps - 1;
+
+	//the 4 times oversampling filter, split into its phases
+	struct oversampler_t {
+		float coefs[JackCpp::TruePeakDetector::phases][JackCpp::TruePeakDetector::taps];
+		oversampler_t(){
+			const unsigned int phases = JackCpp::TruePeakDetector::phases;
+			const unsigned int taps = JackCpp::TruePeakDetector::taps;
+			const unsigned int len = phases * taps;
+			const double center = (len - 1) / 2.0;
+			for(unsigned int p = 0; p < phases; p++){
+				double sum = 0.0;
+				double h[taps];
+				for(unsigned int k = 0; k < taps; k++){
+					unsigned int n = p + k * phases;
+					//a windowed sinc with its cutoff at the original nyquist
+					double t = (n - center) / phases;
+					double sinc = (t == 0.0) ? 1.0 : sin(M_PI * t) / (M_PI * t);
+					double w = 0.42 - 0.5 * cos(2.0 * M_PI * (n + 0.5) / len) +
+						0.08 * cos(4.0 * M_PI * (n + 0.5) / len);
+					h[k] = sinc * w;
+					sum += h[k];
+				}
+				//each phase passes dc unchanged
+				for(unsigned int k = 0; k < taps; k++)
+					coefs[p][k] = h[k] / sum;
+			}
+		}
+	};
+	const oversampler_t oversampler;
+}
+
+void JackCpp::measureLevel(const jack_default_audio_sample_t * buf, unsigned int cnt,
+		float& peak, float& sumSquares){
+	unsigned int i = 0;
+	float p = 0.0f;
+	float s = 0.0f;
+#ifdef JACKCPP_HAVE_SSE
+	if(cnt >= 8){
+		//clearing the sign bit gives the absolute value
+		const __m128 sign = _mm_set1_ps(-0.0f);
+		__m128 p0 = _mm_setzero_ps(), p1 = _mm_setzero_ps();
+		__m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+		for(; i + 8 <= cnt; i += 8){
+			__m128 a = _mm_loadu_ps(buf + i);
+			__m128 b = _mm_loadu_ps(buf + i + 4);
+			p0 = _mm_max_ps(p0, _mm_andnot_ps(sign, a));
+			p1 = _mm_max_ps(p1, _mm_andnot_ps(sign, b));
+			s0 = _mm_add_ps(s0, _mm_mul_ps(a, a));
+			s1 = _mm_add_ps(s1, _mm_mul_ps(b, b));
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, _mm_max_ps(p0, p1));
+		p = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+		_mm_storeu_ps(lanes, _mm_add_ps(s0, s1));
+		s = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+#endif
+	for(; i < cnt; i++){
+		p = std::max(p, fabsf(buf[i]));
+		s += buf[i] * buf[i];
+	}
+	peak = p;
+	sumSquares = s;
+}
+
+JackCpp::TruePeakDetector::TruePeakDetector(){
+	reset();
+}
+
+void JackCpp::TruePeakDetector::reset(){
+	memset(mHistory, 0, sizeof(mHistory));
+}
+
+float JackCpp::TruePeakDetector::process(const jack_default_audio_sample_t * buf, unsigned int cnt){
+	//the history followed by the chunk, so every tap reads contiguous samples
+	jack_default_audio_sample_t x[history + chunk_frames];
+	jack_default_audio_sample_t y[phases * chunk_frames];
+	float peak = 0.0f;
+	memcpy(x, mHistory, sizeof(mHistory));
+	for(unsigned int start = 0; start < cnt; start += chunk_frames){
+		unsigned int n = std::min(chunk_frames, cnt - start);
+		memcpy(x + history, buf + start, n * sizeof(jack_default_audio_sample_t));
+		//the taps are unrolled and the frames are vectorized, all of the
+		//phases are worked out together so each sample is loaded once
+		const float (*c)[taps] = oversampler.coefs;
+		for(unsigned int i = 0; i < n; i++){
+			float a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+			for(unsigned int k = 0; k < taps; k++){
+				float s = x[history + i - k];
+				a0 += c[0][k] * s;
+				a1 += c[1][k] * s;
+				a2 += c[2][k] * s;
+				a3 += c[3][k] * s;
+			}
+			y[i] = a0;
+			y[chunk_frames + i] = a1;
+			y[2 * chunk_frames + i] = a2;
+			y[3 * chunk_frames + i] = a3;
+		}
+		for(unsigned int p = 0; p < phases; p++){
+			float phasePeak, unused;
+			measureLevel(y + p * chunk_frames, n, phasePeak, unused);
+			peak = std::max(peak, phasePeak);
+		}
+		//keep the end of this chunk for the next one
+		memmove(x, x + n, history * sizeof(jack_default_audio_sample_t));
+	}
+	memcpy(mHistory, x, sizeof(mHistory));
+	return peak;
+}
+
+JackCpp::Meter::Meter(const MeterConfig& config, jack_nframes_t sampleRate) :
+	mConfig(config), mSampleRate(sampleRate), mFrames(0),
+	mPeakFall(0.0f), mRmsKeep(0.0f), mMeanSquare(0.0), mResetHolds(false)
+{
+	memset(&mReading, 0, sizeof(mReading));
+	mShared.write(mReading);
+}
+
+void JackCpp::Meter::process(const jack_default_audio_sample_t * buf, jack_nframes_t nframes){
+	if(nframes == 0)
+		return;
+	if(nframes != mFrames){
+		double seconds = (double)nframes / mSampleRate;
+		mPeakFall = powf(10.0f, -mConfig.peakDecay * seconds / 20.0f);
+		mRmsKeep = (mConfig.rmsTime > 0.0f) ? expf(-seconds / mConfig.rmsTime) : 0.0f;
+		mFrames = nframes;
+	}
+	if(mResetHolds){
+		mResetHolds = false;
+		mReading.peakHold = mReading.truePeakHold = 0.0f;
+	}
+
+	float peak, sumSquares;
+	measureLevel(buf, nframes, peak, sumSquares);
+	mReading.peak = std::max(peak, mReading.peak * mPeakFall);
+	mReading.peakHold = std::max(mReading.peakHold, peak);
+	mMeanSquare = mMeanSquare * mRmsKeep + (sumSquares / nframes) * (1.0 - mRmsKeep);
+	mReading.rms = sqrt(mMeanSquare);
+
+	if(mConfig.truePeak){
+		//the true peak is never lower than the sample peak
+		float truePeak = std::max(peak, mTruePeak.process(buf, nframes));
+		mReading.truePeak = std::max(truePeak, mReading.truePeak * mPeakFall);
+		mReading.truePeakHold = std::max(mReading.truePeakHold, truePeak);
+	}
+	mShared.write(mReading);
+}
+
+JackCpp::MeterBank::MeterBank(unsigned int inputs, unsigned int outputs,
+		const MeterConfig& config, jack_nframes_t sampleRate) :
+	mInputs(inputs, Meter(config, sampleRate)),
+	mOutputs(outputs, Meter(config, sampleRate))
+{
+}
+
+void JackCpp::MeterBank::process(jack_nframes_t nframes,
+		jack_default_audio_sample_t * const * inBufs, unsigned int inCount,
+		jack_default_audio_sample_t * const * outBufs, unsigned int outCount){
+	inCount = std::min(inCount, inputs());
+	outCount = std::min(outCount, outputs());
+	for(unsigned int i = 0; i < inCount; i++)
+		mInputs[i].process(inBufs[i], nframes);
+	for(unsigned int i = 0; i < outCount; i++)
+		mOutputs[i].process(outBufs[i], nframes);
+}
+
+void JackCpp::MeterBank::resetHolds(){
+	for(unsigned int i = 0; i < mInputs.size(); i++)
+		mInputs[i].resetHolds();
+	for(unsigned int i = 0; i < mOutputs.size(); i++)
+		mOutputs[i].resetHolds();
+}
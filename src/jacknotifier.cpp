@@ -0,0 +1,85 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jacknotifier.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+JackCpp::Notifier::Notifier() JACKCPP_THROW(std::runtime_error) {
+#ifdef __linux__
+	mReadFd = mWriteFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(mReadFd < 0)
+		throw std::runtime_error("cannot create eventfd");
+#else
+	int fds[2];
+	if(pipe(fds) != 0)
+		throw std::runtime_error("cannot create notification pipe");
+	for(unsigned int i = 0; i < 2; i++){
+		fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+		fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+	}
+	mReadFd = fds[0];
+	mWriteFd = fds[1];
+#endif
+}
+
+JackCpp::Notifier::~Notifier(){
+	::close(mReadFd);
+	if(mWriteFd != mReadFd)
+		::close(mWriteFd);
+}
+
+void JackCpp::Notifier::notify(){
+	//if the counter or the pipe is full there is already a notification pending
+#ifdef __linux__
+	uint64_t one = 1;
+	ssize_t ret = write(mWriteFd, &one, sizeof(one));
+#else
+	char one = 1;
+	ssize_t ret = write(mWriteFd, &one, sizeof(one));
+#endif
+	(void)ret;
+}
+
+void JackCpp::Notifier::clear(){
+	char buf[64];
+	while(read(mReadFd, buf, sizeof(buf)) > 0)
+		;
+}
+
+bool JackCpp::Notifier::wait(int timeoutMs){
+	struct pollfd p;
+	p.fd = mReadFd;
+	p.events = POLLIN;
+	int ret;
+	do {
+		p.revents = 0;
+		ret = poll(&p, 1, timeoutMs);
+	} while(ret < 0 && errno == EINTR);
+	if(ret <= 0)
+		return false;
+	clear();
+	return true;
+}
+
@@ -0,0 +1,197 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackportregistry.hpp"
+#include <algorithm>
+#include <stdlib.h>
+
+namespace {
+	//holds the mutex for as long as it is in scope
+	class ScopedLock {
+		public:
+			ScopedLock(pthread_mutex_t * mutex) : mMutex(mutex) { pthread_mutex_lock(mMutex); }
+			~ScopedLock(){ pthread_mutex_unlock(mMutex); }
+		private:
+			pthread_mutex_t * mMutex;
+	};
+
+	const unsigned long physical_source = JackPortIsPhysical | JackPortIsOutput;
+	const unsigned long physical_destination = JackPortIsPhysical | JackPortIsInput;
+}
+
+JackCpp::PortRegistry::PortRegistry() : mClient(NULL) {
+	pthread_mutex_init(&mMutex, NULL);
+}
+
+JackCpp::PortRegistry::~PortRegistry(){
+	pthread_mutex_destroy(&mMutex);
+}
+
+void JackCpp::PortRegistry::init(jack_client_t * client){
+	ScopedLock lock(&mMutex);
+	mClient = client;
+	mByName.clear();
+	mNames.clear();
+	mPhysicalSources.clear();
+	mPhysicalDestinations.clear();
+
+	//we only ask the server for the list here
+	const char ** ports = jack_get_ports(mClient, NULL, NULL, 0);
+	if(ports == NULL)
+		return;
+	for(unsigned int i = 0; ports[i] != NULL; i++){
+		jack_port_t * port = jack_port_by_name(mClient, ports[i]);
+		if(port != NULL)
+			add(port);
+	}
+	free(ports);
+}
+
+void JackCpp::PortRegistry::clear(){
+	ScopedLock lock(&mMutex);
+	mClient = NULL;
+	mByName.clear();
+	mNames.clear();
+	mPhysicalSources.clear();
+	mPhysicalDestinations.clear();
+}
+
+//the callbacks may race with init, so adding is idempotent
+void JackCpp::PortRegistry::add(jack_port_t * port){
+	std::string name(jack_port_name(port));
+	if(mByName.find(name) != mByName.end())
+		return;
+	port_info_t info;
+	info.port = port;
+	info.flags = jack_port_flags(port);
+	mByName[name] = info;
+	mNames[port] = name;
+	if((info.flags & physical_source) == physical_source)
+		mPhysicalSources.push_back(name);
+	if((info.flags & physical_destination) == physical_destination)
+		mPhysicalDestinations.push_back(name);
+}
+
+void JackCpp::PortRegistry::remove(jack_port_t * port){
+	std::map<jack_port_t *, std::string>::iterator it = mNames.find(port);
+	if(it == mNames.end())
+		return;
+	std::string name = it->second;
+	mNames.erase(it);
+	mByName.erase(name);
+	std::vector<std::string>::iterator phys;
+	phys = std::find(mPhysicalSources.begin(), mPhysicalSources.end(), name);
+	if(phys != mPhysicalSources.end())
+		mPhysicalSources.erase(phys);
+	phys = std::find(mPhysicalDestinations.begin(), mPhysicalDestinations.end(), name);
+	if(phys != mPhysicalDestinations.end())
+		mPhysicalDestinations.erase(phys);
+}
+
+void JackCpp::PortRegistry::portRegistered(jack_port_id_t id, bool registered){
+	ScopedLock lock(&mMutex);
+	if(mClient == NULL)
+		return;
+	jack_port_t * port = jack_port_by_id(mClient, id);
+	if(port == NULL)
+		return;
+	if(registered)
+		add(port);
+	else
+		remove(port);
+}
+
+void JackCpp::PortRegistry::portRenamed(jack_port_id_t id, const char * oldName, const char * newName){
+	ScopedLock lock(&mMutex);
+	if(mClient == NULL)
+		return;
+	std::map<std::string, port_info_t>::iterator it = mByName.find(oldName);
+	if(it == mByName.end()){
+		//we didn't know about it, so just pick it up under its new name
+		jack_port_t * port = jack_port_by_id(mClient, id);
+		if(port != NULL)
+			add(port);
+		return;
+	}
+	port_info_t info = it->second;
+	mByName.erase(it);
+	mByName[newName] = info;
+	mNames[info.port] = newName;
+	std::replace(mPhysicalSources.begin(), mPhysicalSources.end(), std::string(oldName), std::string(newName));
+	std::replace(mPhysicalDestinations.begin(), mPhysicalDestinations.end(), std::string(oldName), std::string(newName));
+}
+
+bool JackCpp::PortRegistry::exists(const std::string& name){
+	ScopedLock lock(&mMutex);
+	return mByName.find(name) != mByName.end();
+}
+
+jack_port_t * JackCpp::PortRegistry::port(const std::string& name){
+	ScopedLock lock(&mMutex);
+	std::map<std::string, port_info_t>::iterator it = mByName.find(name);
+	if(it == mByName.end())
+		return NULL;
+	return it->second.port;
+}
+
+int JackCpp::PortRegistry::flags(const std::string& name){
+	ScopedLock lock(&mMutex);
+	std::map<std::string, port_info_t>::iterator it = mByName.find(name);
+	if(it == mByName.end())
+		return 0;
+	return it->second.flags;
+}
+
+std::vector<std::string> JackCpp::PortRegistry::ports(unsigned long flags){
+	ScopedLock lock(&mMutex);
+	std::vector<std::string> names;
+	for(std::map<std::string, port_info_t>::iterator it = mByName.begin(); it != mByName.end(); it++){
+		if(((unsigned long)it->second.flags & flags) == flags)
+			names.push_back(it->first);
+	}
+	return names;
+}
+
+unsigned int JackCpp::PortRegistry::numPhysicalSources(){
+	ScopedLock lock(&mMutex);
+	return mPhysicalSources.size();
+}
+
+unsigned int JackCpp::PortRegistry::numPhysicalDestinations(){
+	ScopedLock lock(&mMutex);
+	return mPhysicalDestinations.size();
+}
+
+std::string JackCpp::PortRegistry::physicalSource(unsigned int index)
+	JACKCPP_THROW(std::range_error)
+{
+	ScopedLock lock(&mMutex);
+	if(index >= mPhysicalSources.size())
+		throw std::range_error("physical outport index out of range");
+	return mPhysicalSources[index];
+}
+
+std::string JackCpp::PortRegistry::physicalDestination(unsigned int index)
+	JACKCPP_THROW(std::range_error)
+{
+	ScopedLock lock(&mMutex);
+	if(index >= mPhysicalDestinations.size())
+		throw std::range_error("physical inport index out of range");
+	return mPhysicalDestinations[index];
+}
+
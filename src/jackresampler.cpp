@@ -0,0 +1,231 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackresampler.hpp"
+#include <math.h>
+#include <string.h>
+
+const double JackCpp::Resampler::maxRatioAdjust = 0.01;
+
+//zeroth order modified bessel function of the first kind, for the kaiser window
+static double bessel_i0(double x){
+	double sum = 1.0;
+	double term = 1.0;
+	double half = x / 2.0;
+	for(unsigned int k = 1; k < 64; k++){
+		term *= (half / k) * (half / k);
+		sum += term;
+		if(term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+//4 independent partial sums so that the compiler can vectorize the loop
+//without having to reorder a single floating point accumulation.
+//n is always a multiple of 4
+static inline float interp_dot(const float * h, const float * t, const float * d,
+		float frac, unsigned int n){
+	float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	for(unsigned int j = 0; j < n; j += 4){
+		s0 += h[j] * (t[j] + frac * d[j]);
+		s1 += h[j + 1] * (t[j + 1] + frac * d[j + 1]);
+		s2 += h[j + 2] * (t[j + 2] + frac * d[j + 2]);
+		s3 += h[j + 3] * (t[j + 3] + frac * d[j + 3]);
+	}
+	return (s0 + s1) + (s2 + s3);
+}
+
+JackCpp::Resampler::Resampler(unsigned int channels, double inRate, double outRate,
+		unsigned int maxFrames, quality_t quality)
+	JACKCPP_THROW(std::runtime_error) :
+	mChannels(channels), mMaxFrames(maxFrames), mFill(0),
+	mAdjust(1.0), mPos(0.0)
+{
+	if(channels == 0 || maxFrames == 0)
+		throw std::runtime_error("resampler needs at least one channel and frame");
+	if(inRate <= 0.0 || outRate <= 0.0)
+		throw std::runtime_error("resampler rates must be positive");
+
+	unsigned int taps;
+	double cutoff;
+	double beta;
+	switch(quality){
+		case fast:
+			taps = 16;
+			mPhases = 64;
+			cutoff = 0.85;
+			beta = 6.0;
+			break;
+		case best:
+			taps = 64;
+			mPhases = 512;
+			cutoff = 0.95;
+			beta = 10.0;
+			break;
+		case medium:
+		default:
+			taps = 32;
+			mPhases = 256;
+			cutoff = 0.91;
+			beta = 8.0;
+			break;
+	}
+
+	mNominalStep = inRate / outRate;
+	mStep = mNominalStep;
+
+	//when we are decimating, lower the cutoff and widen the filter to match
+	if(mNominalStep > 1.0){
+		cutoff /= mNominalStep;
+		taps = (unsigned int)ceil(taps * mNominalStep);
+	}
+	//keep the taps a multiple of 4 for interp_dot
+	mTaps = (taps + 3) & ~3u;
+
+	buildTable(cutoff, beta, mPhases);
+
+	//room for the filter history plus the most input a single block can need
+	double maxStep = mNominalStep * (1.0 + maxRatioAdjust);
+	mCapacity = mTaps + 2 + (unsigned int)ceil(maxFrames * (maxStep + 1.0));
+	mHistory.resize(mCapacity * mChannels, 0.0f);
+	reset();
+}
+
+void JackCpp::Resampler::buildTable(double cutoff, double beta, unsigned int phases){
+	std::vector<double> row(mTaps);
+	std::vector<float> table((phases + 1) * mTaps);
+	double center = mTaps / 2 - 1;
+	double halfWidth = mTaps / 2;
+	double i0beta = bessel_i0(beta);
+
+	for(unsigned int p = 0; p <= phases; p++){
+		double frac = (double)p / phases;
+		double sum = 0.0;
+		for(unsigned int j = 0; j < mTaps; j++){
+			double x = j - center - frac;
+			double arg = M_PI * cutoff * x;
+			double sinc = (fabs(arg) < 1e-12) ? 1.0 : sin(arg) / arg;
+			double w = x / halfWidth;
+			double win = (fabs(w) >= 1.0) ? 0.0 : bessel_i0(beta * sqrt(1.0 - w * w)) / i0beta;
+			row[j] = cutoff * sinc * win;
+			sum += row[j];
+		}
+		//unity gain at dc for every phase
+		for(unsigned int j = 0; j < mTaps; j++)
+			table[p * mTaps + j] = (float)(row[j] / sum);
+	}
+
+	mTable.resize(phases * mTaps);
+	mDelta.resize(phases * mTaps);
+	for(unsigned int p = 0; p < phases; p++){
+		for(unsigned int j = 0; j < mTaps; j++){
+			mTable[p * mTaps + j] = table[p * mTaps + j];
+			mDelta[p * mTaps + j] = table[(p + 1) * mTaps + j] - table[p * mTaps + j];
+		}
+	}
+}
+
+void JackCpp::Resampler::setRatioAdjust(double adjust){
+	if(adjust > 1.0 + maxRatioAdjust)
+		adjust = 1.0 + maxRatioAdjust;
+	else if(adjust < 1.0 - maxRatioAdjust)
+		adjust = 1.0 - maxRatioAdjust;
+	mAdjust = adjust;
+	mStep = mNominalStep * mAdjust;
+}
+
+unsigned int JackCpp::Resampler::inputFramesNeeded(unsigned int outFrames) const {
+	if(outFrames == 0)
+		return 0;
+	//the last output of the block reads mTaps frames starting at floor(last)
+	double last = mPos + (outFrames - 1) * mStep;
+	unsigned int end = (unsigned int)last + mTaps;
+	return (end > mFill) ? end - mFill : 0;
+}
+
+unsigned int JackCpp::Resampler::outputFramesAvailable() const {
+	if(mFill < mTaps)
+		return 0;
+	//output k can be computed while floor(mPos + k * mStep) + mTaps <= mFill
+	double span = (double)(mFill - mTaps + 1) - mPos;
+	if(span <= 0.0)
+		return 0;
+	unsigned int cnt = (unsigned int)ceil(span / mStep);
+	//guard against rounding, using the same expression that process uses
+	while(cnt > 0 && (unsigned int)(mPos + (cnt - 1) * mStep) + mTaps > mFill)
+		cnt--;
+	while((unsigned int)(mPos + cnt * mStep) + mTaps <= mFill)
+		cnt++;
+	return cnt;
+}
+
+jack_default_audio_sample_t * JackCpp::Resampler::inputBuffer(unsigned int channel){
+	return &mHistory[channel * mCapacity + mFill];
+}
+
+void JackCpp::Resampler::commitInput(unsigned int frames){
+	if(frames > inputSpace())
+		frames = inputSpace();
+	mFill += frames;
+}
+
+unsigned int JackCpp::Resampler::process(const std::vector<jack_default_audio_sample_t *>& out,
+		unsigned int outFrames){
+	unsigned int avail = outputFramesAvailable();
+	if(outFrames > avail)
+		outFrames = avail;
+
+	for(unsigned int k = 0; k < outFrames; k++){
+		double pos = mPos + k * mStep;
+		unsigned int index = (unsigned int)pos;
+		double phase = (pos - index) * mPhases;
+		unsigned int row = (unsigned int)phase;
+		if(row >= mPhases)
+			row = mPhases - 1;
+		float frac = (float)(phase - row);
+		const float * t = &mTable[row * mTaps];
+		const float * d = &mDelta[row * mTaps];
+		for(unsigned int c = 0; c < mChannels; c++)
+			out[c][k] = interp_dot(&mHistory[c * mCapacity + index], t, d, frac, mTaps);
+	}
+
+	//drop the input we no longer need, keeping the filter history
+	double next = mPos + outFrames * mStep;
+	unsigned int consumed = (unsigned int)next;
+	if(consumed > mFill)
+		consumed = mFill;
+	mPos = next - consumed;
+	if(consumed > 0){
+		for(unsigned int c = 0; c < mChannels; c++){
+			jack_default_audio_sample_t * base = &mHistory[c * mCapacity];
+			memmove(base, base + consumed, (mFill - consumed) * sizeof(jack_default_audio_sample_t));
+		}
+		mFill -= consumed;
+	}
+	return outFrames;
+}
+
+void JackCpp::Resampler::reset(){
+	for(unsigned int i = 0; i < mHistory.size(); i++)
+		mHistory[i] = 0.0f;
+	//prime with silence so the first input lines up with the filter center
+	mFill = mTaps - 1;
+	mPos = 0.0;
+}
+
@@ -0,0 +1,305 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackrouter.hpp"
+#include <string.h>
+
+const unsigned int JackCpp::AudioRouter::ports;
+
+JackCpp::AudioRouter::AudioRouter(std::string name, unsigned int inPorts, unsigned int outPorts,
+		bool startServer)
+	JACKCPP_THROW(std::runtime_error) :
+	AudioIO(name, inPorts, outPorts, startServer),
+	mPlanned(false)
+{
+	pthread_mutex_init(&mUpdateLock, NULL);
+}
+
+JackCpp::AudioRouter::~AudioRouter(){
+	//stop the callback before the plan goes away
+	if(getState() == AudioIO::active)
+		stop();
+	pthread_mutex_destroy(&mUpdateLock);
+}
+
+unsigned int JackCpp::AudioRouter::addNode(AudioIO * node, unsigned int inputs, unsigned int outputs)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(node == NULL || node == this)
+		throw std::runtime_error("a router node must be another AudioIO");
+	if(node->client() != NULL)
+		throw std::runtime_error("a router node must not have a jack client");
+	node_def_t def;
+	def.node = node;
+	def.inputs = inputs;
+	def.outputs = outputs;
+	pthread_mutex_lock(&mUpdateLock);
+	mNodes.push_back(def);
+	unsigned int index = mNodes.size() - 1;
+	pthread_mutex_unlock(&mUpdateLock);
+	return index;
+}
+
+void JackCpp::AudioRouter::route(unsigned int fromNode, unsigned int output,
+		unsigned int toNode, unsigned int input)
+	JACKCPP_THROW(std::range_error)
+{
+	pthread_mutex_lock(&mUpdateLock);
+	bool ok;
+	if(fromNode == ports)
+		ok = output < inPorts();
+	else
+		ok = fromNode < mNodes.size() && output < mNodes[fromNode].outputs;
+	if(toNode == ports)
+		ok = ok && input < outPorts();
+	else
+		ok = ok && toNode < mNodes.size() && input < mNodes[toNode].inputs;
+	if(ok){
+		bool exists = false;
+		for(unsigned int i = 0; i < mRoutes.size() && !exists; i++){
+			const route_t& r = mRoutes[i];
+			exists = r.fromNode == fromNode && r.output == output && r.toNode == toNode && r.input == input;
+		}
+		if(!exists){
+			route_t r;
+			r.fromNode = fromNode;
+			r.output = output;
+			r.toNode = toNode;
+			r.input = input;
+			mRoutes.push_back(r);
+		}
+	}
+	pthread_mutex_unlock(&mUpdateLock);
+	if(!ok)
+		throw std::range_error("no such node, input or output");
+}
+
+void JackCpp::AudioRouter::clear(){
+	pthread_mutex_lock(&mUpdateLock);
+	mNodes.clear();
+	mRoutes.clear();
+	pthread_mutex_unlock(&mUpdateLock);
+}
+
+JackCpp::AudioRouter::plan_t * JackCpp::AudioRouter::createPlan(jack_nframes_t frames)
+	JACKCPP_THROW(std::runtime_error)
+{
+	const unsigned int nodes = mNodes.size();
+	const unsigned int inCount = inPorts();
+	const unsigned int outCount = outPorts();
+
+	//run a node once every node that feeds it has run, the lowest index first
+	std::vector<unsigned int> waiting(nodes, 0);
+	for(unsigned int i = 0; i < mRoutes.size(); i++){
+		if(mRoutes[i].fromNode != ports && mRoutes[i].toNode != ports)
+			waiting[mRoutes[i].toNode]++;
+	}
+	std::vector<unsigned int> order;
+	std::vector<bool> ordered(nodes, false);
+	while(order.size() < nodes){
+		unsigned int next = nodes;
+		for(unsigned int n = 0; n < nodes && next == nodes; n++){
+			if(!ordered[n] && waiting[n] == 0)
+				next = n;
+		}
+		if(next == nodes)
+			throw std::runtime_error("the routes make a loop");
+		ordered[next] = true;
+		order.push_back(next);
+		for(unsigned int i = 0; i < mRoutes.size(); i++){
+			if(mRoutes[i].fromNode == next && mRoutes[i].toNode != ports)
+				waiting[mRoutes[i].toNode]--;
+		}
+	}
+
+	//how many routes feed each output port
+	std::vector<unsigned int> portFeeds(outCount, 0);
+	for(unsigned int i = 0; i < mRoutes.size(); i++){
+		if(mRoutes[i].toNode == ports)
+			portFeeds[mRoutes[i].input]++;
+	}
+
+	plan_t * plan = new plan_t;
+	plan->frames = frames;
+	plan->inPorts = inCount;
+	plan->outPorts = outCount;
+	unsigned int slots = inCount + outCount;
+	const unsigned int silence = slots++;
+
+	//a node output renders straight into the first port it is the only feed of
+	std::vector<std::vector<unsigned int> > outSlots(nodes);
+	std::vector<bool> bound(outCount, false);
+	for(unsigned int n = 0; n < nodes; n++){
+		outSlots[n].resize(mNodes[n].outputs, silence);
+		for(unsigned int o = 0; o < mNodes[n].outputs; o++){
+			for(unsigned int i = 0; i < mRoutes.size() && outSlots[n][o] == silence; i++){
+				const route_t& r = mRoutes[i];
+				if(r.fromNode == n && r.output == o && r.toNode == ports && portFeeds[r.input] == 1){
+					outSlots[n][o] = inCount + r.input;
+					bound[r.input] = true;
+				}
+			}
+			if(outSlots[n][o] == silence)
+				outSlots[n][o] = slots++;
+		}
+	}
+
+	//an input with one feed uses its slot, several are mixed into a slot of their own
+	plan->firstMix.push_back(0);
+	for(unsigned int k = 0; k < nodes; k++){
+		const unsigned int n = order[k];
+		std::vector<unsigned int> inSlots(mNodes[n].inputs, silence);
+		for(unsigned int input = 0; input < mNodes[n].inputs; input++){
+			std::vector<unsigned int> feeds;
+			for(unsigned int i = 0; i < mRoutes.size(); i++){
+				const route_t& r = mRoutes[i];
+				if(r.toNode == n && r.input == input)
+					feeds.push_back(r.fromNode == ports ? r.output : outSlots[r.fromNode][r.output]);
+			}
+			if(feeds.size() == 1)
+				inSlots[input] = feeds[0];
+			else if(feeds.size() > 1){
+				mix_t mix;
+				mix.dest = inSlots[input] = slots++;
+				mix.first = plan->sources.size();
+				mix.count = feeds.size();
+				plan->sources.insert(plan->sources.end(), feeds.begin(), feeds.end());
+				plan->mixes.push_back(mix);
+			}
+		}
+		plan->nodes.push_back(mNodes[n].node);
+		plan->inSlots.push_back(inSlots);
+		plan->outSlots.push_back(outSlots[n]);
+		plan->in.push_back(audioBufVector(mNodes[n].inputs));
+		plan->out.push_back(audioBufVector(mNodes[n].outputs));
+		plan->firstMix.push_back(plan->mixes.size());
+	}
+
+	//then the output ports that weren't rendered into
+	for(unsigned int port = 0; port < outCount; port++){
+		if(bound[port])
+			continue;
+		mix_t mix;
+		mix.dest = inCount + port;
+		mix.first = plan->sources.size();
+		for(unsigned int i = 0; i < mRoutes.size(); i++){
+			const route_t& r = mRoutes[i];
+			if(r.toNode == ports && r.input == port)
+				plan->sources.push_back(r.fromNode == ports ? r.output : outSlots[r.fromNode][r.output]);
+		}
+		mix.count = plan->sources.size() - mix.first;
+		plan->mixes.push_back(mix);
+	}
+
+	const unsigned int owned = slots - silence;
+	plan->memory.assign(owned * frames, 0.0f);
+	plan->slots.assign(slots, NULL);
+	for(unsigned int i = 0; i < owned; i++)
+		plan->slots[silence + i] = &plan->memory[i * frames];
+	return plan;
+}
+
+void JackCpp::AudioRouter::update()
+	JACKCPP_THROW(std::runtime_error)
+{
+	pthread_mutex_lock(&mUpdateLock);
+	try {
+		plan_t * plan = createPlan(getBufferSize());
+		if(callbacksLive()){
+			if(!mPlan.publish(plan)){
+				delete plan;
+				throw std::runtime_error("too many router updates waiting for the callback");
+			}
+		} else
+			mPlan.reset(plan);
+		mPlanned = true;
+	} catch (...){
+		pthread_mutex_unlock(&mUpdateLock);
+		throw;
+	}
+	pthread_mutex_unlock(&mUpdateLock);
+}
+
+int JackCpp::AudioRouter::jackBufferSizeCallback(jack_nframes_t nframes){
+	int ret = AudioIO::jackBufferSizeCallback(nframes);
+	pthread_mutex_lock(&mUpdateLock);
+	if(mPlanned){
+		try {
+			plan_t * plan = createPlan(nframes);
+			if(!mPlan.publish(plan)){
+				delete plan;
+				ret = 1;
+			}
+		} catch (std::runtime_error&){
+			ret = 1;
+		}
+	}
+	pthread_mutex_unlock(&mUpdateLock);
+	return ret;
+}
+
+void JackCpp::AudioRouter::runMixes(const plan_t * plan, unsigned int first, unsigned int last,
+		jack_nframes_t nframes){
+	for(unsigned int m = first; m < last; m++){
+		const mix_t& mix = plan->mixes[m];
+		jack_default_audio_sample_t * dest = plan->slots[mix.dest];
+		if(mix.count == 0){
+			memset(dest, 0, nframes * sizeof(jack_default_audio_sample_t));
+			continue;
+		}
+		memcpy(dest, plan->slots[plan->sources[mix.first]], nframes * sizeof(jack_default_audio_sample_t));
+		for(unsigned int s = 1; s < mix.count; s++){
+			const jack_default_audio_sample_t * src = plan->slots[plan->sources[mix.first + s]];
+			for(jack_nframes_t j = 0; j < nframes; j++)
+				dest[j] += src[j];
+		}
+	}
+}
+
+int JackCpp::AudioRouter::processAudio(jack_nframes_t nframes,
+		const audioBufVector& inBufs,
+		const audioBufVector& outBufs){
+	plan_t * plan = mPlan.acquire();
+	if(plan == NULL || nframes > plan->frames ||
+			inBufs.size() != plan->inPorts || outBufs.size() != plan->outPorts){
+		for(unsigned int i = 0; i < outBufs.size(); i++)
+			memset(outBufs[i], 0, nframes * sizeof(jack_default_audio_sample_t));
+		return 0;
+	}
+	//the ports' buffers change every cycle
+	for(unsigned int i = 0; i < plan->inPorts; i++)
+		plan->slots[i] = inBufs[i];
+	for(unsigned int i = 0; i < plan->outPorts; i++)
+		plan->slots[plan->inPorts + i] = outBufs[i];
+
+	int ret = 0;
+	for(unsigned int k = 0; k < plan->nodes.size(); k++){
+		runMixes(plan, plan->firstMix[k], plan->firstMix[k + 1], nframes);
+		audioBufVector& in = plan->in[k];
+		audioBufVector& out = plan->out[k];
+		for(unsigned int i = 0; i < in.size(); i++)
+			in[i] = plan->slots[plan->inSlots[k][i]];
+		for(unsigned int i = 0; i < out.size(); i++)
+			out[i] = plan->slots[plan->outSlots[k][i]];
+		int r = plan->nodes[k]->processAudio(nframes, in, out);
+		if(ret == 0)
+			ret = r;
+	}
+	runMixes(plan, plan->firstMix.back(), plan->mixes.size(), nframes);
+	return ret;
+}
@@ -0,0 +1,75 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+#include "jackrtarena.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+JackCpp::RTArena::RTArena(size_t bytes, jack_nframes_t frames)
+	JACKCPP_THROW(std::runtime_error) :
+	mData(NULL), mCapacity(bytes), mUsed(0), mHighWater(0), mFailures(0),
+	mFrames(frames), mLocked(false)
+{
+	if(mCapacity == 0)
+		return;
+	void * data;
+	if(posix_memalign(&data, blockAlignment, mCapacity) != 0)
+		throw std::runtime_error("cannot allocate realtime arena");
+	mData = (char *)data;
+	//keep it in memory and touch every page so the callback never faults
+	mLocked = mlock(mData, mCapacity) == 0;
+	memset(mData, 0, mCapacity);
+}
+
+JackCpp::RTArena::~RTArena(){
+	if(mData == NULL)
+		return;
+	if(mLocked)
+		munlock(mData, mCapacity);
+	free(mData);
+}
+
+void * JackCpp::RTArena::allocate(size_t bytes, size_t alignment){
+	uintptr_t base = (uintptr_t)mData;
+	uintptr_t addr = (base + mUsed + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	size_t end = (addr - base) + bytes;
+	if(mData == NULL || end > mCapacity){
+		mFailures++;
+		return NULL;
+	}
+	mUsed = end;
+	if(mUsed > mHighWater)
+		mHighWater = mUsed;
+	return (void *)addr;
+}
+
+jack_default_audio_sample_t * JackCpp::RTArena::scratchBlock(){
+	return (jack_default_audio_sample_t *)allocate(
+			mFrames * sizeof(jack_default_audio_sample_t), blockAlignment);
+}
+
+void JackCpp::RTArena::reset(){
+	mUsed = 0;
+}
+
+size_t JackCpp::RTArena::blockBytes(jack_nframes_t frames){
+	size_t bytes = frames * sizeof(jack_default_audio_sample_t);
+	return (bytes + blockAlignment - 1) & ~(size_t)(blockAlignment - 1);
+}
+
@@ -0,0 +1,349 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+#include "jackrtcheck.hpp"
+#include <stdlib.h>
+
+#ifdef JACKCPP_RTCHECK
+#include <new>
+#include "jackcompat.hpp"
+#include <errno.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/select.h>
+#endif
+
+namespace {
+	//greater than zero while the thread is in the process callback
+	__thread int rt_depth = 0;
+	//set while we are recording, so the recording itself isn't recorded
+	__thread int in_record = 0;
+	volatile bool checking = false;
+
+	struct violation_record_t {
+		volatile bool ready;
+		JackCpp::RTChecker::kind_t kind;
+		int depth;
+		void * frames[JackCpp::RTChecker::maxFrames];
+	};
+	//preallocated so that recording never allocates
+	violation_record_t records[JackCpp::RTChecker::maxViolations];
+	volatile unsigned int record_count = 0;
+
+	const char * kind_names[] = {
+		"malloc", "free", "operator new", "operator delete",
+		"mutex lock", "blocking call", "sleep"
+	};
+}
+
+void JackCpp::RTChecker::enter(){
+	rt_depth++;
+}
+
+void JackCpp::RTChecker::leave(){
+	rt_depth--;
+}
+
+bool JackCpp::RTChecker::inRealtime(){
+	return rt_depth > 0;
+}
+
+const char * JackCpp::RTChecker::kindName(kind_t kind){
+	return kind_names[kind];
+}
+
+void JackCpp::RTChecker::record(kind_t kind){
+	if(!checking || rt_depth <= 0 || in_record)
+		return;
+	in_record = 1;
+	unsigned int index = __sync_fetch_and_add(&record_count, 1);
+	if(index < maxViolations){
+		violation_record_t& r = records[index];
+		r.kind = kind;
+#ifdef JACKCPP_RTCHECK
+		r.depth = backtrace(r.frames, maxFrames);
+#else
+		r.depth = 0;
+#endif
+		__sync_synchronize();
+		r.ready = true;
+	}
+	in_record = 0;
+}
+
+#ifdef JACKCPP_RTCHECK
+
+bool JackCpp::RTChecker::available(){
+	return true;
+}
+
+void JackCpp::RTChecker::enable(bool enable){
+	if(enable){
+		//the first backtrace loads libgcc, get that out of the way now
+		void * frames[2];
+		backtrace(frames, 2);
+	}
+	checking = enable;
+}
+
+#else
+
+bool JackCpp::RTChecker::available(){
+	return false;
+}
+
+void JackCpp::RTChecker::enable(bool enable){
+	checking = enable;
+}
+
+#endif
+
+bool JackCpp::RTChecker::enabled(){
+	return checking;
+}
+
+unsigned int JackCpp::RTChecker::violations(){
+	return record_count;
+}
+
+void JackCpp::RTChecker::clear(){
+	for(unsigned int i = 0; i < maxViolations; i++)
+		records[i].ready = false;
+	record_count = 0;
+}
+
+void JackCpp::RTChecker::report(std::ostream& out){
+	unsigned int cnt = record_count;
+	out << cnt << " realtime safety violations" << std::endl;
+	if(cnt > maxViolations){
+		out << "only the first " << maxViolations << " were kept" << std::endl;
+		cnt = maxViolations;
+	}
+	for(unsigned int i = 0; i < cnt; i++){
+		if(!records[i].ready)
+			continue;
+		out << kindName(records[i].kind) << " in the process callback" << std::endl;
+#ifdef JACKCPP_RTCHECK
+		char ** symbols = backtrace_symbols(records[i].frames, records[i].depth);
+		if(symbols == NULL)
+			continue;
+		//skip record and the replacement function itself
+		for(int j = 2; j < records[i].depth; j++)
+			out << "\t" << symbols[j] << std::endl;
+		free(symbols);
+#endif
+	}
+}
+
+#ifdef JACKCPP_RTCHECK
+
+//the replacements, glibc exports its allocator under __libc_ names so we can
+//call it without looking it up, everything else is found with dlsym
+extern "C" {
+	void * __libc_malloc(size_t size);
+	void * __libc_calloc(size_t count, size_t size);
+	void * __libc_realloc(void * ptr, size_t size);
+	void * __libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void * ptr);
+}
+
+namespace {
+	//resolved the first time they are used, without a guard variable that could lock
+	template<typename Func>
+		Func next_symbol(Func& cache, const char * name){
+			if(cache == NULL)
+				cache = (Func)dlsym(RTLD_NEXT, name);
+			return cache;
+		}
+
+	typedef int (*mutex_lock_t)(pthread_mutex_t *);
+	typedef int (*cond_wait_t)(pthread_cond_t *, pthread_mutex_t *);
+	typedef int (*cond_timedwait_t)(pthread_cond_t *, pthread_mutex_t *, const struct timespec *);
+	typedef int (*sem_wait_t)(sem_t *);
+	typedef int (*usleep_t)(useconds_t);
+	typedef unsigned int (*sleep_t)(unsigned int);
+	typedef int (*nanosleep_t)(const struct timespec *, struct timespec *);
+	typedef int (*clock_nanosleep_t)(clockid_t, int, const struct timespec *, struct timespec *);
+	typedef int (*poll_t)(struct pollfd *, nfds_t, int);
+	typedef int (*select_t)(int, fd_set *, fd_set *, fd_set *, struct timeval *);
+
+	mutex_lock_t real_mutex_lock = NULL;
+	cond_wait_t real_cond_wait = NULL;
+	cond_timedwait_t real_cond_timedwait = NULL;
+	sem_wait_t real_sem_wait = NULL;
+	usleep_t real_usleep = NULL;
+	sleep_t real_sleep = NULL;
+	nanosleep_t real_nanosleep = NULL;
+	clock_nanosleep_t real_clock_nanosleep = NULL;
+	poll_t real_poll = NULL;
+	select_t real_select = NULL;
+}
+
+extern "C" {
+	void * malloc(size_t size) throw() {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::mallocCall);
+		return __libc_malloc(size);
+	}
+
+	void * calloc(size_t count, size_t size) throw() {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::mallocCall);
+		return __libc_calloc(count, size);
+	}
+
+	void * realloc(void * ptr, size_t size) throw() {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::mallocCall);
+		return __libc_realloc(ptr, size);
+	}
+
+	int posix_memalign(void ** ptr, size_t alignment, size_t size) throw() {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::mallocCall);
+		if(alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment % sizeof(void *) != 0)
+			return EINVAL;
+		void * mem = __libc_memalign(alignment, size);
+		if(mem == NULL)
+			return ENOMEM;
+		*ptr = mem;
+		return 0;
+	}
+
+	void free(void * ptr) throw() {
+		if(ptr != NULL)
+			JackCpp::RTChecker::record(JackCpp::RTChecker::freeCall);
+		__libc_free(ptr);
+	}
+
+	int pthread_mutex_lock(pthread_mutex_t * mutex) throw() {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::mutexLock);
+		return next_symbol(real_mutex_lock, "pthread_mutex_lock")(mutex);
+	}
+
+	int pthread_cond_wait(pthread_cond_t * cond, pthread_mutex_t * mutex) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::blockingCall);
+		return next_symbol(real_cond_wait, "pthread_cond_wait")(cond, mutex);
+	}
+
+	int pthread_cond_timedwait(pthread_cond_t * cond, pthread_mutex_t * mutex, const struct timespec * abstime) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::blockingCall);
+		return next_symbol(real_cond_timedwait, "pthread_cond_timedwait")(cond, mutex, abstime);
+	}
+
+	int sem_wait(sem_t * sem) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::blockingCall);
+		return next_symbol(real_sem_wait, "sem_wait")(sem);
+	}
+
+	int poll(struct pollfd * fds, nfds_t nfds, int timeout) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::blockingCall);
+		return next_symbol(real_poll, "poll")(fds, nfds, timeout);
+	}
+
+	int select(int nfds, fd_set * readfds, fd_set * writefds, fd_set * exceptfds, struct timeval * timeout) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::blockingCall);
+		return next_symbol(real_select, "select")(nfds, readfds, writefds, exceptfds, timeout);
+	}
+
+	int usleep(useconds_t usec) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::sleepCall);
+		return next_symbol(real_usleep, "usleep")(usec);
+	}
+
+	unsigned int sleep(unsigned int seconds) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::sleepCall);
+		return next_symbol(real_sleep, "sleep")(seconds);
+	}
+
+	int nanosleep(const struct timespec * req, struct timespec * rem) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::sleepCall);
+		return next_symbol(real_nanosleep, "nanosleep")(req, rem);
+	}
+
+	int clock_nanosleep(clockid_t clock, int flags, const struct timespec * req, struct timespec * rem) {
+		JackCpp::RTChecker::record(JackCpp::RTChecker::sleepCall);
+		return next_symbol(real_clock_nanosleep, "clock_nanosleep")(clock, flags, req, rem);
+	}
+}
+
+void * operator new(size_t size) JACKCPP_THROW(std::bad_alloc) {
+	JackCpp::RTChecker::record(JackCpp::RTChecker::newCall);
+	void * mem = __libc_malloc(size ? size : 1);
+	if(mem == NULL)
+		throw std::bad_alloc();
+	return mem;
+}
+
+void * operator new[](size_t size) JACKCPP_THROW(std::bad_alloc) {
+	JackCpp::RTChecker::record(JackCpp::RTChecker::newCall);
+	void * mem = __libc_malloc(size ? size : 1);
+	if(mem == NULL)
+		throw std::bad_alloc();
+	return mem;
+}
+
+void * operator new(size_t size, const std::nothrow_t&) throw() {
+	JackCpp::RTChecker::record(JackCpp::RTChecker::newCall);
+	return __libc_malloc(size ? size : 1);
+}
+
+void * operator new[](size_t size, const std::nothrow_t&) throw() {
+	JackCpp::RTChecker::record(JackCpp::RTChecker::newCall);
+	return __libc_malloc(size ? size : 1);
+}
+
+void operator delete(void * ptr) throw() {
+	if(ptr != NULL)
+		JackCpp::RTChecker::record(JackCpp::RTChecker::deleteCall);
+	__libc_free(ptr);
+}
+
+void operator delete[](void * ptr) throw() {
+	if(ptr != NULL)
+		JackCpp::RTChecker::record(JackCpp::RTChecker::deleteCall);
+	__libc_free(ptr);
+}
+
+//the sized versions that C++14 calls when it knows the size
+void operator delete(void * ptr, size_t) throw() {
+	if(ptr != NULL)
+		JackCpp::RTChecker::record(JackCpp::RTChecker::deleteCall);
+	__libc_free(ptr);
+}
+
+void operator delete[](void * ptr, size_t) throw() {
+	if(ptr != NULL)
+		JackCpp::RTChecker::record(JackCpp::RTChecker::deleteCall);
+	__libc_free(ptr);
+}
+
+void operator delete(void * ptr, const std::nothrow_t&) throw() {
+	if(ptr != NULL)
+		JackCpp::RTChecker::record(JackCpp::RTChecker::deleteCall);
+	__libc_free(ptr);
+}
+
+void operator delete[](void * ptr, const std::nothrow_t&) throw() {
+	if(ptr != NULL)
+		JackCpp::RTChecker::record(JackCpp::RTChecker::deleteCall);
+	__libc_free(ptr);
+}
+
+#endif
+
@@ -0,0 +1,166 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jacksampleformat.hpp"
+
+//the conversions are written as plain loops over one sample at a time, with
+//a separate loop for contiguous samples, so that the compiler can vectorize
+//them, only the dithered loops can't be as the noise is generated serially
+
+namespace {
+	//round to the nearest integer and clip to lo..hi, without branches
+	inline int32_t quantize(float v, float lo, float hi){
+		v = (v < lo) ? lo : v;
+		v = (v > hi) ? hi : v;
+		return (int32_t)(v + ((v >= 0.0f) ? 0.5f : -0.5f));
+	}
+
+	struct int16_in {
+		float operator()(int16_t s) const { return (float)s * (1.0f / 32768.0f); }
+	};
+	struct int24_in {
+		float operator()(const JackCpp::Int24& s) const {
+			int32_t v = (int32_t)((uint32_t)s.bytes[0] << 8 | (uint32_t)s.bytes[1] << 16 | (uint32_t)s.bytes[2] << 24);
+			return (float)(v >> 8) * (1.0f / 8388608.0f);
+		}
+	};
+	struct int24in32_in {
+		float operator()(const JackCpp::Int24In32& s) const { return (float)s.value * (1.0f / 8388608.0f); }
+	};
+	struct int32_in {
+		float operator()(int32_t s) const { return (float)((double)s * (1.0 / 2147483648.0)); }
+	};
+	struct double_in {
+		float operator()(double s) const { return (float)s; }
+	};
+	struct float_in {
+		float operator()(float s) const { return s; }
+	};
+
+	struct int16_out {
+		int16_t operator()(float v, float noise) const { return (int16_t)quantize(v * 32768.0f + noise, -32768.0f, 32767.0f); }
+	};
+	struct int24_out {
+		JackCpp::Int24 operator()(float v, float noise) const {
+			int32_t q = quantize(v * 8388608.0f + noise, -8388608.0f, 8388607.0f);
+			JackCpp::Int24 s;
+			s.bytes[0] = (unsigned char)(q & 0xff);
+			s.bytes[1] = (unsigned char)((q >> 8) & 0xff);
+			s.bytes[2] = (unsigned char)((q >> 16) & 0xff);
+			return s;
+		}
+	};
+	struct int24in32_out {
+		JackCpp::Int24In32 operator()(float v, float noise) const {
+			JackCpp::Int24In32 s;
+			s.value = quantize(v * 8388608.0f + noise, -8388608.0f, 8388607.0f);
+			return s;
+		}
+	};
+	//a float doesn't have the precision to fill 32 bits, so this goes through a double
+	struct int32_out {
+		int32_t operator()(float v, float) const {
+			double d = (double)v * 2147483648.0;
+			d = (d < -2147483648.0) ? -2147483648.0 : d;
+			d = (d > 2147483647.0) ? 2147483647.0 : d;
+			return (int32_t)(d + ((d >= 0.0) ? 0.5 : -0.5));
+		}
+	};
+	struct double_out {
+		double operator()(float v, float) const { return (double)v; }
+	};
+	struct float_out {
+		float operator()(float v, float) const { return v; }
+	};
+
+	template<typename Sample, typename Convert>
+		void convert_in(const Sample * src, unsigned int stride, jack_default_audio_sample_t * dest,
+				unsigned int cnt, Convert convert){
+			if(stride == 1){
+				for(unsigned int i = 0; i < cnt; i++)
+					dest[i] = convert(src[i]);
+			} else {
+				for(unsigned int i = 0; i < cnt; i++)
+					dest[i] = convert(src[i * stride]);
+			}
+		}
+
+	template<typename Sample, typename Convert>
+		void convert_out(const jack_default_audio_sample_t * src, Sample * dest, unsigned int stride,
+				unsigned int cnt, Convert convert, JackCpp::Dither * dither){
+			if(dither != NULL){
+				for(unsigned int i = 0; i < cnt; i++)
+					dest[i * stride] = convert(src[i], dither->next());
+			} else if(stride == 1){
+				for(unsigned int i = 0; i < cnt; i++)
+					dest[i] = convert(src[i], 0.0f);
+			} else {
+				for(unsigned int i = 0; i < cnt; i++)
+					dest[i * stride] = convert(src[i], 0.0f);
+			}
+		}
+}
+
+void JackCpp::toFloat(const int16_t * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt){
+	convert_in(src, srcStride, dest, cnt, int16_in());
+}
+
+void JackCpp::toFloat(const Int24 * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt){
+	convert_in(src, srcStride, dest, cnt, int24_in());
+}
+
+void JackCpp::toFloat(const Int24In32 * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt){
+	convert_in(src, srcStride, dest, cnt, int24in32_in());
+}
+
+void JackCpp::toFloat(const int32_t * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt){
+	convert_in(src, srcStride, dest, cnt, int32_in());
+}
+
+void JackCpp::toFloat(const double * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt){
+	convert_in(src, srcStride, dest, cnt, double_in());
+}
+
+void JackCpp::toFloat(const jack_default_audio_sample_t * src, unsigned int srcStride, jack_default_audio_sample_t * dest, unsigned int cnt){
+	convert_in(src, srcStride, dest, cnt, float_in());
+}
+
+void JackCpp::fromFloat(const jack_default_audio_sample_t * src, int16_t * dest, unsigned int destStride, unsigned int cnt, Dither * dither){
+	convert_out(src, dest, destStride, cnt, int16_out(), dither);
+}
+
+void JackCpp::fromFloat(const jack_default_audio_sample_t * src, Int24 * dest, unsigned int destStride, unsigned int cnt, Dither * dither){
+	convert_out(src, dest, destStride, cnt, int24_out(), dither);
+}
+
+void JackCpp::fromFloat(const jack_default_audio_sample_t * src, Int24In32 * dest, unsigned int destStride, unsigned int cnt, Dither * dither){
+	convert_out(src, dest, destStride, cnt, int24in32_out(), dither);
+}
+
+//the formats below can hold a float exactly enough that dithering is pointless
+void JackCpp::fromFloat(const jack_default_audio_sample_t * src, int32_t * dest, unsigned int destStride, unsigned int cnt, Dither *){
+	convert_out(src, dest, destStride, cnt, int32_out(), (Dither *)NULL);
+}
+
+void JackCpp::fromFloat(const jack_default_audio_sample_t * src, double * dest, unsigned int destStride, unsigned int cnt, Dither *){
+	convert_out(src, dest, destStride, cnt, double_out(), (Dither *)NULL);
+}
+
+void JackCpp::fromFloat(const jack_default_audio_sample_t * src, jack_default_audio_sample_t * dest, unsigned int destStride, unsigned int cnt, Dither *){
+	convert_out(src, dest, destStride, cnt, float_out(), (Dither *)NULL);
+}
@@ -0,0 +1,295 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackstreamreactor.hpp"
+#include <algorithm>
+#include <utility>
+#include <poll.h>
+
+JackCpp::QueueExecutor::QueueExecutor() : mStopped(false) {
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCond, NULL);
+}
+
+JackCpp::QueueExecutor::~QueueExecutor(){
+	pthread_cond_destroy(&mCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+void JackCpp::QueueExecutor::post(task_t task, void * arg){
+	entry_t entry;
+	entry.task = task;
+	entry.arg = arg;
+	pthread_mutex_lock(&mMutex);
+	mTasks.push_back(entry);
+	pthread_cond_signal(&mCond);
+	pthread_mutex_unlock(&mMutex);
+}
+
+void JackCpp::QueueExecutor::run(){
+	pthread_mutex_lock(&mMutex);
+	while(!mStopped){
+		if(mTasks.empty()){
+			pthread_cond_wait(&mCond, &mMutex);
+			continue;
+		}
+		entry_t entry = mTasks.front();
+		mTasks.pop_front();
+		//run the task without the lock so that it can post more
+		pthread_mutex_unlock(&mMutex);
+		entry.task(entry.arg);
+		pthread_mutex_lock(&mMutex);
+	}
+	pthread_mutex_unlock(&mMutex);
+}
+
+unsigned int JackCpp::QueueExecutor::poll(){
+	//tasks posted while we run are left for next time
+	pthread_mutex_lock(&mMutex);
+	unsigned int cnt = mTasks.size();
+	pthread_mutex_unlock(&mMutex);
+	for(unsigned int i = 0; i < cnt; i++){
+		pthread_mutex_lock(&mMutex);
+		entry_t entry = mTasks.front();
+		mTasks.pop_front();
+		pthread_mutex_unlock(&mMutex);
+		entry.task(entry.arg);
+	}
+	return cnt;
+}
+
+void JackCpp::QueueExecutor::stop(){
+	pthread_mutex_lock(&mMutex);
+	mStopped = true;
+	pthread_cond_broadcast(&mCond);
+	pthread_mutex_unlock(&mMutex);
+}
+
+void JackCpp::QueueExecutor::restart(){
+	pthread_mutex_lock(&mMutex);
+	mStopped = false;
+	pthread_mutex_unlock(&mMutex);
+}
+
+JackCpp::StreamReactor::StreamReactor(Executor * executor)
+	JACKCPP_THROW(std::runtime_error) :
+	mExecutor(executor), mStopping(false), mPending(0)
+{
+	if(mExecutor == NULL)
+		mExecutor = &mInline;
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCancelled, NULL);
+	if(pthread_create(&mThread, NULL, StreamReactor::run, this) != 0){
+		pthread_cond_destroy(&mCancelled);
+		pthread_mutex_destroy(&mMutex);
+		throw std::runtime_error("cannot start stream reactor thread");
+	}
+}
+
+JackCpp::StreamReactor::~StreamReactor(){
+	pthread_mutex_lock(&mMutex);
+	mStopping = true;
+	pthread_mutex_unlock(&mMutex);
+	mWake.notify();
+	pthread_join(mThread, NULL);
+
+	for(std::list<request_t *>::iterator it = mActive.begin(); it != mActive.end(); it++)
+		complete(*it);
+	mActive.clear();
+	for(unsigned int i = 0; i < mSubmitted.size(); i++)
+		complete(mSubmitted[i]);
+	mSubmitted.clear();
+	pthread_cond_destroy(&mCancelled);
+	pthread_mutex_destroy(&mMutex);
+}
+
+void JackCpp::StreamReactor::readFrames(BlockingAudioIO& io, jack_default_audio_sample_t * dest,
+		unsigned int frames, completion_t completion, void * arg)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(io.inPorts() == 0)
+		throw std::runtime_error("JackCpp::StreamReactor::readFrames the stream has no inputs");
+	request_t * request = new request_t;
+	request->io = &io;
+	request->dest = dest;
+	request->src = NULL;
+	request->frames = frames;
+	request->done = 0;
+	request->completion = completion;
+	request->arg = arg;
+	submit(request);
+}
+
+void JackCpp::StreamReactor::writeFrames(BlockingAudioIO& io, const jack_default_audio_sample_t * src,
+		unsigned int frames, completion_t completion, void * arg)
+	JACKCPP_THROW(std::runtime_error)
+{
+	if(io.outPorts() == 0)
+		throw std::runtime_error("JackCpp::StreamReactor::writeFrames the stream has no outputs");
+	request_t * request = new request_t;
+	request->io = &io;
+	request->dest = NULL;
+	request->src = src;
+	request->frames = frames;
+	request->done = 0;
+	request->completion = completion;
+	request->arg = arg;
+	submit(request);
+}
+
+void JackCpp::StreamReactor::cancel(BlockingAudioIO& io){
+	pthread_mutex_lock(&mMutex);
+	mCancelling.push_back(&io);
+	mWake.notify();
+	while(std::find(mCancelling.begin(), mCancelling.end(), &io) != mCancelling.end())
+		pthread_cond_wait(&mCancelled, &mMutex);
+	pthread_mutex_unlock(&mMutex);
+}
+
+void JackCpp::StreamReactor::submit(request_t * request){
+	__sync_add_and_fetch(&mPending, 1);
+	pthread_mutex_lock(&mMutex);
+	mSubmitted.push_back(request);
+	pthread_mutex_unlock(&mMutex);
+	mWake.notify();
+}
+
+void JackCpp::StreamReactor::complete(request_t * request){
+	__sync_sub_and_fetch(&mPending, 1);
+	mExecutor->post(StreamReactor::runCompletion, request);
+}
+
+void JackCpp::StreamReactor::runCompletion(void * arg){
+	request_t * request = (request_t *)arg;
+	request->completion(request->arg, request->done);
+	delete request;
+}
+
+bool JackCpp::StreamReactor::transfer(request_t * request){
+	BlockingAudioIO * io = request->io;
+	unsigned int remaining = request->frames - request->done;
+	try {
+		//clear before moving frames so that a signal from a callback
+		//that runs in between isn't lost
+		if(request->src != NULL){
+			unsigned int chans = io->outPorts();
+			io->clearOutputReady();
+			request->done += io->writeBlock(request->src + request->done * chans, remaining, chans, false);
+		} else {
+			unsigned int chans = io->inPorts();
+			io->clearInputReady();
+			request->done += io->readBlock(request->dest + request->done * chans, remaining, chans, false);
+		}
+	} catch (std::runtime_error& e){
+		//the stream changed under us, give up on the request
+		return true;
+	}
+	remaining = request->frames - request->done;
+	if(remaining == 0)
+		return true;
+
+	//wake up when we can finish, or when a period has arrived if that is less
+	unsigned int watermark = std::min(remaining, (unsigned int)io->getBufferSize());
+	if(request->src != NULL)
+		io->setOutputWatermark(watermark);
+	else
+		io->setInputWatermark(watermark);
+	return false;
+}
+
+void * JackCpp::StreamReactor::run(void * arg){
+	((StreamReactor *)arg)->loop();
+	return NULL;
+}
+
+void JackCpp::StreamReactor::loop(){
+	typedef std::pair<BlockingAudioIO *, bool> key_t;
+	std::vector<struct pollfd> fds;
+	std::vector<key_t> blocked;
+	std::vector<request_t *> submitted;
+	std::vector<BlockingAudioIO *> cancelling;
+
+	while(true){
+		mWake.clear();
+		pthread_mutex_lock(&mMutex);
+		submitted.swap(mSubmitted);
+		cancelling = mCancelling;
+		bool stopping = mStopping;
+		pthread_mutex_unlock(&mMutex);
+		//the destructor completes whatever is left
+		if(stopping)
+			break;
+
+		mActive.insert(mActive.end(), submitted.begin(), submitted.end());
+		submitted.clear();
+
+		if(!cancelling.empty()){
+			std::list<request_t *>::iterator it = mActive.begin();
+			while(it != mActive.end()){
+				if(std::find(cancelling.begin(), cancelling.end(), (*it)->io) != cancelling.end()){
+					complete(*it);
+					it = mActive.erase(it);
+				} else
+					it++;
+			}
+			pthread_mutex_lock(&mMutex);
+			for(unsigned int i = 0; i < cancelling.size(); i++){
+				std::vector<BlockingAudioIO *>::iterator c =
+					std::find(mCancelling.begin(), mCancelling.end(), cancelling[i]);
+				if(c != mCancelling.end())
+					mCancelling.erase(c);
+			}
+			pthread_cond_broadcast(&mCancelled);
+			pthread_mutex_unlock(&mMutex);
+		}
+
+		//the first unfinished request of each stream and direction holds up
+		//the ones queued after it, and is what we wait on
+		fds.clear();
+		blocked.clear();
+		struct pollfd wake;
+		wake.fd = mWake.fd();
+		wake.events = POLLIN;
+		wake.revents = 0;
+		fds.push_back(wake);
+
+		std::list<request_t *>::iterator it = mActive.begin();
+		while(it != mActive.end()){
+			request_t * request = *it;
+			key_t key(request->io, request->src != NULL);
+			if(std::find(blocked.begin(), blocked.end(), key) != blocked.end()){
+				it++;
+				continue;
+			}
+			if(transfer(request)){
+				complete(request);
+				it = mActive.erase(it);
+				continue;
+			}
+			blocked.push_back(key);
+			struct pollfd ready;
+			ready.fd = key.second ? request->io->outputReadyFd() : request->io->inputReadyFd();
+			ready.events = POLLIN;
+			ready.revents = 0;
+			fds.push_back(ready);
+			it++;
+		}
+
+		::poll(&fds[0], fds.size(), -1);
+	}
+}
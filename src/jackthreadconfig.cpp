@@ -0,0 +1,147 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+#include "jackthreadconfig.hpp"
+#include <pthread.h>
+#include <errno.h>
+#include <string.h>
+#include <alloca.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define JACKCPP_HAVE_MXCSR
+#endif
+
+namespace {
+#ifdef JACKCPP_HAVE_MXCSR
+	//flush to zero and denormals are zero
+	const unsigned int mxcsr_ftz = 0x8000;
+	const unsigned int mxcsr_daz = 0x0040;
+#elif defined(__aarch64__)
+	//flush to zero, arm has no separate bit for inputs
+	const unsigned long fpcr_fz = 1UL << 24;
+#endif
+
+	//how much stack we can touch without running off the end
+	size_t stack_room(size_t wanted){
+#ifdef __linux__
+		pthread_attr_t attr;
+		if(pthread_getattr_np(pthread_self(), &attr) != 0)
+			return 0;
+		size_t size = 0;
+		void * addr;
+		pthread_attr_getstack(&attr, &addr, &size);
+		pthread_attr_destroy(&attr);
+		//leave room for what is already in use and for our callers
+		const size_t margin = 64 * 1024;
+		if(size <= 2 * margin)
+			return 0;
+		if(wanted > size - 2 * margin)
+			wanted = size - 2 * margin;
+		return wanted;
+#else
+		return wanted;
+#endif
+	}
+
+	//touch every page of bytes of stack below us
+	void __attribute__((noinline)) prefault_stack(size_t bytes){
+		volatile char * stack = (volatile char *)alloca(bytes);
+		size_t page = sysconf(_SC_PAGESIZE);
+		for(size_t i = 0; i < bytes; i += page)
+			stack[i] = 0;
+	}
+}
+
+void JackCpp::setDenormalFlushing(bool flush){
+#ifdef JACKCPP_HAVE_MXCSR
+	unsigned int csr = _mm_getcsr();
+	if(flush)
+		csr |= mxcsr_ftz | mxcsr_daz;
+	else
+		csr &= ~(mxcsr_ftz | mxcsr_daz);
+	_mm_setcsr(csr);
+#elif defined(__aarch64__)
+	unsigned long fpcr;
+	__asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+	if(flush)
+		fpcr |= fpcr_fz;
+	else
+		fpcr &= ~fpcr_fz;
+	__asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#else
+	(void)flush;
+#endif
+}
+
+bool JackCpp::denormalsFlushed(){
+#ifdef JACKCPP_HAVE_MXCSR
+	return (_mm_getcsr() & (mxcsr_ftz | mxcsr_daz)) == (mxcsr_ftz | mxcsr_daz);
+#elif defined(__aarch64__)
+	unsigned long fpcr;
+	__asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+	return (fpcr & fpcr_fz) != 0;
+#else
+	return false;
+#endif
+}
+
+JackCpp::ThreadStatus JackCpp::applyThreadConfig(const ThreadConfig& config){
+	ThreadStatus status;
+
+	if(!config.cpus.empty()){
+#ifdef __linux__
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for(unsigned int i = 0; i < config.cpus.size(); i++)
+			CPU_SET(config.cpus[i], &set);
+		int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		if(ret == 0)
+			status.affinitySet = true;
+		else
+			status.error = ret;
+#else
+		status.error = ENOTSUP;
+#endif
+	}
+
+	if(config.denormals == ThreadConfig::flushDenormals)
+		setDenormalFlushing(true);
+	status.denormalsFlushed = denormalsFlushed();
+
+	if(config.mlock != ThreadConfig::mlockUnchanged){
+		int flags = MCL_CURRENT;
+		if(config.mlock == ThreadConfig::mlockCurrentAndFuture)
+			flags |= MCL_FUTURE;
+		if(mlockall(flags) == 0)
+			status.memoryLocked = true;
+		else
+			status.error = errno;
+	}
+
+	//after mlockall so the pages we touch stay put
+	if(config.stackPrefault > 0){
+		status.stackPrefaulted = stack_room(config.stackPrefault);
+		if(status.stackPrefaulted > 0)
+			prefault_stack(status.stackPrefaulted);
+	}
+
+	status.applied = true;
+	return status;
+}
+
@@ -0,0 +1,105 @@
+//C++ Classes that wrap JACK
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jacktransport.hpp"
+#include <math.h>
+
+JackCpp::TransportInfo::TransportInfo() :
+	state(JackTransportStopped), frame(0), frameRate(0), usecs(0),
+	hasBBT(false), bar(1), beat(1), tick(0), barStartTick(0.0),
+	beatsPerBar(4.0f), beatType(4.0f), ticksPerBeat(1920.0), beatsPerMinute(120.0),
+	bbtOffset(0)
+{
+}
+
+void JackCpp::TransportInfo::set(jack_transport_state_t transportState, const jack_position_t& pos){
+	state = transportState;
+	frame = pos.frame;
+	frameRate = pos.frame_rate;
+	usecs = pos.usecs;
+	hasBBT = (pos.valid & JackPositionBBT) != 0;
+	if(hasBBT){
+		bar = pos.bar;
+		beat = pos.beat;
+		tick = pos.tick;
+		barStartTick = pos.bar_start_tick;
+		beatsPerBar = pos.beats_per_bar;
+		beatType = pos.beat_type;
+		ticksPerBeat = pos.ticks_per_beat;
+		beatsPerMinute = pos.beats_per_minute;
+	}
+	bbtOffset = (pos.valid & JackBBTFrameOffset) ? pos.bbt_offset : 0;
+}
+
+double JackCpp::TransportInfo::framesPerBeat() const {
+	if(!hasBBT || beatsPerMinute <= 0.0)
+		return 0.0;
+	return frameRate * 60.0 / beatsPerMinute;
+}
+
+double JackCpp::TransportInfo::beatPosition() const {
+	if(!hasBBT || ticksPerBeat <= 0.0)
+		return 0.0;
+	double beats = (bar - 1) * (double)beatsPerBar + (beat - 1) + tick / ticksPerBeat;
+	//the bbt information may describe a frame after the start of the cycle
+	double fpb = framesPerBeat();
+	if(bbtOffset != 0 && fpb > 0.0)
+		beats -= bbtOffset / fpb;
+	return beats;
+}
+
+JackCpp::BeatGrid::BeatGrid(unsigned int divisions){
+	setDivisions(divisions);
+}
+
+void JackCpp::BeatGrid::setDivisions(unsigned int divisions){
+	mDivisions = (divisions == 0) ? 1 : divisions;
+}
+
+unsigned int JackCpp::BeatGrid::find(const TransportInfo& transport, jack_nframes_t nframes,
+		event_t * events, unsigned int maxEvents) const {
+	double fpb = transport.framesPerBeat();
+	if(!transport.rolling() || fpb <= 0.0)
+		return 0;
+
+	double framesPerLine = fpb / mDivisions;
+	double start = transport.beatPosition() * mDivisions;
+	int64_t beatsPerBar = (int64_t)transport.beatsPerBar;
+	if(beatsPerBar < 1)
+		beatsPerBar = 1;
+
+	unsigned int cnt = 0;
+	//the first grid line at or after the start of the cycle
+	for(int64_t line = (int64_t)ceil(start); cnt < maxEvents; line++){
+		double offset = (line - start) * framesPerLine;
+		jack_nframes_t frame = (jack_nframes_t)floor(offset + 0.5);
+		if(offset >= nframes || frame >= nframes)
+			break;
+		//before the start of the song
+		if(line < 0)
+			continue;
+		int64_t beatIndex = line / mDivisions;
+		events[cnt].offset = frame;
+		events[cnt].bar = (int32_t)(beatIndex / beatsPerBar) + 1;
+		events[cnt].beat = (int32_t)(beatIndex % beatsPerBar) + 1;
+		events[cnt].division = (unsigned int)(line % mDivisions);
+		cnt++;
+	}
+	return cnt;
+}
+
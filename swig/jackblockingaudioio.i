@@ -23,3 +23,46 @@ class BlockingAudioIO : public AudioIO {
    bool tryRead(unsigned int channel, jack_default_audio_sample_t &val);
 };
 
+#ifdef SWIGPYTHON
+/* block read and write for numpy arrays and other buffer objects, the
+ * samples are copied straight between the object's memory and the ring
+ * buffers and the GIL is released while we wait */
+%extend BlockingAudioIO {
+   PyObject * writeBlock(PyObject * data, bool block = true) {
+      Py_buffer view;
+      unsigned int frames;
+      unsigned int written;
+      if (!jackcpp_get_block(data, &view, $self->outPorts(), false, &frames))
+         return NULL;
+      Py_BEGIN_ALLOW_THREADS
+      written = $self->writeBlock((const jack_default_audio_sample_t *)view.buf,
+            frames, $self->outPorts(), block);
+      Py_END_ALLOW_THREADS
+      PyBuffer_Release(&view);
+      return PyLong_FromUnsignedLong(written);
+   }
+
+   PyObject * readBlockInto(PyObject * data, bool block = true) {
+      Py_buffer view;
+      unsigned int frames;
+      unsigned int read;
+      if (!jackcpp_get_block(data, &view, $self->inPorts(), true, &frames))
+         return NULL;
+      Py_BEGIN_ALLOW_THREADS
+      read = $self->readBlock((jack_default_audio_sample_t *)view.buf,
+            frames, $self->inPorts(), block);
+      Py_END_ALLOW_THREADS
+      PyBuffer_Release(&view);
+      return PyLong_FromUnsignedLong(read);
+   }
+
+   %pythoncode %{
+   def readBlock(self, frames, block=True):
+      """Read frames frames into a new (frames, inPorts()) numpy float32 array"""
+      import numpy
+      data = numpy.empty((frames, self.inPorts()), dtype=numpy.float32)
+      return data[:self.readBlockInto(data, block)]
+   %}
+};
+#endif
+
@@ -4,6 +4,51 @@
 %include "std_string.i"
 %include "std_except.i"
 
+#ifdef SWIGPYTHON
+%{
+#include <string.h>
+/* get a float32 buffer holding whole frames of channels samples, either
+ * (frames, channels) shaped or flat and interleaved */
+static bool jackcpp_get_block(PyObject * obj, Py_buffer * view, unsigned int channels,
+      bool writable, unsigned int * frames) {
+   int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+   if (writable)
+      flags |= PyBUF_WRITABLE;
+   if (PyObject_GetBuffer(obj, view, flags) != 0)
+      return false;
+
+   const char * format = view->format ? view->format : "B";
+   size_t len = strlen(format);
+   bool native = len == 1 || (len == 2 && (format[0] == '@' || format[0] == '=' ||
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            format[0] == '>' || format[0] == '!'
+#else
+            format[0] == '<'
+#endif
+            ));
+   if (view->itemsize != sizeof(float) || format[len - 1] != 'f' || !native) {
+      PyErr_SetString(PyExc_ValueError, "block must hold native float32 samples");
+      PyBuffer_Release(view);
+      return false;
+   }
+
+   Py_ssize_t items = view->len / view->itemsize;
+   if (view->ndim == 2 && view->shape[1] == (Py_ssize_t)channels) {
+      *frames = (unsigned int)view->shape[0];
+   } else if (view->ndim <= 1 && channels > 0 && items % channels == 0) {
+      *frames = (unsigned int)(items / channels);
+   } else if (channels == 0 && items == 0) {
+      *frames = 0;
+   } else {
+      PyErr_Format(PyExc_ValueError, "block must have shape (frames, %u)", channels);
+      PyBuffer_Release(view);
+      return false;
+   }
+   return true;
+}
+%}
+#endif
+
 %include "jackaudioio.i"
 %include "jackblockingaudioio.i"
 
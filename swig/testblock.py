@@ -0,0 +1,27 @@
+import jackaudio
+import numpy
+
+chans = 2
+frames = 1024
+
+o = jackaudio.BlockingAudioIO("jackpython-block",chans,chans)
+
+o.start()
+
+for i in range(2):
+  o.connectToPhysical(i,i)
+  o.connectFromPhysical(i,i)
+
+#a second of a 440 Hz tone, a block at a time
+rate = o.getSampleRate()
+t = numpy.arange(rate, dtype=numpy.float32) / rate
+tone = (numpy.sin(2 * numpy.pi * 440.0 * t) * 0.5).astype(numpy.float32)
+for start in range(0, rate - frames, frames):
+  block = numpy.repeat(tone[start:start + frames, numpy.newaxis], chans, axis=1)
+  o.writeBlock(block)
+
+#then pass the input through, reading into the same array every time
+block = numpy.zeros((frames, chans), dtype=numpy.float32)
+while(True):
+  n = o.readBlockInto(block)
+  o.writeBlock(block[:n])
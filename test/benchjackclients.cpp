@@ -0,0 +1,356 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+//starts clients clients with ports inputs and outputs each, plain AudioIOs
+//that apply a gain or BlockingAudioIOs with a thread passing the input to
+//the output, and prints what they cost as one JSON object
+//
+//in server mode the clients are activated on the running server, chained
+//output to input, which benchjackclients.sh starts with the dummy driver
+//for each buffer size.  in inprocess mode the clients are never activated
+//and their process callbacks are called in turn from one thread, as fast
+//as they will go, which times the library's own work without the server
+//
+//usage: benchjackclients [-k audioio|blocking] [-m server|inprocess]
+//	[-c clients] [-p ports] [-s seconds] [-b buffer size, inprocess only]
+
+#include "jackblockingaudioio.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+using std::cout;
+using std::endl;
+
+namespace {
+	double now_usecs(){
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+	}
+
+	//the resident memory of the process
+	size_t resident_bytes(){
+		FILE * f = fopen("/proc/self/statm", "r");
+		unsigned long size = 0, resident = 0;
+		if(f != NULL){
+			if(fscanf(f, "%lu %lu", &size, &resident) != 2)
+				resident = 0;
+			fclose(f);
+		}
+		return resident * sysconf(_SC_PAGESIZE);
+	}
+
+	//times kept by the callback, which doesn't allocate, it stops keeping
+	//them when it runs out of room
+	struct timings_t {
+		std::vector<double> dsp;
+		std::vector<double> wakeup;
+		volatile unsigned int count;
+		volatile double start;
+		timings_t(size_t capacity) : dsp(capacity), wakeup(capacity), count(0), start(0.0) {}
+	};
+
+	//called at the start of processAudio, wakeup is how far into the cycle we are
+	void begin_cycle(jack_client_t * client, timings_t& t, bool server){
+		t.start = now_usecs();
+		if(t.count >= t.dsp.size())
+			return;
+		t.wakeup[t.count] = 0.0;
+		if(server){
+			jack_nframes_t frames;
+			jack_time_t usecs, next;
+			float period;
+			if(jack_get_cycle_times(client, &frames, &usecs, &next, &period) == 0)
+				t.wakeup[t.count] = (double)(jack_get_time() - usecs);
+		}
+	}
+
+	void end_cycle(timings_t& t){
+		if(t.count >= t.dsp.size())
+			return;
+		t.dsp[t.count] = now_usecs() - t.start;
+		t.count = t.count + 1;
+	}
+
+	class GainClient : public JackCpp::AudioIO {
+		public:
+			GainClient(std::string name, unsigned int ports, size_t cycles, bool server) :
+				JackCpp::AudioIO(name, ports, ports, false), mTimings(cycles), mServer(server) {}
+			virtual ~GainClient(){
+				if(getState() == JackCpp::AudioIO::active)
+					stop();
+			}
+			virtual int processAudio(jack_nframes_t nframes,
+					const audioBufVector& inBufs,
+					const audioBufVector& outBufs){
+				begin_cycle(client(), mTimings, mServer);
+				for(unsigned int i = 0; i < outBufs.size(); i++){
+					for(unsigned int j = 0; j < nframes; j++)
+						outBufs[i][j] = 0.5f * inBufs[i][j];
+				}
+				end_cycle(mTimings);
+				return 0;
+			}
+			timings_t mTimings;
+		private:
+			bool mServer;
+	};
+
+	class BlockingClient : public JackCpp::BlockingAudioIO {
+		public:
+			BlockingClient(std::string name, unsigned int ports, size_t cycles, bool server) :
+				JackCpp::BlockingAudioIO(name, ports, ports, 0, 0, false), mTimings(cycles), mServer(server) {}
+			virtual ~BlockingClient(){
+				if(getState() == JackCpp::AudioIO::active)
+					stop();
+			}
+			virtual int processAudio(jack_nframes_t nframes,
+					const audioBufVector& inBufs,
+					const audioBufVector& outBufs){
+				begin_cycle(client(), mTimings, mServer);
+				int ret = JackCpp::BlockingAudioIO::processAudio(nframes, inBufs, outBufs);
+				end_cycle(mTimings);
+				return ret;
+			}
+			timings_t mTimings;
+		private:
+			bool mServer;
+	};
+
+	//passes a BlockingClient's input to its output until running is cleared
+	struct pump_t {
+		BlockingClient * client;
+		unsigned int ports;
+		unsigned int period;
+		volatile bool running;
+		pthread_t thread;
+	};
+
+	void * pump(void * arg){
+		pump_t * p = (pump_t *)arg;
+		std::vector<jack_default_audio_sample_t> buf(p->period * p->ports);
+		while(p->running){
+			unsigned int got = p->client->readBlock(&buf[0], p->period, p->ports, false);
+			if(got > 0)
+				p->client->writeBlock(&buf[0], got, p->ports, false);
+			else
+				usleep(200);
+		}
+		return NULL;
+	}
+
+	std::string json_summary(std::vector<double> values){
+		std::ostringstream out;
+		if(values.empty())
+			return "null";
+		std::sort(values.begin(), values.end());
+		double sum = 0.0;
+		for(unsigned int i = 0; i < values.size(); i++)
+			sum += values[i];
+		out << "{\"count\": " << values.size()
+			<< ", \"mean\": " << sum / values.size()
+			<< ", \"median\": " << values[values.size() / 2]
+			<< ", \"p99\": " << values[(values.size() * 99) / 100]
+			<< ", \"max\": " << values.back() << "}";
+		return out.str();
+	}
+
+	void usage(){
+		std::cerr << "usage: benchjackclients [-k audioio|blocking] [-m server|inprocess]"
+			" [-c clients] [-p ports] [-s seconds] [-b buffer size]" << endl;
+		exit(2);
+	}
+}
+
+int main(int argc, char * argv[]){
+	std::string kind = "audioio";
+	std::string mode = "server";
+	unsigned int clients = 4;
+	unsigned int ports = 2;
+	double seconds = 5.0;
+	jack_nframes_t bufferSize = 0;
+	int opt;
+	while((opt = getopt(argc, argv, "k:m:c:p:s:b:")) != -1){
+		switch(opt){
+			case 'k': kind = optarg; break;
+			case 'm': mode = optarg; break;
+			case 'c': clients = atoi(optarg); break;
+			case 'p': ports = atoi(optarg); break;
+			case 's': seconds = atof(optarg); break;
+			case 'b': bufferSize = atoi(optarg); break;
+			default: usage();
+		}
+	}
+	const bool blocking = kind == "blocking";
+	const bool server = mode == "server";
+	if((!blocking && kind != "audioio") || (!server && mode != "inprocess") || clients == 0 || ports == 0)
+		usage();
+
+	size_t before = resident_bytes();
+	std::vector<JackCpp::AudioIO *> io;
+	std::vector<timings_t *> timings;
+	std::vector<pump_t *> pumps;
+	jack_nframes_t rate = 0;
+	size_t cycles = 0;
+	try {
+		for(unsigned int i = 0; i < clients; i++){
+			std::ostringstream name;
+			name << "bench" << i;
+			if(i == 0){
+				//find out the size of the cycles before making room for their times
+				JackCpp::AudioIO probe(name.str() + "probe", 0, 0, false);
+				rate = probe.getSampleRate();
+				if(bufferSize == 0 || server)
+					bufferSize = probe.getBufferSize();
+				probe.close();
+				cycles = (size_t)(seconds * rate / bufferSize) * 2 + 64;
+			}
+			if(blocking){
+				BlockingClient * c = new BlockingClient(name.str(), ports, cycles, server);
+				io.push_back(c);
+				timings.push_back(&c->mTimings);
+			} else {
+				GainClient * c = new GainClient(name.str(), ports, cycles, server);
+				io.push_back(c);
+				timings.push_back(&c->mTimings);
+			}
+		}
+	} catch (std::runtime_error& e){
+		std::cerr << "cannot start the clients: " << e.what() << endl;
+		exit(1);
+	}
+
+	std::vector<double> callback;
+	std::vector<double> overhead;
+	std::vector<double> loads;
+	unsigned int xruns = 0;
+	size_t during = 0;
+	JackCpp::BlockingAudioIO::xrun_stats_t userXruns;
+	memset(&userXruns, 0, sizeof(userXruns));
+
+	if(server){
+		for(unsigned int i = 0; i < clients; i++){
+			io[i]->start();
+			if(i > 0){
+				for(unsigned int p = 0; p < ports; p++)
+					io[i]->connectFrom(p, io[i - 1]->getOutputPortName(p));
+			}
+			if(blocking){
+				pump_t * p = new pump_t;
+				p->client = (BlockingClient *)io[i];
+				p->ports = ports;
+				p->period = bufferSize;
+				p->running = true;
+				pthread_create(&p->thread, NULL, pump, p);
+				pumps.push_back(p);
+			}
+		}
+		//let the graph settle, then count from there
+		usleep(500000);
+		JackCpp::GraphEvent event;
+		while(io[0]->getGraphEvent(event))
+			;
+		for(unsigned int i = 0; i < clients; i++){
+			timings[i]->count = 0;
+			if(blocking)
+				((BlockingClient *)io[i])->resetXrunStats();
+		}
+		during = resident_bytes();
+		double end = now_usecs() + seconds * 1000000.0;
+		while(now_usecs() < end){
+			usleep(100000);
+			loads.push_back(io[0]->getCpuLoad());
+			while(io[0]->getGraphEvent(event)){
+				if(event.type == JackCpp::GraphEvent::xrun)
+					xruns++;
+			}
+		}
+		for(unsigned int i = 0; i < pumps.size(); i++){
+			pumps[i]->running = false;
+			pthread_join(pumps[i]->thread, NULL);
+			delete pumps[i];
+		}
+		for(unsigned int i = 0; i < clients; i++){
+			if(blocking){
+				JackCpp::BlockingAudioIO::xrun_stats_t s = ((BlockingClient *)io[i])->getXrunStats();
+				userXruns.outputUnderruns += s.outputUnderruns;
+				userXruns.inputOverruns += s.inputOverruns;
+			}
+			io[i]->stop();
+		}
+	} else {
+		for(unsigned int i = 0; i < clients; i++)
+			io[i]->jackBufferSizeCallback(bufferSize);
+		during = resident_bytes();
+		const size_t run = (size_t)(seconds * rate / bufferSize);
+		for(size_t cycle = 0; cycle < run; cycle++){
+			for(unsigned int i = 0; i < clients; i++){
+				unsigned int index = timings[i]->count;
+				double start = now_usecs();
+				JackCpp::AudioIO::jackProcessCallback(bufferSize, io[i]);
+				double took = now_usecs() - start;
+				if(index < timings[i]->count){
+					callback.push_back(took);
+					overhead.push_back(took - timings[i]->dsp[index]);
+				}
+			}
+		}
+	}
+
+	std::vector<double> dsp;
+	std::vector<double> wakeup;
+	for(unsigned int i = 0; i < clients; i++){
+		dsp.insert(dsp.end(), timings[i]->dsp.begin(), timings[i]->dsp.begin() + timings[i]->count);
+		if(server)
+			wakeup.insert(wakeup.end(), timings[i]->wakeup.begin(), timings[i]->wakeup.begin() + timings[i]->count);
+	}
+
+	cout << "{\"kind\": \"" << kind << "\", \"mode\": \"" << mode << "\""
+		<< ", \"clients\": " << clients << ", \"ports\": " << ports
+		<< ", \"buffer_size\": " << bufferSize << ", \"sample_rate\": " << rate
+		<< ", \"seconds\": " << seconds << ", \"cycles\": " << dsp.size() / clients
+		<< ", \"callback_us\": " << json_summary(callback)
+		<< ", \"overhead_us\": " << json_summary(overhead)
+		<< ", \"dsp_us\": " << json_summary(dsp)
+		<< ", \"wakeup_us\": " << json_summary(wakeup)
+		<< ", \"dsp_load_percent\": " << json_summary(loads);
+	if(server)
+		cout << ", \"xruns\": " << xruns;
+	else
+		cout << ", \"xruns\": null";
+	if(server && blocking)
+		cout << ", \"output_underruns\": " << userXruns.outputUnderruns
+			<< ", \"input_overruns\": " << userXruns.inputOverruns;
+	cout << ", \"resident_bytes\": " << during
+		<< ", \"resident_bytes_per_client\": " << (during > before ? (during - before) / clients : 0)
+		<< "}" << endl;
+
+	for(unsigned int i = 0; i < clients; i++){
+		io[i]->close();
+		delete io[i];
+	}
+	exit(0);
+}
@@ -0,0 +1,41 @@
+#!/bin/sh
+#runs benchjackclients against jackd's dummy driver, at every buffer size,
+#and prints the results as one JSON array, for example
+#	./benchjackclients.sh > bench.json
+#override any of these from the environment
+JACKD=${JACKD:-jackd}
+RATE=${RATE:-48000}
+SIZES=${SIZES:-"16 32 64 128 256 512 1024"}
+CLIENTS=${CLIENTS:-"1 4 16"}
+PORTS=${PORTS:-"2 16"}
+KINDS=${KINDS:-"audioio blocking"}
+MODES=${MODES:-"server inprocess"}
+SECONDS_PER_RUN=${SECONDS_PER_RUN:-5}
+
+#our own server, so the clients don't join a real one
+JACK_DEFAULT_SERVER=jackcpp-bench
+export JACK_DEFAULT_SERVER
+
+first=1
+echo "["
+for size in $SIZES; do
+	"$JACKD" -n "$JACK_DEFAULT_SERVER" -d dummy -r "$RATE" -p "$size" > /dev/null 2>&1 &
+	server=$!
+	sleep 2
+	for kind in $KINDS; do
+		for mode in $MODES; do
+			for clients in $CLIENTS; do
+				for ports in $PORTS; do
+					result=`./benchjackclients -k $kind -m $mode -c $clients -p $ports -s $SECONDS_PER_RUN` || continue
+					[ $first = 1 ] || echo ","
+					first=0
+					printf "%s" "$result"
+				done
+			done
+		done
+	done
+	kill $server
+	wait $server 2> /dev/null
+done
+echo
+echo "]"
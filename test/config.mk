@@ -13,6 +13,10 @@ CFLAGS = -Wall -g -I. -I../include/ -I${PREFIX}/include -I/usr/include
 #LDFLAGS = ${LIBS} ../libjackcpp.a `pkg-config --libs jack`
 LDFLAGS = ${LIBS} ../libjackcpp.a -ljack -lpthread -lrt
 
+# uncomment if the library was built with the realtime safety checker
+#CFLAGS += -rdynamic
+#LDFLAGS += -ldl
+
 AR = ar cr
 CC = g++
 RANLIB = ranlib
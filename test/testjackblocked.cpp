@@ -0,0 +1,109 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "jackblockedaudioio.hpp"
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+
+//every block, write the number of the first frame of the block into the
+//output, so the output says how far behind it is
+
+template<unsigned int BlockSize>
+class Counter: public JackCpp::BlockedAudioIO<BlockSize, Counter<BlockSize> > {
+	public:
+		Counter() : JackCpp::BlockedAudioIO<BlockSize, Counter<BlockSize> >("jackcpp-blocked", 1, 1), mFrame(0) {}
+		~Counter(){
+			if(this->getState() == JackCpp::AudioIO::active)
+				this->stop();
+		}
+		int processBlock(jack_default_audio_sample_t * const * /* in */, jack_default_audio_sample_t * const * out){
+			for(unsigned int j = 0; j < BlockSize; j++)
+				out[0][j] = (jack_default_audio_sample_t)(mFrame + j + 1);
+			mFrame += BlockSize;
+			return 0;
+		}
+	private:
+		unsigned int mFrame;
+};
+
+//run cycles of nframes through the client by calling its process callback
+//directly, the client is never activated, and check that the output is
+//the reported latency behind, returns the number of errors
+template<unsigned int BlockSize>
+int check_latency(jack_nframes_t nframes){
+	Counter<BlockSize> * counter = new Counter<BlockSize>;
+	counter->jackBufferSizeCallback(nframes);
+	jack_nframes_t latency = counter->getProcessingLatency().max;
+	jack_port_t * port = counter->getOutputPort(0);
+
+	int errors = 0;
+	unsigned int frame = 0;
+	for(unsigned int cycle = 0; cycle < 4 * BlockSize / nframes + 8; cycle++){
+		JackCpp::AudioIO::jackProcessCallback(nframes, counter);
+		jack_default_audio_sample_t * out = (jack_default_audio_sample_t *)jack_port_get_buffer(port, nframes);
+		for(unsigned int j = 0; j < nframes; j++, frame++){
+			//frame f of the input comes out as f + 1, latency frames later
+			jack_default_audio_sample_t expected = (frame < latency) ? 0 : (jack_default_audio_sample_t)(frame - latency + 1);
+			if(out[j] != expected)
+				errors++;
+		}
+	}
+	cout << "blocks of " << BlockSize << " with a buffer size of " << nframes
+		<< ": " << latency << " frames of latency, " << (errors ? "wrong" : "right") << endl;
+
+	counter->close();
+	delete counter;
+	return errors;
+}
+
+//the time of a cycle, when the blocking costs a copy and when it doesn't
+template<unsigned int BlockSize>
+double time_cycles(jack_nframes_t nframes, unsigned int cycles){
+	Counter<BlockSize> * counter = new Counter<BlockSize>;
+	counter->jackBufferSizeCallback(nframes);
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned int i = 0; i < cycles; i++)
+		JackCpp::AudioIO::jackProcessCallback(nframes, counter);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	counter->close();
+	delete counter;
+	return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / cycles;
+}
+
+int main(){
+	int errors = 0;
+	//blocks smaller than, larger than and unrelated to the buffer size
+	errors += check_latency<64>(256);
+	errors += check_latency<64>(48);
+	errors += check_latency<256>(64);
+	errors += check_latency<256>(96);
+	errors += check_latency<1024>(256);
+	errors += check_latency<1024>(1000);
+
+	cout << "ns per 256 frame cycle, blocks of 64 in place " << time_cycles<64>(256, 100000)
+		<< ", blocks of 1024 through the ring " << time_cycles<1024>(256, 100000) << endl;
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	exit(errors ? 1 : 0);
+}
@@ -0,0 +1,152 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+
+//this doesn't need a jack server, it times a matrix mix over port buffers
+//scattered through memory the way a server lays them out, straight from
+//the ports and gathered into a contiguous AudioBus first, to show where
+//the copy pays for itself
+
+#include "jackbus.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+using std::cout;
+using std::endl;
+
+namespace {
+	double now_usecs(){
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return tv.tv_sec * 1000000.0 + tv.tv_usec;
+	}
+
+	//port buffers laid out like jack2 lays them out, each in a slot big
+	//enough for the largest buffer size, in a shuffled order
+	struct scattered_ports_t {
+		std::vector<jack_default_audio_sample_t> pool;
+		std::vector<jack_default_audio_sample_t *> bufs;
+		scattered_ports_t(unsigned int channels, jack_nframes_t frames){
+			const size_t spacing = 8192;
+			pool.assign(channels * spacing, 0.0f);
+			std::vector<unsigned int> slots(channels);
+			for(unsigned int i = 0; i < channels; i++)
+				slots[i] = i;
+			std::random_shuffle(slots.begin(), slots.end());
+			for(unsigned int i = 0; i < channels; i++){
+				bufs.push_back(&pool[slots[i] * spacing]);
+				for(unsigned int j = 0; j < frames; j++)
+					bufs[i][j] = sin(0.01 * (i + 1) * j);
+			}
+		}
+	};
+
+	struct result_t {
+		double direct;
+		double gathered;
+		double copy;
+		double diff;
+	};
+
+	//the best of a few runs of the mix straight from the ports, gathered
+	//into buses, and of just the gather and scatter, in ns per cycle
+	result_t bench(unsigned int channels, jack_nframes_t frames){
+		scattered_ports_t in(channels, frames);
+		scattered_ports_t out(channels, frames);
+		scattered_ports_t check(channels, frames);
+		std::vector<float> gains(channels * channels);
+		for(unsigned int i = 0; i < gains.size(); i++)
+			gains[i] = 1.0f / (1 + (i % 7));
+
+		JackCpp::AudioBus directIn(channels, frames, false);
+		JackCpp::AudioBus directOut(channels, frames, false);
+		JackCpp::AudioBus denseIn(channels, frames);
+		JackCpp::AudioBus denseOut(channels, frames);
+
+		//aim for about the same amount of work whatever the size
+		const unsigned int cycles = std::max(10u, (unsigned int)(4e7 / ((double)channels * channels * frames)));
+		result_t r;
+		r.direct = r.gathered = r.copy = 1e300;
+		for(unsigned int run = 0; run < 5; run++){
+			double start = now_usecs();
+			for(unsigned int c = 0; c < cycles; c++){
+				directIn.gather(&in.bufs[0], frames);
+				directOut.bind(&check.bufs[0], frames);
+				JackCpp::mixMatrix(directIn, directOut, &gains[0]);
+			}
+			r.direct = std::min(r.direct, (now_usecs() - start) * 1000.0 / cycles);
+
+			start = now_usecs();
+			for(unsigned int c = 0; c < cycles; c++){
+				denseIn.gather(&in.bufs[0], frames);
+				denseOut.bind(&out.bufs[0], frames);
+				JackCpp::mixMatrix(denseIn, denseOut, &gains[0]);
+				denseOut.scatter();
+			}
+			r.gathered = std::min(r.gathered, (now_usecs() - start) * 1000.0 / cycles);
+
+			start = now_usecs();
+			for(unsigned int c = 0; c < cycles; c++){
+				denseIn.gather(&in.bufs[0], frames);
+				denseOut.bind(&out.bufs[0], frames);
+				denseOut.scatter();
+			}
+			r.copy = std::min(r.copy, (now_usecs() - start) * 1000.0 / cycles);
+		}
+
+		//run the mix once more, so the outputs are compared
+		denseIn.gather(&in.bufs[0], frames);
+		denseOut.bind(&out.bufs[0], frames);
+		JackCpp::mixMatrix(denseIn, denseOut, &gains[0]);
+		denseOut.scatter();
+		r.diff = 0.0;
+		for(unsigned int i = 0; i < channels; i++){
+			for(unsigned int j = 0; j < frames; j++)
+				r.diff = std::max(r.diff, (double)fabs(out.bufs[i][j] - check.bufs[i][j]));
+		}
+		return r;
+	}
+}
+
+int main(){
+	int errors = 0;
+	const unsigned int channels[] = {2, 8, 32, 64, 128};
+	const jack_nframes_t frames[] = {64, 256, 1024};
+	cout << "the gathered time includes the copy, a speedup over 1 means it paid" << endl;
+	cout << "channels  frames   direct ns  gathered ns  copy ns  speedup" << endl;
+	for(unsigned int c = 0; c < sizeof(channels) / sizeof(channels[0]); c++){
+		for(unsigned int f = 0; f < sizeof(frames) / sizeof(frames[0]); f++){
+			result_t r = bench(channels[c], frames[f]);
+			cout << std::setw(8) << channels[c] << std::setw(8) << frames[f]
+				<< std::setw(12) << (long)r.direct << std::setw(13) << (long)r.gathered
+				<< std::setw(9) << (long)r.copy
+				<< std::setw(9) << std::fixed << std::setprecision(2) << r.direct / r.gathered << endl;
+			if(r.diff > 1e-4){
+				cout << "the gathered mix differs by " << r.diff << endl;
+				errors++;
+			}
+		}
+	}
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+//this doesn't need a jack server, it feeds the FrameClock that AudioIO
+//uses for framesToTime and timeToFrames with cycle times from a simulated
+//sound card whose clock is a little fast and whose wake ups jitter
+
+#include "jackclock.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <iostream>
+using std::cout;
+using std::endl;
+
+int main(){
+	int errors = 0;
+	const jack_nframes_t rate = 48000;
+	const jack_nframes_t period = 256;
+	//the card runs 100 ppm fast
+	const double realRate = rate * 1.0001;
+	const double jitterUsecs = 200.0;
+
+	JackCpp::FrameClock clock;
+	//start at an odd time, with frame times about to wrap around
+	const double startUsecs = 1234567890.0;
+	jack_nframes_t startFrame = 0xffffffff - 100 * period;
+	double worst = 0.0;
+	for(unsigned int cycle = 0; cycle < 20 * rate / period; cycle++){
+		double ideal = startUsecs + 1000000.0 * cycle * period / realRate;
+		double jitter = jitterUsecs * ((double)rand() / RAND_MAX - 0.5);
+		JackCpp::CycleTimes times;
+		times.frames = startFrame + cycle * period;
+		times.usecs = (jack_time_t)(ideal + jitter);
+		times.nextUsecs = (jack_time_t)(ideal + 1000000.0 * period / realRate);
+		times.periodUsecs = 1000000.0f * period / rate;
+		clock.update(times, period, rate);
+
+		//after the loop has settled, see how far off the true times it is
+		if(cycle > 10 * rate / period){
+			jack_nframes_t frame = times.frames + period / 2;
+			double truth = ideal + 1000000.0 * (period / 2) / realRate;
+			double err = fabs((double)clock.framesToTime(frame) - truth);
+			if(err > worst)
+				worst = err;
+		}
+	}
+	cout << "measured rate " << clock.sampleRate() << " Hz, the card runs at " << realRate << " Hz" << endl;
+	cout << "worst error after settling " << worst << " us, with "
+		<< jitterUsecs << " us of jitter on the cycle times" << endl;
+	if(fabs(clock.sampleRate() - realRate) > 1.0 || worst > jitterUsecs / 4)
+		errors++;
+
+	//frames to time and back, including a second in the future and the past
+	jack_nframes_t now = clock.cycleTimes().frames;
+	for(int offset = -(int)rate; offset <= (int)rate; offset += rate / 2){
+		jack_nframes_t frame = now + offset;
+		jack_nframes_t back = clock.timeToFrames(clock.framesToTime(frame));
+		if((int32_t)(back - frame) > 1 || (int32_t)(back - frame) < -1){
+			cout << "round trip of frame " << frame << " gave " << back << endl;
+			errors++;
+		}
+	}
+
+	//a gap in the frame times restarts the loop instead of disturbing it
+	JackCpp::CycleTimes times = clock.cycleTimes();
+	times.frames += 10 * period;
+	times.usecs += (jack_time_t)(1000000.0 * 10 * period / realRate);
+	clock.update(times, period, rate);
+	cout << "after a gap the rate is " << clock.sampleRate() << " Hz" << endl;
+	if(fabs(clock.sampleRate() - rate) > 1.0)
+		errors++;
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+
+//this doesn't need a jack server, it plays a sine through the GapConcealer
+//that BlockingAudioIO uses, with the stream running dry now and then, and
+//compares the biggest jump between samples, the click, in each mode
+
+#include "jackconcealer.hpp"
+#include <math.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+using std::cout;
+using std::endl;
+
+namespace {
+	const char * mode_names[] = {"silence", "fade", "repeat"};
+
+	double now_usecs(){
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return tv.tv_sec * 1000000.0 + tv.tv_usec;
+	}
+
+	//the biggest jump between samples over cycles of a sine, with a gap every tenth cycle
+	double worst_click(JackCpp::GapConcealer::mode_t mode){
+		const unsigned int period = 256;
+		JackCpp::GapConcealer concealer(1, mode);
+		std::vector<jack_default_audio_sample_t> buf(period);
+		jack_default_audio_sample_t * bufs[1] = {&buf[0]};
+		double phase = 0.0;
+		double worst = 0.0;
+		jack_default_audio_sample_t last = 0.0;
+		for(unsigned int cycle = 0; cycle < 100; cycle++){
+			//run dry 100 frames into every tenth cycle, and stay dry for the next one
+			unsigned int valid = period;
+			if(cycle % 10 == 5)
+				valid = 100;
+			else if(cycle % 10 == 6)
+				valid = 0;
+			for(unsigned int j = 0; j < valid; j++){
+				buf[j] = 0.5 * sin(phase);
+				phase += 2.0 * M_PI * 441.0 / 44100.0;
+			}
+			concealer.fillGap(bufs, valid, period);
+			for(unsigned int j = 0; j < period; j++){
+				worst = std::max(worst, fabs((double)buf[j] - last));
+				last = buf[j];
+			}
+		}
+		return worst;
+	}
+}
+
+int main(){
+	int errors = 0;
+	//a steady 441 Hz sine moves at most this much between samples
+	const double smooth = 0.5 * 2.0 * M_PI * 441.0 / 44100.0;
+	double clicks[3];
+	for(unsigned int m = 0; m < 3; m++){
+		clicks[m] = worst_click((JackCpp::GapConcealer::mode_t)m);
+		cout << mode_names[m] << ": worst jump " << clicks[m] << " (a smooth sine moves up to " << smooth << ")" << endl;
+	}
+	if(clicks[JackCpp::GapConcealer::fade] > clicks[JackCpp::GapConcealer::silence] / 4)
+		errors++;
+	if(clicks[JackCpp::GapConcealer::repeat] > clicks[JackCpp::GapConcealer::silence] / 4)
+		errors++;
+
+	//dropped input is faded either side of the gap
+	std::vector<jack_default_audio_sample_t> in(64, 1.0);
+	jack_default_audio_sample_t * inBufs[1] = {&in[0]};
+	JackCpp::GapConcealer inConcealer(1, JackCpp::GapConcealer::fade, 32);
+	jack_default_audio_sample_t * const * head = inConcealer.rampInput(inBufs, 0, 32, 64, true, false);
+	cout << "input fades in from " << head[0][0] << " to " << head[0][31] << endl;
+	if(head[0][0] > 0.1 || head[0][31] < 0.9)
+		errors++;
+	jack_default_audio_sample_t * const * tail = inConcealer.rampInput(inBufs, 32, 32, 64, false, true);
+	cout << "and out from " << tail[0][0] << " to " << tail[0][31] << endl;
+	if(tail[0][0] < 0.9 || tail[0][31] > 0.1)
+		errors++;
+
+	//without gaps, repeat mode only remembers the end of each cycle
+	const unsigned int chans = 8;
+	const unsigned int period = 256;
+	std::vector<jack_default_audio_sample_t> data(chans * period, 0.25);
+	std::vector<jack_default_audio_sample_t *> bufs(chans);
+	for(unsigned int c = 0; c < chans; c++)
+		bufs[c] = &data[c * period];
+	JackCpp::GapConcealer busy(chans, JackCpp::GapConcealer::repeat);
+	const unsigned int cycles = 100000;
+	double start = now_usecs();
+	for(unsigned int i = 0; i < cycles; i++)
+		busy.fillGap(&bufs[0], period, period);
+	cout << "repeat mode costs " << (now_usecs() - start) * 1000.0 / cycles
+		<< " ns per " << chans << " channel cycle without gaps" << endl;
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackaudioio.hpp"
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+//passes its inputs through to its outputs
+class TestConnections: public JackCpp::AudioIO {
+	public:
+		virtual int audioCallback(jack_nframes_t nframes,
+				audioBufVector inBufs,
+				audioBufVector outBufs){
+			for(unsigned int i = 0; i < inBufs.size(); i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					outBufs[i][j] = inBufs[i][j];
+			}
+			return 0;
+		}
+		TestConnections() :
+			JackCpp::AudioIO("jackcpp-connections", 2, 2){
+		}
+};
+
+void print_results(JackCpp::ConnectionJob * job){
+	const char * names[] = {"connected", "disconnected", "already connected", "failed"};
+	const std::vector<JackCpp::ConnectionJob::result_t>& results = job->results();
+	for(unsigned int i = 0; i < results.size(); i++)
+		cout << "\t" << results[i].source << " -> " << results[i].destination << ": " << names[results[i].status] << endl;
+	if(!job->error().empty())
+		cout << "\terror: " << job->error() << endl;
+}
+
+int main(){
+	TestConnections * t = new TestConnections;
+	t->start();
+
+	//connect every capture port to our inputs and our outputs to every playback port
+	JackCpp::ConnectionSet set;
+	set.add("system:capture_*", "jackcpp-connections:in*", JackCpp::ConnectionSet::glob);
+	set.add("jackcpp-connections:out.*", "system:playback_[0-9]+", JackCpp::ConnectionSet::regex);
+	JackCpp::ConnectionJob * job = t->applyConnections(set);
+	job->wait();
+	cout << "applied the patterns with " << job->failures() << " failures" << endl;
+	print_results(job);
+	delete job;
+
+	//save what we have
+	std::stringstream saved;
+	t->getConnections().write(saved);
+	cout << "saved connections:" << endl << saved.str();
+
+	t->disconnectInPort(0);
+	t->disconnectOutPort(0);
+	cout << "disconnected port 0, restoring in 5 seconds" << endl;
+	sleep(5);
+
+	//restoring only makes the connections that are missing
+	JackCpp::ConnectionSet restore;
+	restore.read(saved);
+	job = t->applyConnections(restore, true);
+	job->wait();
+	cout << "restored the connections:" << endl;
+	print_results(job);
+	delete job;
+
+	sleep(5);
+	t->close();
+	delete t;
+	exit(0);
+}
+
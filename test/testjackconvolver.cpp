@@ -0,0 +1,161 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+
+//this doesn't need a jack server, it checks the Convolver against a direct
+//convolution, then times channels x impulse lengths at 64 frame periods
+
+#include "jackconvolver.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+using std::cout;
+using std::endl;
+
+namespace {
+	double now_usecs(){
+		struct timespec t;
+		clock_gettime(CLOCK_MONOTONIC, &t);
+		return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+	}
+
+	//the cpu time of every thread of the process
+	double cpu_usecs(){
+		struct timespec t;
+		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+		return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+	}
+
+	//sleep until a time from now_usecs
+	void sleep_until(double usecs){
+		double wait = usecs - now_usecs();
+		if(wait <= 0.0)
+			return;
+		struct timespec t;
+		t.tv_sec = (time_t)(wait / 1e6);
+		t.tv_nsec = (long)((wait - t.tv_sec * 1e6) * 1e3);
+		nanosleep(&t, NULL);
+	}
+
+	std::vector<float> noise(unsigned int length, float level){
+		std::vector<float> v(length);
+		for(unsigned int i = 0; i < length; i++)
+			v[i] = level * ((float)rand() / RAND_MAX - 0.5f);
+		return v;
+	}
+
+	//run signals through a convolver in periods of nframes, waiting for the tails
+	std::vector<std::vector<float> > run(JackCpp::Convolver& conv,
+			const std::vector<std::vector<float> >& inputs, unsigned int nframes){
+		std::vector<std::vector<float> > outputs(inputs.size(), std::vector<float>(inputs[0].size()));
+		std::vector<const float *> in(inputs.size());
+		std::vector<float *> out(inputs.size());
+		for(unsigned int pos = 0; pos + nframes <= inputs[0].size(); pos += nframes){
+			for(unsigned int c = 0; c < inputs.size(); c++){
+				in[c] = &inputs[c][pos];
+				out[c] = &outputs[c][pos];
+			}
+			conv.process(&in[0], &out[0], nframes, true);
+		}
+		return outputs;
+	}
+}
+
+int main(){
+	int errors = 0;
+
+	//two channels share one impulse, a third has a shorter one
+	std::vector<float> longIr = noise(5000, 0.1f);
+	std::vector<float> shortIr = noise(300, 0.5f);
+	JackCpp::Convolver conv(64, 256, 2);
+	unsigned int longIndex = conv.addImpulse(&longIr[0], longIr.size());
+	unsigned int shortIndex = conv.addImpulse(&shortIr[0], shortIr.size());
+	conv.addChannel(longIndex);
+	conv.addChannel(longIndex);
+	conv.addChannel(shortIndex);
+	std::vector<std::vector<float> > inputs;
+	for(unsigned int c = 0; c < 3; c++)
+		inputs.push_back(noise(16384, 1.0f));
+	std::vector<std::vector<float> > outputs = run(conv, inputs, 128);
+	double worst = 0.0;
+	for(unsigned int c = 0; c < 3; c++){
+		const std::vector<float>& ir = (c < 2) ? longIr : shortIr;
+		for(unsigned int n = 0; n < inputs[c].size(); n++){
+			double sum = 0.0;
+			for(unsigned int k = 0; k < ir.size() && k <= n; k++)
+				sum += ir[k] * inputs[c][n - k];
+			worst = std::max(worst, fabs(sum - outputs[c][n]));
+		}
+	}
+	cout << "worst difference from a direct convolution " << worst << ", " << conv.lateBlocks() << " late blocks" << endl;
+	if(worst > 1e-3 || conv.lateBlocks() > 0)
+		errors++;
+
+	//a second of periods, each started on time as jack would and run the way
+	//the callback runs them, without waiting for the threads, so the callback
+	//times are the realtime path and late blocks are what the threads missed,
+	//the load is the cpu time of every thread over the second
+	const unsigned int rate = 48000;
+	const unsigned int period = 64;
+	const unsigned int channels[] = {1, 16, 64, 256};
+	const double seconds[] = {0.25, 1.0, 2.0};
+	cout << "64 frame periods at " << rate << " Hz, a period lasts " << 1e6 * period / rate << " us" << endl;
+	cout << "channels   ir s  median callback us  worst us  total load  late blocks" << endl;
+	for(unsigned int i = 0; i < sizeof(channels) / sizeof(channels[0]); i++){
+		for(unsigned int j = 0; j < sizeof(seconds) / sizeof(seconds[0]); j++){
+			std::vector<float> ir = noise((unsigned int)(seconds[j] * rate), 0.01f);
+			JackCpp::Convolver bench(period, 0, 2);
+			unsigned int index = bench.addImpulse(&ir[0], ir.size());
+			for(unsigned int c = 0; c < channels[i]; c++)
+				bench.addChannel(index);
+			std::vector<float> buf(channels[i] * period, 0.1f);
+			std::vector<float *> bufs(channels[i]);
+			for(unsigned int c = 0; c < channels[i]; c++)
+				bufs[c] = &buf[c * period];
+
+			const unsigned int cycles = rate / period;
+			const double periodUsecs = 1e6 * period / rate;
+			std::vector<double> times(cycles);
+			double start = now_usecs();
+			double cpuStart = cpu_usecs();
+			for(unsigned int n = 0; n < cycles; n++){
+				sleep_until(start + n * periodUsecs);
+				double t = now_usecs();
+				bench.process(&bufs[0], &bufs[0], period, false);
+				times[n] = now_usecs() - t;
+			}
+			double load = (cpu_usecs() - cpuStart) / (now_usecs() - start);
+			double worstCycle = *std::max_element(times.begin(), times.end());
+			std::nth_element(times.begin(), times.begin() + cycles / 2, times.end());
+			cout << std::fixed
+				<< std::setw(8) << channels[i]
+				<< std::setw(7) << std::setprecision(2) << seconds[j]
+				<< std::setw(20) << std::setprecision(1) << times[cycles / 2]
+				<< std::setw(10) << std::setprecision(1) << worstCycle
+				<< std::setw(11) << std::setprecision(0) << 100.0 * load << "%"
+				<< std::setw(13) << bench.lateBlocks() << endl;
+		}
+	}
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackcoroutine.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+using std::cout;
+using std::endl;
+
+//move audio through many clients, first with a thread per client doing
+//blocking reads and writes, then with every client driven by a coroutine
+//and all of the coroutines resumed on one thread, and compare the cpu time
+//that each takes
+//usage: testjackcoroutine [clients] [seconds]
+
+namespace {
+	const unsigned int chans = 2;
+	const unsigned int block = 256;
+	volatile bool running;
+	volatile unsigned long framesMoved;
+	volatile unsigned int finished;
+
+	double cpu_seconds(){
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+			(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+	}
+
+	double wall_seconds(){
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return tv.tv_sec + tv.tv_usec / 1e6;
+	}
+
+	void * blocking_stream(void * arg){
+		JackCpp::BlockingAudioIO * io = (JackCpp::BlockingAudioIO *)arg;
+		std::vector<jack_default_audio_sample_t> buf(block * chans);
+		while(running){
+			unsigned int frames = io->readBlock(&buf[0], block, chans);
+			io->writeBlock(&buf[0], frames, chans);
+			__sync_add_and_fetch(&framesMoved, frames);
+		}
+		return NULL;
+	}
+
+	JackCpp::DetachedTask async_stream(JackCpp::AsyncStream& stream){
+		std::vector<jack_default_audio_sample_t> buf(block * chans);
+		while(running){
+			unsigned int frames = co_await stream.readFrames(buf.data(), block);
+			co_await stream.writeFrames(buf.data(), frames);
+			__sync_add_and_fetch(&framesMoved, frames);
+		}
+		__sync_add_and_fetch(&finished, 1);
+	}
+
+	void * run_executor(void * arg){
+		((JackCpp::QueueExecutor *)arg)->run();
+		return NULL;
+	}
+
+	void report(const char * name, unsigned int threads, double wall, double cpu, unsigned int rate){
+		double audio = framesMoved / (double)rate;
+		cout << name << ": " << threads << " threads, "
+			<< audio / wall << " seconds of audio per second, "
+			<< 1000.0 * cpu / audio << " ms of cpu per second of audio" << endl;
+	}
+}
+
+int main(int argc, char * argv[]){
+	unsigned int clients = 16;
+	unsigned int seconds = 5;
+	if(argc > 1)
+		std::istringstream(argv[1]) >> clients;
+	if(argc > 2)
+		std::istringstream(argv[2]) >> seconds;
+
+	std::vector<JackCpp::BlockingAudioIO *> ios;
+	for(unsigned int i = 0; i < clients; i++){
+		std::ostringstream name;
+		name << "jackcpp-coroutine-" << i;
+		ios.push_back(new JackCpp::BlockingAudioIO(name.str(), chans, chans));
+		ios.back()->start();
+	}
+	unsigned int rate = ios[0]->getSampleRate();
+
+	//a thread per stream
+	running = true;
+	framesMoved = 0;
+	std::vector<pthread_t> threads(clients);
+	double wall = wall_seconds();
+	double cpu = cpu_seconds();
+	for(unsigned int i = 0; i < clients; i++)
+		pthread_create(&threads[i], NULL, blocking_stream, ios[i]);
+	sleep(seconds);
+	running = false;
+	for(unsigned int i = 0; i < clients; i++)
+		pthread_join(threads[i], NULL);
+	report("blocking", clients, wall_seconds() - wall, cpu_seconds() - cpu, rate);
+
+	//every stream on one executor thread, plus the reactor's thread
+	running = true;
+	framesMoved = 0;
+	finished = 0;
+	JackCpp::QueueExecutor executor;
+	JackCpp::StreamReactor * reactor = new JackCpp::StreamReactor(&executor);
+	std::vector<JackCpp::AsyncStream *> streams;
+	pthread_t executorThread;
+	pthread_create(&executorThread, NULL, run_executor, &executor);
+	wall = wall_seconds();
+	cpu = cpu_seconds();
+	for(unsigned int i = 0; i < clients; i++){
+		streams.push_back(new JackCpp::AsyncStream(*reactor, *ios[i]));
+		async_stream(*streams.back());
+	}
+	sleep(seconds);
+	running = false;
+	while(finished < clients)
+		usleep(1000);
+	report("coroutine", 2, wall_seconds() - wall, cpu_seconds() - cpu, rate);
+	executor.stop();
+	pthread_join(executorThread, NULL);
+	delete reactor;
+
+	for(unsigned int i = 0; i < clients; i++){
+		delete streams[i];
+		ios[i]->stop();
+		delete ios[i];
+	}
+	exit(0);
+}
@@ -0,0 +1,78 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackthreadconfig.hpp"
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+
+//a bank of decaying resonant filters, after the impulse dies away their
+//state sinks into denormal numbers, which is slow without flushing
+const unsigned int filters = 16;
+const unsigned int frames = 256;
+const unsigned int blocks = 4000;
+
+double run(){
+	float state[filters][2];
+	float out[frames];
+	for(unsigned int i = 0; i < filters; i++)
+		state[i][0] = state[i][1] = 0.0f;
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned int b = 0; b < blocks; b++){
+		for(unsigned int j = 0; j < frames; j++){
+			float in = (b == 0 && j == 0) ? 1.0f : 0.0f;
+			float sum = 0.0f;
+			for(unsigned int i = 0; i < filters; i++){
+				float y = in + 1.8f * state[i][0] - 0.81f * state[i][1];
+				state[i][1] = state[i][0];
+				state[i][0] = y;
+				sum += y;
+			}
+			out[j] = sum;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	//keep the compiler from throwing the work away
+	volatile float sink = out[frames - 1];
+	(void)sink;
+	double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+	return secs * 1e9 / ((double)blocks * frames);
+}
+
+int main(){
+	JackCpp::setDenormalFlushing(false);
+	double slow = run();
+	cout << "denormals not flushed: " << slow << " ns per frame" << endl;
+
+	//this is what ThreadConfig::flushDenormals does in the process thread
+	JackCpp::setDenormalFlushing(true);
+	if(!JackCpp::denormalsFlushed()){
+		cout << "denormal flushing isn't supported here" << endl;
+		exit(0);
+	}
+	double fast = run();
+	cout << "denormals flushed: " << fast << " ns per frame" << endl;
+	cout << "speed up " << slow / fast << "x" << endl;
+	exit(0);
+}
+
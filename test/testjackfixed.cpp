@@ -0,0 +1,110 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackfixedaudioio.hpp"
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+
+//the same stereo gain, once with AudioIO and once with FixedAudioIO
+
+class DynamicGain: public JackCpp::AudioIO {
+	public:
+		virtual int audioCallback(jack_nframes_t nframes,
+				audioBufVector inBufs,
+				audioBufVector outBufs){
+			for(unsigned int i = 0; i < outBufs.size(); i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					outBufs[i][j] = 0.5f * inBufs[i][j];
+			}
+			return 0;
+		}
+		DynamicGain() : JackCpp::AudioIO("jackcpp-dynamic", 2, 2){}
+};
+
+//the same, but without copying the buffer vectors
+class DynamicRefGain: public JackCpp::AudioIO {
+	public:
+		virtual int processAudio(jack_nframes_t nframes,
+				const audioBufVector& inBufs,
+				const audioBufVector& outBufs){
+			for(unsigned int i = 0; i < outBufs.size(); i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					outBufs[i][j] = 0.5f * inBufs[i][j];
+			}
+			return 0;
+		}
+		DynamicRefGain() : JackCpp::AudioIO("jackcpp-dynamic-ref", 2, 2){}
+};
+
+class FixedGain: public JackCpp::FixedAudioIO<2, 2, FixedGain> {
+	public:
+		int process(jack_nframes_t nframes, const InBuffers& in, const OutBuffers& out){
+			for(unsigned int i = 0; i < numOutputs; i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					out[i][j] = 0.5f * in[i][j];
+			}
+			return 0;
+		}
+		FixedGain() : JackCpp::FixedAudioIO<2, 2, FixedGain>("jackcpp-fixed"){}
+};
+
+//call a process callback directly, the client is never activated, and
+//report the average time per cycle in nanoseconds
+double time_cycles(JackProcessCallback callback, void * client, jack_nframes_t nframes, unsigned int cycles){
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned int i = 0; i < cycles; i++)
+		callback(nframes, client);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / cycles;
+}
+
+int main(){
+	const unsigned int cycles = 200000;
+	DynamicGain * dynamic = new DynamicGain;
+	DynamicRefGain * dynamicRef = new DynamicRefGain;
+	FixedGain * fixed = new FixedGain;
+
+	cout << "ns per cycle, " << cycles << " cycles" << endl;
+	cout << "frames\tAudioIO\tAudioIO by reference\tFixedAudioIO" << endl;
+	jack_nframes_t sizes[] = {16, 64, 256, 1024};
+	for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++){
+		//warm up
+		time_cycles(JackCpp::AudioIO::jackProcessCallback, dynamic, sizes[i], 1000);
+		time_cycles(JackCpp::AudioIO::jackProcessCallback, dynamicRef, sizes[i], 1000);
+		time_cycles(FixedGain::fixedProcessCallback, fixed, sizes[i], 1000);
+
+		cout << sizes[i] << "\t" <<
+			time_cycles(JackCpp::AudioIO::jackProcessCallback, dynamic, sizes[i], cycles) << "\t" <<
+			time_cycles(JackCpp::AudioIO::jackProcessCallback, dynamicRef, sizes[i], cycles) << "\t" <<
+			time_cycles(FixedGain::fixedProcessCallback, fixed, sizes[i], cycles) << endl;
+	}
+
+	dynamic->close();
+	dynamicRef->close();
+	fixed->close();
+	delete dynamic;
+	delete dynamicRef;
+	delete fixed;
+	exit(0);
+}
+
@@ -0,0 +1,98 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+//this doesn't need a jack server, it checks the sample format conversions
+//that BlockingAudioIO's typed readBlock and writeBlock use, shows what
+//dither does to a signal smaller than one step, and times the conversions
+
+#include "jacksampleformat.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include <iostream>
+using std::cout;
+using std::endl;
+
+//convert a ramp to a format and back, return the largest error in steps of the format
+template<typename Sample>
+double round_trip(double steps){
+	const unsigned int cnt = 100000;
+	std::vector<jack_default_audio_sample_t> in(cnt), out(cnt);
+	std::vector<Sample> converted(cnt);
+	for(unsigned int i = 0; i < cnt; i++)
+		in[i] = -1.0f + 2.0f * i / cnt;
+	JackCpp::fromFloat(&in[0], &converted[0], 1, cnt);
+	JackCpp::toFloat(&converted[0], 1, &out[0], cnt);
+	double maxErr = 0.0;
+	for(unsigned int i = 0; i < cnt; i++)
+		maxErr = std::max(maxErr, fabs((double)out[i] - in[i]) * steps);
+	return maxErr;
+}
+
+//the average int16 value of a constant a quarter of a step high
+double quarter_step_mean(JackCpp::Dither * dither){
+	const unsigned int cnt = 1000000;
+	std::vector<jack_default_audio_sample_t> in(cnt, 0.25f / 32768.0f);
+	std::vector<int16_t> out(cnt);
+	JackCpp::fromFloat(&in[0], &out[0], 1, cnt, dither);
+	double sum = 0.0;
+	for(unsigned int i = 0; i < cnt; i++)
+		sum += out[i];
+	return sum / cnt;
+}
+
+double now(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(){
+	cout << "largest round trip error in steps" << endl;
+	cout << "int16\t" << round_trip<int16_t>(32768.0) << endl;
+	cout << "int24\t" << round_trip<JackCpp::Int24>(8388608.0) << endl;
+	cout << "int24in32\t" << round_trip<JackCpp::Int24In32>(8388608.0) << endl;
+	cout << "int32\t" << round_trip<int32_t>(8388608.0) << " (in 24 bit steps, a float's precision)" << endl;
+	cout << "float64\t" << round_trip<double>(8388608.0) << " (in 24 bit steps)" << endl;
+
+	JackCpp::Dither dither;
+	cout << endl << "mean int16 value of a constant 0.25 steps high" << endl;
+	cout << "no dither\t" << quarter_step_mean(NULL) << endl;
+	cout << "TPDF dither\t" << quarter_step_mean(&dither) << endl;
+
+	//one channel of stereo, as readBlock and writeBlock convert
+	const unsigned int cnt = 1 << 20;
+	const unsigned int reps = 100;
+	std::vector<jack_default_audio_sample_t> floats(cnt, 0.5f);
+	std::vector<int16_t> ints(cnt * 2, 1000);
+	cout << endl << "ns per sample, " << cnt << " samples" << endl;
+	double start = now();
+	for(unsigned int r = 0; r < reps; r++)
+		JackCpp::toFloat(&ints[0], 2, &floats[0], cnt);
+	cout << "int16 to float\t" << (now() - start) * 1e9 / (reps * cnt) << endl;
+	start = now();
+	for(unsigned int r = 0; r < reps; r++)
+		JackCpp::fromFloat(&floats[0], &ints[0], 2, cnt);
+	cout << "float to int16\t" << (now() - start) * 1e9 / (reps * cnt) << endl;
+	start = now();
+	for(unsigned int r = 0; r < reps; r++)
+		JackCpp::fromFloat(&floats[0], &ints[0], 2, cnt, &dither);
+	cout << "float to int16 dithered\t" << (now() - start) * 1e9 / (reps * cnt) << endl;
+	exit(0);
+}
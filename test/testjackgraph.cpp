@@ -0,0 +1,94 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackaudioio.hpp"
+#include <iostream>
+#include <stdlib.h>
+
+using std::cout;
+using std::endl;
+
+//does nothing, we only want to watch the graph
+class TestGraph: public JackCpp::AudioIO {
+	public:
+		virtual int audioCallback(jack_nframes_t nframes,
+				audioBufVector inBufs,
+				audioBufVector outBufs){
+			for(unsigned int i = 0; i < outBufs.size(); i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					outBufs[i][j] = 0.0;
+			}
+			return 0;
+		}
+		TestGraph() :
+			JackCpp::AudioIO("jackcpp-graph", 1, 1){
+		}
+};
+
+std::string port_name(JackCpp::AudioIO * t, jack_port_id_t id){
+	jack_port_t * port = jack_port_by_id(t->client(), id);
+	if(port == NULL)
+		return "(gone)";
+	return jack_port_name(port);
+}
+
+int main(){
+	TestGraph * t = new TestGraph;
+	t->start();
+
+	cout << "start clients, add ports and make connections to see events" << endl;
+	JackCpp::GraphEvent e;
+	//stop after 30 seconds without an event
+	while(t->waitGraphEvent(e, 30000)){
+		switch(e.type){
+			case JackCpp::GraphEvent::clientRegistered:
+				cout << "client registered: " << e.client << endl;
+				break;
+			case JackCpp::GraphEvent::clientUnregistered:
+				cout << "client unregistered: " << e.client << endl;
+				break;
+			case JackCpp::GraphEvent::portRegistered:
+				cout << "port registered: " << port_name(t, e.port) << endl;
+				break;
+			case JackCpp::GraphEvent::portUnregistered:
+				cout << "port unregistered: " << e.port << endl;
+				break;
+			case JackCpp::GraphEvent::portRenamed:
+				cout << "port renamed: " << port_name(t, e.port) << endl;
+				break;
+			case JackCpp::GraphEvent::portsConnected:
+				cout << "connected: " << port_name(t, e.port) << " " << port_name(t, e.otherPort) << endl;
+				break;
+			case JackCpp::GraphEvent::portsDisconnected:
+				cout << "disconnected: " << port_name(t, e.port) << " " << port_name(t, e.otherPort) << endl;
+				break;
+			case JackCpp::GraphEvent::graphReordered:
+				cout << "graph reordered" << endl;
+				break;
+			case JackCpp::GraphEvent::xrun:
+				cout << "xrun at " << e.usecs << endl;
+				break;
+		}
+	}
+	cout << t->droppedGraphEvents() << " events were dropped" << endl;
+
+	t->close();
+	delete t;
+	exit(0);
+}
+
@@ -0,0 +1,63 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackaudioio.hpp"
+#include <iostream>
+#include <stdlib.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+//connect to the physical ports and report the latency jack computes for them
+
+class Passthrough: public JackCpp::AudioIO {
+	public:
+		virtual int processAudio(jack_nframes_t nframes,
+				const audioBufVector& inBufs,
+				const audioBufVector& outBufs){
+			for(unsigned int i = 0; i < outBufs.size(); i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					outBufs[i][j] = inBufs[i][j];
+			}
+			return 0;
+		}
+		Passthrough() : JackCpp::AudioIO("jackcpp-latency", 1, 1){}
+};
+
+int main(){
+	Passthrough * t = new Passthrough;
+	t->start();
+
+	if (t->numPhysicalSourcePorts() > 0)
+		t->connectFromPhysical(0, 0);
+	if (t->numPhysicalDestinationPorts() > 0)
+		t->connectToPhysical(0, 0);
+	//give jack a moment to recompute the latencies
+	sleep(1);
+
+	//latency of the audio arriving at our input, and leaving our output
+	jack_latency_range_t range = t->getInPortLatencyRange(0, JackCaptureLatency);
+	cout << "input 0 capture latency " << range.min << " - " << range.max << " frames" << endl;
+	range = t->getOutPortLatencyRange(0, JackPlaybackLatency);
+	cout << "output 0 playback latency " << range.min << " - " << range.max << " frames" << endl;
+
+	t->close();
+	delete t;
+	exit(0);
+}
@@ -0,0 +1,72 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackblockingaudioio.hpp"
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+
+//move blocks through a BlockingAudioIO with a buffer per channel and with
+//the channels in lockstep, the client is never activated, its process
+//callback is called directly, report the average time per cycle in
+//nanoseconds for writing a block, running the callback and reading a block
+double time_cycles(JackCpp::BlockingAudioIO * b, jack_nframes_t nframes, unsigned int cycles){
+	unsigned int chans = b->outPorts();
+	std::vector<jack_default_audio_sample_t> block(nframes * chans, 0.5f);
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned int i = 0; i < cycles; i++){
+		b->writeBlock(&block[0], nframes, chans, false);
+		JackCpp::AudioIO::jackProcessCallback(nframes, b);
+		b->readBlock(&block[0], nframes, chans, false);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / cycles;
+}
+
+int main(){
+	const unsigned int cycles = 50000;
+	const jack_nframes_t nframes = 256;
+
+	cout << "ns per cycle of " << nframes << " frames, " << cycles << " cycles" << endl;
+	cout << "channels\tper channel\tlockstep" << endl;
+	unsigned int channels[] = {1, 2, 8, 32};
+	for(unsigned int i = 0; i < sizeof(channels) / sizeof(channels[0]); i++){
+		JackCpp::BlockingAudioIO * planar = new JackCpp::BlockingAudioIO("jackcpp-planar", channels[i], channels[i]);
+		JackCpp::BlockingAudioIO * lockstep = new JackCpp::BlockingAudioIO("jackcpp-lockstep", channels[i], channels[i]);
+		lockstep->setLockstep(true);
+
+		//warm up
+		time_cycles(planar, nframes, 1000);
+		time_cycles(lockstep, nframes, 1000);
+
+		cout << channels[i] << "\t" <<
+			time_cycles(planar, nframes, cycles) << "\t" <<
+			time_cycles(lockstep, nframes, cycles) << endl;
+
+		planar->close();
+		lockstep->close();
+		delete planar;
+		delete lockstep;
+	}
+	exit(0);
+}
@@ -0,0 +1,116 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+//this doesn't need a jack server, it checks the meters that AudioIO runs
+//in its callback when setMetering is on, and times them for a few hundred
+//ports
+
+#include "jackmeter.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include <iostream>
+using std::cout;
+using std::endl;
+
+const jack_nframes_t rate = 48000;
+const jack_nframes_t period = 256;
+
+double db(float linear){
+	return 20.0 * log10(std::max(linear, 1e-10f));
+}
+
+double now(){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+//run three seconds of a sine through a meter, period frames at a time, so
+//the rms has settled
+JackCpp::MeterReading meter_sine(double freq, double phase, float amp, const JackCpp::MeterConfig& config){
+	JackCpp::Meter meter(config, rate);
+	std::vector<jack_default_audio_sample_t> buf(period);
+	for(unsigned int cycle = 0; cycle < 3 * rate / period; cycle++){
+		for(unsigned int i = 0; i < period; i++)
+			buf[i] = amp * sin(2.0 * M_PI * freq * (cycle * period + i) / rate + phase);
+		meter.process(&buf[0], period);
+	}
+	return meter.read();
+}
+
+int main(){
+	int errors = 0;
+	JackCpp::MeterConfig config;
+
+	//a sine at a quarter of the sample rate, sampled 45 degrees off its peaks,
+	//never has a sample above 0.707 of its true peak
+	JackCpp::MeterReading r = meter_sine(rate / 4.0, M_PI / 4.0, 1.0f, config);
+	cout << "fs/4 sine: peak " << db(r.peak) << " dB, rms " << db(r.rms)
+		<< " dB, true peak " << db(r.truePeak) << " dB" << endl;
+	if(fabs(db(r.peak) + 3.01) > 0.1 || fabs(db(r.rms) + 3.01) > 0.1 || fabs(db(r.truePeak)) > 0.5)
+		errors++;
+
+	r = meter_sine(997.0, 0.0, 0.5f, config);
+	cout << "997 Hz sine at -6 dB: peak " << db(r.peak) << " dB, rms " << db(r.rms)
+		<< " dB, true peak " << db(r.truePeak) << " dB" << endl;
+	if(fabs(db(r.peak) + 6.02) > 0.1 || fabs(db(r.rms) + 9.03) > 0.1 || fabs(db(r.truePeak) + 6.02) > 0.1)
+		errors++;
+
+	//a full scale click, then silence, falls at the decay rate
+	JackCpp::Meter meter(config, rate);
+	std::vector<jack_default_audio_sample_t> buf(period, 0.0f);
+	buf[0] = 1.0f;
+	meter.process(&buf[0], period);
+	buf[0] = 0.0f;
+	for(unsigned int cycle = 1; cycle < rate / period; cycle++)
+		meter.process(&buf[0], period);
+	r = meter.read();
+	cout << "a second after a click: peak " << db(r.peak) << " dB, hold " << db(r.peakHold) << " dB" << endl;
+	if(fabs(db(r.peak) + config.peakDecay) > 0.2 || r.peakHold != 1.0f)
+		errors++;
+	meter.resetHolds();
+	meter.process(&buf[0], period);
+	if(meter.read().peakHold != 0.0f)
+		errors++;
+
+	//time a few hundred ports' worth of metering
+	const unsigned int ports = 256;
+	const unsigned int cycles = 2000;
+	std::vector<jack_default_audio_sample_t> noise(period * ports);
+	for(unsigned int i = 0; i < noise.size(); i++)
+		noise[i] = (float)rand() / RAND_MAX - 0.5f;
+	std::vector<jack_default_audio_sample_t *> bufs(ports);
+	for(unsigned int i = 0; i < ports; i++)
+		bufs[i] = &noise[i * period];
+	for(unsigned int truePeak = 0; truePeak < 2; truePeak++){
+		config.truePeak = truePeak;
+		JackCpp::MeterBank bank(ports, 0, config, rate);
+		double start = now();
+		for(unsigned int c = 0; c < cycles; c++)
+			bank.process(period, &bufs[0], ports, NULL, 0);
+		double perCycle = (now() - start) / cycles;
+		cout << ports << " ports " << (truePeak ? "with" : "without") << " true peak: "
+			<< perCycle * 1e6 << " us per " << period << " frame cycle, "
+			<< 100.0 * perCycle * rate / period << "% of the cycle" << endl;
+	}
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	return errors ? 1 : 0;
+}
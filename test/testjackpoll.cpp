@@ -0,0 +1,81 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackblockingaudioio.hpp"
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include <poll.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+//pass the inputs through to the outputs from a poll loop that also watches
+//stdin, press return to quit
+int main(){
+	const unsigned int chans = 2;
+	const unsigned int block = 256;
+	JackCpp::BlockingAudioIO b("jackcpp-poll", chans, chans);
+	b.setInputWatermark(block);
+	b.setOutputWatermark(block);
+
+	struct pollfd fds[3];
+	fds[0].fd = b.inputReadyFd();
+	fds[1].fd = b.outputReadyFd();
+	fds[2].fd = STDIN_FILENO;
+	for(unsigned int i = 0; i < 3; i++)
+		fds[i].events = POLLIN;
+
+	b.start();
+	for(unsigned int i = 0; i < chans; i++){
+		b.connectToPhysical(i,i);
+		b.connectFromPhysical(i,i);
+	}
+
+	std::vector<jack_default_audio_sample_t> buf(block * chans);
+	unsigned int pending = 0;
+	unsigned int wakeups = 0;
+	while(true){
+		//only wait for output space when we have something to write
+		fds[1].events = pending ? POLLIN : 0;
+		if(poll(fds, 3, -1) < 0)
+			break;
+		wakeups++;
+		if(fds[2].revents & POLLIN)
+			break;
+		if(fds[0].revents & POLLIN){
+			b.clearInputReady();
+			if(pending == 0)
+				pending = b.readBlock(&buf[0], block, chans, false);
+		}
+		if(fds[1].revents & POLLIN){
+			b.clearOutputReady();
+			//write the whole block or nothing
+			if(pending > 0 && b.outputFramesWritable() >= pending){
+				b.writeBlock(&buf[0], pending, chans, false);
+				pending = 0;
+			}
+		}
+	}
+	cout << wakeups << " wake ups" << endl;
+
+	b.stop();
+	exit(0);
+}
+
@@ -0,0 +1,86 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackaudioio.hpp"
+#include "jackfilesink.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+//a stereo sine wave, rendered to a file faster than realtime
+class SineAudioIO: public JackCpp::AudioIO {
+	public:
+		SineAudioIO() : JackCpp::AudioIO("jackcpp-render", 0, 2), mPhase(0.0) {}
+		virtual int processAudio(jack_nframes_t nframes,
+				const audioBufVector& /* inBufs */,
+				const audioBufVector& outBufs){
+			double step = 2.0 * M_PI * 440.0 / getSampleRate();
+			for(unsigned int i = 0; i < nframes; i++){
+				outBufs[0][i] = outBufs[1][i] = 0.5f * sin(mPhase);
+				mPhase += step;
+			}
+			mPhase = fmod(mPhase, 2.0 * M_PI);
+			return 0;
+		}
+	private:
+		double mPhase;
+};
+
+//render the given number of seconds, 10 by default, to the given file, or
+//to a temporary file that is removed afterwards
+int main(int argc, char * argv[]){
+	double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+	std::string path;
+	if(argc > 2)
+		path = argv[2];
+	else {
+		const char * dir = getenv("TMPDIR");
+		std::ostringstream name;
+		name << ((dir != NULL) ? dir : "/tmp") << "/jackcpp-render-" << getpid() << ".wav";
+		path = name.str();
+	}
+	SineAudioIO t;
+	uint64_t frames = (uint64_t)(seconds * t.getSampleRate());
+	JackCpp::WavFileSink sink(path, 2, t.getSampleRate(), JackCpp::WavFileSink::int24);
+
+	t.start();
+	t.startRender(&sink);
+	while(t.getFreewheelStats().frames < frames)
+		usleep(10000);
+	t.stopRender();
+	bool ok = sink.close();
+
+	JackCpp::AudioIO::freewheel_stats_t stats = t.getFreewheelStats();
+	cout << stats.frames << " frames in " << stats.seconds << " seconds, "
+		<< stats.speedup << " times realtime" << endl;
+	cout << sink.framesWritten() << " frames written, " << sink.framesDropped() << " dropped, "
+		<< sink.waits() << " waits for the writer" << endl;
+	if(!ok)
+		cout << "writing " << path << " failed" << endl;
+	if(argc <= 2)
+		unlink(path.c_str());
+
+	t.stop();
+	exit(ok ? 0 : 1);
+}
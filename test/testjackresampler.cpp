@@ -0,0 +1,76 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+//this doesn't need a jack server, it streams a sine through the resampler
+//in jack sized blocks and measures how far the output is from an ideal sine
+
+#include "jackresampler.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <iostream>
+using std::cout;
+using std::endl;
+
+static double test_conversion(double inRate, double outRate, JackCpp::Resampler::quality_t q){
+	const unsigned int block = 256;
+	const double freq = 1000.0;
+	JackCpp::Resampler r(1, inRate, outRate, block, q);
+	std::vector<jack_default_audio_sample_t> out(block);
+	std::vector<jack_default_audio_sample_t *> outBufs(1, &out[0]);
+
+	unsigned long inPos = 0;
+	unsigned long outPos = 0;
+	double maxErr = 0.0;
+	for(unsigned int b = 0; b < 400; b++){
+		unsigned int need = r.inputFramesNeeded(block);
+		jack_default_audio_sample_t * in = r.inputBuffer(0);
+		for(unsigned int j = 0; j < need; j++, inPos++)
+			in[j] = sin(2.0 * M_PI * freq * inPos / inRate);
+		r.commitInput(need);
+		unsigned int cnt = r.process(outBufs, block);
+		if(cnt != block){
+			cout << "FAIL: only produced " << cnt << " of " << block << " frames" << endl;
+			exit(1);
+		}
+		for(unsigned int j = 0; j < cnt; j++, outPos++){
+			//skip the start up transient
+			if(b < 10)
+				continue;
+			//the filter delays the output by latency() input frames
+			double t = outPos / outRate - (double)r.latency() / inRate;
+			double err = fabs(out[j] - sin(2.0 * M_PI * freq * t));
+			if(err > maxErr)
+				maxErr = err;
+		}
+	}
+	return maxErr;
+}
+
+int main(){
+	const double rates[][2] = {{44100, 48000}, {48000, 44100}, {96000, 48000}, {48000, 96000}, {48000, 48000}};
+	const char * names[] = {"fast", "medium", "best"};
+	for(unsigned int i = 0; i < sizeof(rates) / sizeof(rates[0]); i++){
+		for(unsigned int q = 0; q < 3; q++){
+			double err = test_conversion(rates[i][0], rates[i][1], (JackCpp::Resampler::quality_t)q);
+			cout << rates[i][0] << " -> " << rates[i][1] << " " << names[q] <<
+				" max error " << 20.0 * log10(err + 1e-20) << " dB" << endl;
+		}
+	}
+	return 0;
+}
+
@@ -0,0 +1,127 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackrouter.hpp"
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+
+using std::cout;
+using std::endl;
+
+//a node, made without a jack client, that scales its input and remembers
+//the buffers it was given
+class Gain : public JackCpp::AudioIO {
+	public:
+		Gain(float gain) : mGain(gain), mIn(NULL), mOut(NULL) {}
+		virtual int processAudio(jack_nframes_t nframes,
+				const audioBufVector& inBufs,
+				const audioBufVector& outBufs){
+			mIn = inBufs[0];
+			mOut = outBufs[0];
+			for(unsigned int j = 0; j < nframes; j++)
+				outBufs[0][j] = inBufs[0][j] * mGain;
+			return 0;
+		}
+		float mGain;
+		const jack_default_audio_sample_t * mIn;
+		const jack_default_audio_sample_t * mOut;
+};
+
+//the router's input 0 goes through a into output 0, b gets both a and the
+//input and goes to output 1 along with a, b is added first to check the order
+int check_routes(jack_nframes_t nframes){
+	JackCpp::AudioRouter router("jackcpp-router", 1, 2);
+	Gain a(2.0f), b(3.0f);
+	const unsigned int ports = JackCpp::AudioRouter::ports;
+	unsigned int bi = router.addNode(&b, 1, 1);
+	unsigned int ai = router.addNode(&a, 1, 1);
+	router.route(ports, 0, ai, 0);
+	router.route(ai, 0, ports, 0);
+	router.route(ai, 0, bi, 0);
+	router.route(ports, 0, bi, 0);
+	router.route(bi, 0, ports, 1);
+	router.route(ai, 0, ports, 1);
+	router.jackBufferSizeCallback(nframes);
+	router.update();
+
+	jack_default_audio_sample_t * in = (jack_default_audio_sample_t *)jack_port_get_buffer(router.getInputPort(0), nframes);
+	for(unsigned int j = 0; j < nframes; j++)
+		in[j] = (jack_default_audio_sample_t)j;
+	JackCpp::AudioIO::jackProcessCallback(nframes, &router);
+	const jack_default_audio_sample_t * out0 = (jack_default_audio_sample_t *)jack_port_get_buffer(router.getOutputPort(0), nframes);
+	const jack_default_audio_sample_t * out1 = (jack_default_audio_sample_t *)jack_port_get_buffer(router.getOutputPort(1), nframes);
+
+	int errors = 0;
+	for(unsigned int j = 0; j < nframes; j++){
+		//out1 = 3 * (2x + x) + 2x
+		if(out0[j] != 2.0f * j || out1[j] != 11.0f * j)
+			errors++;
+	}
+	//a is fed the port and renders into its only output port, without copies
+	if(a.mIn != in || a.mOut != out0)
+		errors++;
+	cout << "routes " << (errors ? "wrong" : "right") << endl;
+
+	//a loop can't be ordered
+	router.route(bi, 0, ai, 0);
+	try {
+		router.update();
+		cout << "a loop was not found" << endl;
+		errors++;
+	} catch (std::runtime_error&){
+	}
+	router.close();
+	return errors;
+}
+
+//the time of a cycle through a chain of gains
+double time_chain(unsigned int length, jack_nframes_t nframes, unsigned int cycles){
+	JackCpp::AudioRouter router("jackcpp-router", 1, 1);
+	std::vector<Gain *> chain;
+	const unsigned int ports = JackCpp::AudioRouter::ports;
+	for(unsigned int i = 0; i < length; i++){
+		chain.push_back(new Gain(1.0f));
+		router.addNode(chain.back(), 1, 1);
+		router.route(i == 0 ? ports : i - 1, 0, i, 0);
+	}
+	router.route(length - 1, 0, ports, 0);
+	router.jackBufferSizeCallback(nframes);
+	router.update();
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned int i = 0; i < cycles; i++)
+		JackCpp::AudioIO::jackProcessCallback(nframes, &router);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	router.close();
+	for(unsigned int i = 0; i < chain.size(); i++)
+		delete chain[i];
+	return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / cycles;
+}
+
+int main(){
+	int errors = 0;
+	errors += check_routes(64);
+	errors += check_routes(256);
+
+	cout << "ns per 256 frame cycle through a chain of 16 nodes " << time_chain(16, 256, 100000) << endl;
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	exit(errors ? 1 : 0);
+}
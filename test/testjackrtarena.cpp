@@ -0,0 +1,86 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackrtarena.hpp"
+#include "jackobjectpool.hpp"
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+//an object that is not safe to destroy in the callback
+struct Voice {
+	Voice() : samples(512, 0.0f) {}
+	std::vector<float> samples;
+};
+
+int main(){
+	int errors = 0;
+
+	//two blocks of 256 frames and a little extra, like AudioIO::setRTArenaSize(2, 100)
+	JackCpp::RTArena arena(2 * JackCpp::RTArena::blockBytes(256) + 100, 256);
+	cout << "arena of " << arena.capacity() << " bytes, " << (arena.locked() ? "locked" : "not locked") << endl;
+	for(unsigned int cycle = 0; cycle < 3; cycle++){
+		arena.reset();
+		float * a = arena.scratchBlock();
+		int * counts = arena.allocateArray<int>(3);
+		float * b = arena.scratchBlock();
+		if(a == NULL || b == NULL || counts == NULL){
+			cout << "allocation failed" << endl;
+			errors++;
+		} else if(((uintptr_t)a % JackCpp::RTArena::blockAlignment) != 0 ||
+				((uintptr_t)b % JackCpp::RTArena::blockAlignment) != 0){
+			cout << "scratch block is not aligned" << endl;
+			errors++;
+		}
+		if(arena.scratchBlock() != NULL){
+			cout << "the arena should be full" << endl;
+			errors++;
+		}
+	}
+	cout << "high water " << arena.highWater() << " bytes, " << arena.failures() << " failed allocations" << endl;
+	if(arena.failures() != 3)
+		errors++;
+
+	JackCpp::ObjectPool<Voice> pool(4);
+	std::vector<Voice *> voices;
+	for(unsigned int i = 0; i < 5; i++){
+		Voice * v = pool.acquire();
+		if(v != NULL)
+			voices.push_back(v);
+	}
+	cout << "acquired " << voices.size() << " of " << pool.capacity() << " voices, " << pool.failures() << " failure" << endl;
+	if(voices.size() != 4 || pool.failures() != 1)
+		errors++;
+	for(unsigned int i = 0; i < voices.size(); i++)
+		pool.release(voices[i]);
+	//give the reclaimer thread a chance to recycle them
+	for(unsigned int i = 0; i < 100 && pool.available() < pool.capacity(); i++)
+		usleep(1000);
+	cout << pool.available() << " voices available again, high water " << pool.highWater() << endl;
+	if(pool.available() != pool.capacity() || pool.highWater() != 4)
+		errors++;
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	exit(errors ? 1 : 0);
+}
+
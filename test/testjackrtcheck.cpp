@@ -0,0 +1,141 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackaudioio.hpp"
+#include "jackblockingaudioio.hpp"
+#include "jackmidiport.hpp"
+#include <iostream>
+#include <stdlib.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+//build the library with JACKCPP_RTCHECK defined, see config.mk, for this
+//test to check anything
+
+//passes audio through and reads midi without copying the buffer vectors
+class GoodClient: public JackCpp::AudioIO {
+	public:
+		virtual int processAudio(jack_nframes_t nframes,
+				const audioBufVector& inBufs,
+				const audioBufVector& outBufs){
+			mMidiOutput.clear(mMidiOutput.port_buffer(nframes));
+			void * in_buffer = mMidiInput.port_buffer(nframes);
+			jack_nframes_t events = mMidiInput.event_count(in_buffer);
+			for(uint32_t i = 0; i < events; i++){
+				jack_midi_event_t evt;
+				mMidiInput.get(evt, in_buffer, i);
+			}
+			for(unsigned int i = 0; i < inBufs.size(); i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					outBufs[i][j] = inBufs[i][j];
+			}
+			return 0;
+		}
+		GoodClient() :
+			JackCpp::AudioIO("jackcpp-rtcheck-good", 2, 2){
+			mMidiOutput.init(this, "midiout");
+			mMidiInput.init(this, "midiin");
+		}
+	private:
+		JackCpp::MIDIOutPort mMidiOutput;
+		JackCpp::MIDIInPort mMidiInput;
+};
+
+//does several things it shouldn't
+class BadClient: public JackCpp::AudioIO {
+	public:
+		virtual int audioCallback(jack_nframes_t nframes,
+				audioBufVector inBufs,
+				audioBufVector outBufs){
+			float * scratch = new float[nframes];
+			for(unsigned int j = 0; j < nframes; j++)
+				scratch[j] = 0.0;
+			for(unsigned int i = 0; i < outBufs.size(); i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					outBufs[i][j] = scratch[j];
+			}
+			delete [] scratch;
+			usleep(10);
+			return 0;
+		}
+		BadClient() :
+			JackCpp::AudioIO("jackcpp-rtcheck-bad", 0, 2){
+		}
+};
+
+//runs a client for a second and reports what the checker found
+unsigned int check(const char * name, JackCpp::AudioIO * client){
+	JackCpp::RTChecker::clear();
+	JackCpp::RTChecker::enable();
+	client->start();
+	sleep(1);
+	client->stop();
+	JackCpp::RTChecker::enable(false);
+	unsigned int violations = JackCpp::RTChecker::violations();
+	cout << name << ": " << violations << " violations" << endl;
+	return violations;
+}
+
+int main(){
+	if(!JackCpp::RTChecker::available()){
+		cout << "the realtime checker is not built in, define JACKCPP_RTCHECK" << endl;
+		exit(0);
+	}
+	int errors = 0;
+
+	GoodClient * good = new GoodClient;
+	if(check("AudioIO and MIDIPort", good) != 0){
+		JackCpp::RTChecker::report(cout);
+		errors++;
+	}
+	good->close();
+	delete good;
+
+	JackCpp::BlockingAudioIO * blocking = new JackCpp::BlockingAudioIO("jackcpp-rtcheck-blocking", 2, 2);
+	JackCpp::RTChecker::clear();
+	JackCpp::RTChecker::enable();
+	blocking->start();
+	for(unsigned int i = 0; i < blocking->getSampleRate(); i++){
+		for(unsigned int j = 0; j < 2; j++)
+			blocking->write(j, blocking->read(j));
+	}
+	blocking->stop();
+	JackCpp::RTChecker::enable(false);
+	cout << "BlockingAudioIO: " << JackCpp::RTChecker::violations() << " violations" << endl;
+	if(JackCpp::RTChecker::violations() != 0){
+		JackCpp::RTChecker::report(cout);
+		errors++;
+	}
+	blocking->close();
+	delete blocking;
+
+	//this one should be caught
+	BadClient * bad = new BadClient;
+	if(check("bad client", bad) == 0)
+		errors++;
+	else
+		JackCpp::RTChecker::report(cout);
+	bad->close();
+	delete bad;
+
+	cout << (errors ? "FAILED" : "passed") << endl;
+	exit(errors ? 1 : 0);
+}
+
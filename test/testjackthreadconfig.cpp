@@ -0,0 +1,66 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackaudioio.hpp"
+#include <iostream>
+#include <stdlib.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+//configure the process thread before starting, then report what was done to it
+
+class Passthrough: public JackCpp::AudioIO {
+	public:
+		virtual int processAudio(jack_nframes_t nframes,
+				const audioBufVector& inBufs,
+				const audioBufVector& outBufs){
+			for(unsigned int i = 0; i < outBufs.size(); i++){
+				for(unsigned int j = 0; j < nframes; j++)
+					outBufs[i][j] = inBufs[i][j];
+			}
+			return 0;
+		}
+		Passthrough() : JackCpp::AudioIO("jackcpp-threadconfig", 2, 2){}
+};
+
+int main(){
+	Passthrough * t = new Passthrough;
+
+	//flush denormals and prefault some stack in the process thread
+	JackCpp::ThreadConfig config;
+	config.denormals = JackCpp::ThreadConfig::flushDenormals;
+	config.stackPrefault = 256 * 1024;
+	t->setThreadConfig(config);
+
+	t->start();
+	//give the process thread a moment to run its init callback
+	sleep(1);
+
+	JackCpp::ThreadStatus status = t->getThreadStatus();
+	if (status.applied)
+		cout << "process thread " << (status.denormalsFlushed ? "flushes" : "does not flush") <<
+			" denormals, prefaulted " << status.stackPrefaulted << " bytes of stack" << endl;
+	else
+		cout << "the process thread hasn't been configured yet" << endl;
+
+	t->close();
+	delete t;
+	exit(0);
+}
@@ -0,0 +1,79 @@
+//An example JACKC++ program
+//Copyright 2007 Alex Norman
+//
+//This file is part of JACKC++.
+//
+//JACKC++ is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//JACKC++ is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with JACKC++.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "jackaudioio.hpp"
+#include <iostream>
+#include <stdlib.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+//clicks on every beat, louder on the first beat of the bar
+class TestTransport: public JackCpp::AudioIO {
+	public:
+		virtual int audioCallback(jack_nframes_t nframes,
+				audioBufVector inBufs,
+				audioBufVector outBufs){
+			JackCpp::BeatGrid::event_t events[16];
+			unsigned int cnt = mGrid.find(transport(), nframes, events, 16);
+
+			for(unsigned int j = 0; j < nframes; j++)
+				outBufs[0][j] = 0.0;
+			for(unsigned int i = 0; i < cnt; i++){
+				outBufs[0][events[i].offset] = (events[i].beat == 1) ? 1.0 : 0.5;
+				mBeats.write(events[i]);
+			}
+			return 0;
+		}
+		TestTransport() :
+			JackCpp::AudioIO("jackcpp-transport", 0, 1), mGrid(1), mBeats(64, true){
+		}
+		JackCpp::RingBuffer<JackCpp::BeatGrid::event_t>& beats(){ return mBeats; }
+	private:
+		JackCpp::BeatGrid mGrid;
+		JackCpp::RingBuffer<JackCpp::BeatGrid::event_t> mBeats;
+};
+
+int main(){
+	TestTransport * t = new TestTransport;
+	//we provide the tempo
+	t->setTimebaseTempo(132.0, 3.0, 4.0);
+	t->start();
+	t->setTimebaseMaster();
+	t->connectToPhysical(0,0);
+
+	cout << "start the jack transport to hear clicks" << endl;
+	for(unsigned int i = 0; i < 300; i++){
+		while(t->beats().getReadSpace() > 0){
+			JackCpp::BeatGrid::event_t e;
+			t->beats().read(e);
+			cout << "bar " << e.bar << " beat " << e.beat << " at frame " << e.offset << endl;
+		}
+		JackCpp::TransportInfo info = t->getTransport();
+		if(i % 10 == 0)
+			cout << (info.rolling() ? "rolling" : "stopped") << " at frame " << info.frame << endl;
+		usleep(100000);
+	}
+
+	t->releaseTimebase();
+	t->close();
+	delete t;
+	exit(0);
+}
+